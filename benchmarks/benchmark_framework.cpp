@@ -0,0 +1,163 @@
+#include "benchmark_framework.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace opus3d::benchmarks
+{
+	static std::string full_name(const Benchmark* benchmark) {
+		return benchmark->benchmarkCategory + "/" + benchmark->benchmarkSuite + "/" + benchmark->benchmarkName;
+	}
+
+	static void write_json_string(std::ostream& out, std::string_view text) {
+		out << '"';
+		for(char c : text) {
+			if(c == '"' || c == '\\') {
+				out << '\\' << c;
+			} else if(static_cast<unsigned char>(c) < 0x20) {
+				char escaped[8];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+				out << escaped;
+			} else {
+				out << c;
+			}
+		}
+		out << '"';
+	}
+
+	void BenchmarkController::execute_all() { execute_filtered({}); }
+
+	void BenchmarkController::execute_filtered(std::string_view filter) {
+		for(Benchmark* benchmark : benchmarks) {
+			const std::string name = full_name(benchmark);
+			if(!name.starts_with(filter)) {
+				continue;
+			}
+
+			std::cout << "BENCH_START " << name << "\n";
+			current = benchmark;
+			benchmark->run();
+			current = nullptr;
+			std::cout << "BENCH_END " << name << std::endl;
+		}
+	}
+
+	void BenchmarkController::list_benchmarks() const {
+		for(const Benchmark* benchmark : benchmarks) {
+			std::cout << full_name(benchmark) << "\n";
+		}
+	}
+
+	void BenchmarkController::record(std::string_view variant, size_t threads, std::string_view metric, double value, std::string_view unit) {
+		records.push_back(BenchRecord{.benchmark = current ? full_name(current) : std::string("?"),
+					      .variant	 = std::string(variant),
+					      .threads	 = threads,
+					      .metric	 = std::string(metric),
+					      .value	 = value,
+					      .unit	 = std::string(unit)});
+	}
+
+	void BenchmarkController::report(std::string_view variant, size_t threads, size_t operations, double seconds) {
+		const double nsPerOp  = operations ? seconds * 1e9 / double(operations) : 0.0;
+		const double mopsPerS = seconds > 0.0 ? double(operations) / seconds / 1e6 : 0.0;
+
+		std::cout << "BENCH_RESULT " << (current ? full_name(current) : std::string("?")) << " " << std::left
+			  << std::setw(24) << variant << std::right << " threads=" << std::setw(2) << threads
+			  << " ops=" << std::setw(10) << operations << std::fixed << std::setprecision(2)
+			  << " ns/op=" << std::setw(9) << nsPerOp << " Mops/s=" << std::setw(9) << mopsPerS << "\n";
+
+		record(variant, threads, "ns_per_op", nsPerOp, "ns");
+		record(variant, threads, "mops_per_s", mopsPerS, "Mops/s");
+	}
+
+	void BenchmarkController::report_latency(std::string_view variant, size_t threads, const LatencyPercentiles& latency) {
+		std::cout << "BENCH_LATENCY " << (current ? full_name(current) : std::string("?")) << " " << std::left
+			  << std::setw(24) << variant << std::right << " threads=" << std::setw(2) << threads << std::fixed
+			  << std::setprecision(0) << " p50=" << std::setw(7) << latency.p50 << " p90=" << std::setw(7)
+			  << latency.p90 << " p99=" << std::setw(7) << latency.p99 << " p99.9=" << std::setw(8) << latency.p999
+			  << " max=" << std::setw(9) << latency.max << " ns\n";
+
+		record(variant, threads, "latency_p50", latency.p50, "ns");
+		record(variant, threads, "latency_p90", latency.p90, "ns");
+		record(variant, threads, "latency_p99", latency.p99, "ns");
+		record(variant, threads, "latency_p999", latency.p999, "ns");
+		record(variant, threads, "latency_max", latency.max, "ns");
+	}
+
+	void BenchmarkController::report_metric(std::string_view variant, std::string_view metric, double value, std::string_view unit) {
+		std::cout << "BENCH_METRIC " << (current ? full_name(current) : std::string("?")) << " " << std::left
+			  << std::setw(24) << variant << " " << metric << "=" << std::fixed << std::setprecision(3) << value
+			  << " " << unit << std::right << "\n";
+
+		record(variant, 1, metric, value, unit);
+	}
+
+	void BenchmarkController::write_json(std::ostream& out) const {
+		out << "{\n  \"suite\": \"Opus3D-Bench-Memory\",\n  \"results\": [";
+
+		for(size_t i = 0; i < records.size(); ++i) {
+			const BenchRecord& r = records[i];
+
+			out << (i == 0 ? "\n" : ",\n") << "    {\"benchmark\": ";
+			write_json_string(out, r.benchmark);
+			out << ", \"variant\": ";
+			write_json_string(out, r.variant);
+			out << ", \"threads\": " << r.threads << ", \"metric\": ";
+			write_json_string(out, r.metric);
+			out << ", \"value\": " << std::setprecision(17) << std::defaultfloat << r.value << ", \"unit\": ";
+			write_json_string(out, r.unit);
+			out << "}";
+		}
+
+		out << "\n  ]\n}\n";
+	}
+
+	LatencyPercentiles LatencyRecorder::percentiles() {
+		if(m_samples.empty()) {
+			return {};
+		}
+
+		std::sort(m_samples.begin(), m_samples.end());
+
+		auto at = [&](double fraction) {
+			const size_t index = std::min(m_samples.size() - 1, static_cast<size_t>(fraction * double(m_samples.size())));
+			return static_cast<double>(m_samples[index]);
+		};
+
+		return LatencyPercentiles{.p50 = at(0.5), .p90 = at(0.9), .p99 = at(0.99), .p999 = at(0.999), .max = static_cast<double>(m_samples.back())};
+	}
+
+	size_t current_rss_bytes() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters{};
+		return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#else
+		// Second field of statm is the resident page count.
+		std::FILE* statm = std::fopen("/proc/self/statm", "r");
+		if(!statm) {
+			return 0;
+		}
+
+		unsigned long long pages	= 0;
+		unsigned long long resident = 0;
+		const int	   read	= std::fscanf(statm, "%llu %llu", &pages, &resident);
+		std::fclose(statm);
+
+		return read == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#endif
+	}
+
+	static const void* volatile g_escapeSink = nullptr;
+
+	void escape(const void* ptr) { g_escapeSink = ptr; }
+} // namespace opus3d::benchmarks
\ No newline at end of file
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Defines a benchmark class and automatically registers it with the Controller.
+#define BEGIN_BENCHMARK(BenchCategory, BenchSuite, BenchName)                                                          \
+	class Bench_##BenchCategory##_##BenchSuite##_##BenchName : public ::opus3d::benchmarks::Benchmark              \
+	{                                                                                                              \
+	public:                                                                                                        \
+                                                                                                                       \
+		Bench_##BenchCategory##_##BenchSuite##_##BenchName() {                                                 \
+			benchmarkCategory = #BenchCategory;                                                            \
+			benchmarkSuite	  = #BenchSuite;                                                               \
+			benchmarkName	  = #BenchName;                                                                \
+			::opus3d::benchmarks::BenchmarkController::get().register_benchmark(this);                     \
+		}                                                                                                      \
+		void run() override;                                                                                   \
+	};                                                                                                             \
+	static Bench_##BenchCategory##_##BenchSuite##_##BenchName                                                      \
+		bench_##BenchCategory##_##BenchSuite##_##BenchName##_instance;                                         \
+	void	Bench_##BenchCategory##_##BenchSuite##_##BenchName::run()
+
+namespace opus3d::benchmarks
+{
+	struct Benchmark
+	{
+		std::string benchmarkCategory;
+		std::string benchmarkSuite;
+		std::string benchmarkName;
+
+		// The function that the framework will call to execute the benchmark.
+		virtual void run() = 0;
+	};
+
+	// One measured value, every report adds one or more of these.
+	struct BenchRecord
+	{
+		std::string benchmark;
+		std::string variant;
+		size_t	    threads = 1;
+		std::string metric;
+		double	    value = 0.0;
+		std::string unit;
+	};
+
+	struct LatencyPercentiles
+	{
+		double p50  = 0.0;
+		double p90  = 0.0;
+		double p99  = 0.0;
+		double p999 = 0.0;
+		double max  = 0.0;
+	};
+
+	// --- Central Register & Controller ---
+	class BenchmarkController
+	{
+	private:
+
+		std::vector<Benchmark*>	 benchmarks;
+		std::vector<BenchRecord> records;
+		Benchmark*		 current = nullptr;
+		BenchmarkController()	 = default;
+
+		void record(std::string_view variant, size_t threads, std::string_view metric, double value, std::string_view unit);
+
+	public:
+
+		static BenchmarkController& get() {
+			static BenchmarkController instance;
+			return instance;
+		}
+
+		void register_benchmark(Benchmark* benchmark) { benchmarks.push_back(benchmark); }
+
+		// Run all benchmarks.
+		void execute_all();
+
+		// Run benchmarks whose "Category/Suite/Name" starts with filter.
+		void execute_filtered(std::string_view filter);
+
+		void list_benchmarks() const;
+
+		// Prints one result line for the running benchmark.
+		void report(std::string_view variant, size_t threads, size_t operations, double seconds);
+
+		void report_latency(std::string_view variant, size_t threads, const LatencyPercentiles& latency);
+
+		// Anything that is not a rate, e.g. fragmentation or resident memory.
+		void report_metric(std::string_view variant, std::string_view metric, double value, std::string_view unit);
+
+		// Every record of this run as JSON, stable field names so runs can be compared across commits.
+		void write_json(std::ostream& out) const;
+	};
+
+	class BenchTimer
+	{
+	public:
+
+		BenchTimer() : m_start(std::chrono::steady_clock::now()) {}
+
+		void restart() { m_start = std::chrono::steady_clock::now(); }
+
+		double elapsed_seconds() const {
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+		}
+
+	private:
+
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// Per-operation latencies. Timing each operation adds about one clock read to it, so the
+	// percentiles are meant for comparing variants with each other rather than as absolutes.
+	class LatencyRecorder
+	{
+	public:
+
+		explicit LatencyRecorder(size_t expectedSamples = 0) { m_samples.reserve(expectedSamples); }
+
+		void begin() { m_start = std::chrono::steady_clock::now(); }
+
+		void end() {
+			const auto elapsed = std::chrono::steady_clock::now() - m_start;
+			m_samples.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+		}
+
+		// Appends the samples of another recorder, e.g. one per thread.
+		void merge(const LatencyRecorder& other) { m_samples.insert(m_samples.end(), other.m_samples.begin(), other.m_samples.end()); }
+
+		size_t size() const { return m_samples.size(); }
+
+		// In nanoseconds, sorts the samples.
+		LatencyPercentiles percentiles();
+
+	private:
+
+		std::vector<uint32_t>		      m_samples;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	// Resident set size of this process, 0 where it can not be queried.
+	size_t current_rss_bytes();
+
+	// Opaque to the optimizer, keeps results and pointers from being thrown away.
+	void escape(const void* ptr);
+
+	// Runs fn(threadIndex) on threadCount threads released together, returns the wall time
+	// until the last one finishes.
+	template <typename Fn>
+	double run_threads(size_t threadCount, Fn&& fn) {
+		std::barrier		 start(static_cast<std::ptrdiff_t>(threadCount + 1));
+		std::vector<std::thread> threads;
+
+		for(size_t t = 0; t < threadCount; ++t) {
+			threads.emplace_back([&, t] {
+				start.arrive_and_wait();
+				fn(t);
+			});
+		}
+
+		start.arrive_and_wait();
+		BenchTimer timer;
+		for(std::thread& thread : threads) {
+			thread.join();
+		}
+		return timer.elapsed_seconds();
+	}
+
+	inline void report(std::string_view variant, size_t threads, size_t operations, double seconds) {
+		BenchmarkController::get().report(variant, threads, operations, seconds);
+	}
+
+	inline void report_latency(std::string_view variant, size_t threads, LatencyRecorder& latency) {
+		BenchmarkController::get().report_latency(variant, threads, latency.percentiles());
+	}
+
+	inline void report_metric(std::string_view variant, std::string_view metric, double value, std::string_view unit) {
+		BenchmarkController::get().report_metric(variant, metric, value, unit);
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
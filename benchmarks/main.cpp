@@ -0,0 +1,49 @@
+#include "benchmark_framework.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using opus3d::benchmarks::BenchmarkController;
+
+int main(int argc, char** argv) {
+
+	auto& controller = BenchmarkController::get();
+
+	std::string filter;
+	std::string jsonPath;
+
+	for(int i = 1; i < argc; ++i) {
+		std::string cmd = argv[i];
+
+		if(cmd == "--list") {
+			controller.list_benchmarks();
+			return 0;
+		} else if(cmd == "--run" && i + 1 < argc) {
+			filter = argv[++i]; // e.g. "Memory/Pool"
+		} else if(cmd == "--json" && i + 1 < argc) {
+			jsonPath = argv[++i];
+		} else {
+			std::cerr << "Unknown command. Usage:\n"
+				     "  opus3d_bench_memory                  # run all benchmarks\n"
+				     "  opus3d_bench_memory --list           # list benchmarks\n"
+				     "  opus3d_bench_memory --run Category/Suite[/Name]\n"
+				     "  opus3d_bench_memory --json results.json  # also write every result as JSON\n";
+			return 1;
+		}
+	}
+
+	controller.execute_filtered(filter);
+
+	if(!jsonPath.empty()) {
+		std::ofstream out(jsonPath);
+		if(!out) {
+			std::cerr << "Can not write " << jsonPath << "\n";
+			return 1;
+		}
+		controller.write_json(out);
+	}
+
+	return EXIT_SUCCESS;
+}
\ No newline at end of file
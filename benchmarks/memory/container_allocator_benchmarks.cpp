@@ -0,0 +1,209 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/containers/include/flat_hash_map.hpp>
+#include <foundation/containers/include/vector_dynamic.hpp>
+#include <foundation/memory/include/heap_allocator.hpp>
+#include <foundation/memory/include/linear_allocator.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t VectorRounds	  = 200000;
+		constexpr size_t VectorElements	  = 64;
+		constexpr size_t MapRounds	  = 2000;
+		constexpr size_t MapElements	  = 1024;
+		constexpr size_t ArenaReserveSize = size_t(64) << 20;
+		constexpr size_t DiscardRounds	  = 200;
+		constexpr size_t DiscardEntries	  = 100000;
+		constexpr size_t ChurnLive	  = 300000;
+		constexpr size_t ChurnOps	  = 4000000;
+
+		// Heap allocations with byte counters, shows how large a container's storage gets.
+		class CountingAllocator
+		{
+		public:
+
+			foundation::Result<void*> try_allocate(size_t size, size_t alignment) noexcept {
+				++allocations;
+				liveBytes += size;
+				peakBytes = std::max(peakBytes, liveBytes);
+				return heap.try_allocate(size, alignment);
+			}
+
+			void deallocate(void* ptr, size_t size, size_t alignment) noexcept {
+				liveBytes -= size;
+				heap.deallocate(ptr, size, alignment);
+			}
+
+			size_t liveBytes   = 0;
+			size_t peakBytes   = 0;
+			size_t allocations = 0;
+
+		private:
+
+			foundation::memory::HeapAllocator heap;
+		};
+
+		// Builds many short vectors, growth (and so the allocator) is a large part of the work.
+		// reset runs after every round so arenas do not run out.
+		template <typename Alloc, typename ResetFn>
+		void push_back_rounds(Alloc alloc, ResetFn&& reset, std::string_view variant) {
+			BenchTimer timer;
+			for(size_t round = 0; round < VectorRounds; ++round) {
+				{
+					foundation::VectorDynamic<uint32_t, Alloc> values(alloc);
+					for(size_t i = 0; i < VectorElements; ++i) {
+						values.push_back(static_cast<uint32_t>(i + round));
+					}
+					escape(values.data());
+				}
+				reset();
+			}
+			report(variant, 1, VectorRounds * VectorElements, timer.elapsed_seconds());
+		}
+
+		// Fills a fresh map every round, so rehashing allocates a new table several times.
+		template <typename Alloc, typename ResetFn>
+		void insert_rounds(Alloc alloc, ResetFn&& reset, std::string_view variant) {
+			BenchTimer timer;
+			for(size_t round = 0; round < MapRounds; ++round) {
+				{
+					foundation::FlatHashMap<uint32_t, uint32_t, foundation::Hash<uint32_t>, Alloc> map(alloc);
+					for(uint32_t key = 0; key < MapElements; ++key) {
+						static_cast<void>(map.insert(key * 2654435761u, key));
+					}
+					escape(&map);
+				}
+				reset();
+			}
+			report(variant, 1, MapRounds * MapElements, timer.elapsed_seconds());
+		}
+
+		// Times only the end of frame: discarding a map of DiscardEntries entries.
+		template <typename DiscardFn, typename ResetFn>
+		void discard_rounds(foundation::memory::Allocator alloc, DiscardFn&& discard, ResetFn&& reset, std::string_view variant) {
+			using Map = foundation::FlatHashMap<uint32_t, uint32_t>;
+
+			double seconds = 0.0;
+			for(size_t round = 0; round < DiscardRounds; ++round) {
+				{
+					alignas(Map) std::byte storage[sizeof(Map)];
+					Map*		       map = std::construct_at(reinterpret_cast<Map*>(storage), alloc, DiscardEntries);
+					for(uint32_t key = 0; key < DiscardEntries; ++key) {
+						static_cast<void>(map->insert(key * 2654435761u, key));
+					}
+					escape(map);
+
+					BenchTimer timer;
+					discard(*map);
+					seconds += timer.elapsed_seconds();
+				}
+				reset();
+			}
+			report(variant, 1, DiscardRounds, seconds);
+		}
+	} // namespace
+
+	// push_back through the type-erased Allocator vs. the allocator type as a template parameter.
+	BEGIN_BENCHMARK(Memory, Containers, PushBack)
+	{
+		using namespace foundation::memory;
+
+		HeapAllocator	heap;
+		LinearAllocator arena = std::move(LinearAllocator::create(ArenaReserveSize).value());
+
+		auto none	= [] {};
+		auto resetArena = [&] { arena.reset(); };
+
+		push_back_rounds<Allocator>(as_allocator(heap), none, "Allocator(Heap)");
+		push_back_rounds<HeapAllocator&>(heap, none, "HeapAllocator&");
+		push_back_rounds<Allocator>(as_allocator(arena), resetArena, "Allocator(Linear)");
+		push_back_rounds<LinearAllocator&>(arena, resetArena, "LinearAllocator&");
+	}
+
+	// Same for FlatHashMap::insert, where the allocator is only hit on rehash.
+	BEGIN_BENCHMARK(Memory, Containers, Insert)
+	{
+		using namespace foundation::memory;
+
+		HeapAllocator	heap;
+		LinearAllocator arena = std::move(LinearAllocator::create(ArenaReserveSize).value());
+
+		auto none	= [] {};
+		auto resetArena = [&] { arena.reset(); };
+
+		insert_rounds<Allocator>(as_allocator(heap), none, "Allocator(Heap)");
+		insert_rounds<HeapAllocator&>(heap, none, "HeapAllocator&");
+		insert_rounds<Allocator>(as_allocator(arena), resetArena, "Allocator(Linear)");
+		insert_rounds<LinearAllocator&>(arena, resetArena, "LinearAllocator&");
+	}
+
+	// Discarding a frame-temporary 100k entry map, ops are discards: destructor vs. abandon().
+	BEGIN_BENCHMARK(Memory, Containers, DiscardMap)
+	{
+		using namespace foundation::memory;
+		using Map = foundation::FlatHashMap<uint32_t, uint32_t>;
+
+		HeapAllocator	heap;
+		LinearAllocator arena = std::move(LinearAllocator::create(ArenaReserveSize).value());
+
+		auto none	= [] {};
+		auto resetArena = [&] { arena.reset(); };
+		auto destroy	= [](Map& map) { std::destroy_at(&map); };
+		auto abandon	= [](Map& map) { map.abandon(), std::destroy_at(&map); };
+
+		// What teardown used to cost: every control byte reset before the free.
+		auto clear = [](Map& map) { map.clear(), std::destroy_at(&map); };
+
+		discard_rounds(as_allocator(heap), clear, none, "Heap/clear+destructor");
+		discard_rounds(as_allocator(heap), destroy, none, "Heap/destructor");
+		discard_rounds(as_allocator(heap), abandon, none, "Heap/abandon");
+		discard_rounds(as_allocator(arena), clear, resetArena, "Linear/clear+destructor");
+		discard_rounds(as_allocator(arena), destroy, resetArena, "Linear/destructor");
+		discard_rounds(as_allocator(arena), abandon, resetArena, "Linear/abandon");
+	}
+
+	// A sliding window of ChurnLive keys: every op erases the oldest key and inserts a new one,
+	// so the live size never changes. Ops are erase+insert pairs, the table should stay the size
+	// the initial fill needed.
+	BEGIN_BENCHMARK(Memory, Containers, EraseInsertChurn)
+	{
+		using Map = foundation::FlatHashMap<uint32_t, uint32_t, foundation::Hash<uint32_t>, CountingAllocator&>;
+
+		// A bijective mix, with a plain multiplicative key every new key would sit at a fixed
+		// offset from the one just erased and reuse its tombstone.
+		auto key = [](size_t i) {
+			uint32_t x = static_cast<uint32_t>(i);
+			x	   = (x ^ (x >> 16)) * 0x7FEB352Du;
+			x	   = (x ^ (x >> 15)) * 0x846CA68Bu;
+			return x ^ (x >> 16);
+		};
+
+		CountingAllocator counting;
+		Map		  map(counting);
+		for(size_t i = 0; i < ChurnLive; ++i) {
+			static_cast<void>(map.insert(key(i), 1));
+		}
+
+		const size_t filledBytes       = counting.liveBytes;
+		const size_t filledAllocations = counting.allocations;
+
+		BenchTimer timer;
+		for(size_t i = 0; i < ChurnOps; ++i) {
+			static_cast<void>(map.erase(key(i)));
+			static_cast<void>(map.insert(key(i + ChurnLive), 1));
+		}
+		const double seconds = timer.elapsed_seconds();
+
+		report("FlatHashMap", 1, ChurnOps, seconds);
+		report_metric("FlatHashMap", "table_after_fill", double(filledBytes) / (1024.0 * 1024.0), "MiB");
+		report_metric("FlatHashMap", "table_peak", double(counting.peakBytes) / (1024.0 * 1024.0), "MiB");
+		report_metric("FlatHashMap", "churn_allocations", double(counting.allocations - filledAllocations), "count");
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/fibers/include/fiber.hpp>
+#include <foundation/fibers/include/fiber_stack_pool.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include <memory>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t StackSize  = 64 * 1024;
+		constexpr size_t FiberCount = 200000;
+
+		// Each fiber touches a few KB of stack, like a small job would.
+		void run_one(void* stack, size_t size) {
+			foundation::Fiber fiber(stack, size, [](auto& self) {
+				char frame[4096];
+				frame[0] = 1;
+				self.yield();
+				frame[4095] = 2;
+				escape(frame);
+			});
+			fiber.resume();
+			fiber.resume();
+		}
+	} // namespace
+
+	// Create, run and destroy fibers back to back, with stacks from each source.
+	BEGIN_BENCHMARK(Memory, Fibers, StackChurn)
+	{
+		using namespace foundation;
+
+		{
+			FiberStackPool pool = std::move(FiberStackPool::create(StackSize, 64).value());
+
+			BenchTimer timer;
+			for(size_t i = 0; i < FiberCount; ++i) {
+				FiberStack stack = pool.acquire();
+				run_one(stack.base, stack.size);
+				pool.release(stack);
+			}
+			report("FiberStackPool", 1, FiberCount, timer.elapsed_seconds());
+		}
+
+		{
+			FiberStackPool pool = std::move(FiberStackPool::create(StackSize, 64, FiberStackPool::IdlePolicy::DiscardOnRelease).value());
+
+			BenchTimer timer;
+			for(size_t i = 0; i < FiberCount; ++i) {
+				FiberStack stack = pool.acquire();
+				run_one(stack.base, stack.size);
+				pool.release(stack);
+			}
+			report("FiberStackPool+discard", 1, FiberCount, timer.elapsed_seconds());
+		}
+
+		{
+			BenchTimer timer;
+			for(size_t i = 0; i < FiberCount; ++i) {
+				std::unique_ptr<char[]> stack(new char[StackSize]);
+				run_one(stack.get(), StackSize);
+			}
+			report("new[]", 1, FiberCount, timer.elapsed_seconds());
+		}
+
+		{
+			// What a guarded stack costs without a pool: a mapping per fiber.
+			BenchTimer timer;
+			for(size_t i = 0; i < FiberCount; ++i) {
+				void* stack = memory::allocate_pages(StackSize, memory::MemoryAccess::ReadWrite).value();
+				run_one(stack, StackSize);
+				static_cast<void>(memory::release_pages(stack, StackSize));
+			}
+			report("allocate_pages", 1, FiberCount, timer.elapsed_seconds());
+		}
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/containers/include/flat_hash_map.hpp>
+#include <foundation/memory/include/heap_allocator.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t LookupBatch  = 1024; // IDs resolved together, e.g. one system's per-frame list.
+		constexpr size_t LookupCount  = size_t(4) << 20;
+		constexpr size_t TableSizes[] = {size_t(64) << 10, size_t(16) << 20};
+
+		using Map = foundation::FlatHashMap<uint64_t, uint64_t>;
+
+		// Bijective, keeps keys distinct.
+		uint64_t mix(uint64_t x) {
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+			return x ^ (x >> 31);
+		}
+
+		// Stands in for what a system does with each resolved entry, a dependent chain of about
+		// 30 cycles. It fills the reorder window and limits how far ahead scalar find() runs.
+		uint64_t work(uint64_t value) {
+			for(int i = 0; i < 8; ++i) {
+				value = value * 0x9E3779B97F4A7C15ull + (value >> 29);
+			}
+			return value;
+		}
+
+		// Random present keys, so nearly every lookup in a large table misses the cache.
+		std::vector<uint64_t> lookup_keys(size_t entries) {
+			std::vector<uint64_t> keys(LookupCount);
+			for(size_t i = 0; i < LookupCount; ++i) {
+				keys[i] = mix(mix(i) % entries);
+			}
+			return keys;
+		}
+
+		// Probe lengths of looking up ids [first, first + count) in map, as a histogram in
+		// 16 slot groups, and the time of the same lookups.
+		template <typename IdMap>
+		void report_probe_lengths(IdMap& map, const std::string& variant, uint32_t first, uint32_t count) {
+			constexpr uint32_t    BucketLimits[] = {1, 2, 4, 8, 64, UINT32_MAX};
+			constexpr const char* BucketNames[]  = {"groups_1", "groups_2", "groups_3_4", "groups_5_8", "groups_9_64", "groups_65_up"};
+
+			size_t buckets[std::size(BucketLimits)] = {};
+			size_t groups				= 0;
+			size_t compares				= 0;
+
+			for(uint32_t id = first; id < first + count; ++id) {
+				const auto length = map.probe_length(id);
+
+				groups   += length.groups;
+				compares += length.keyCompares;
+				++buckets[std::lower_bound(std::begin(BucketLimits), std::end(BucketLimits), length.groups) - std::begin(BucketLimits)];
+			}
+
+			for(size_t i = 0; i < std::size(BucketLimits); ++i) {
+				report_metric(variant, BucketNames[i], 100.0 * double(buckets[i]) / count, "%");
+			}
+			report_metric(variant, "groups_mean", double(groups) / count, "groups");
+			report_metric(variant, "key_compares_mean", double(compares) / count, "compares");
+
+			uint64_t   sum = 0;
+			BenchTimer timer;
+			for(uint32_t id = first; id < first + count; ++id) {
+				sum += map.find(id).value() != nullptr;
+			}
+			report(variant, 1, count, timer.elapsed_seconds());
+			escape(&sum);
+		}
+	} // namespace
+
+	// Resolving batches of random IDs: find() one key at a time vs. find_many() with prefetching.
+	// The large table (16M entries, ~550 MB) is far beyond the last-level cache. Ops are lookups.
+	BEGIN_BENCHMARK(Memory, HashMap, FindMany)
+	{
+		using namespace foundation::memory;
+
+		HeapAllocator heap;
+
+		for(size_t entries : TableSizes) {
+			Map map(as_allocator(heap), entries);
+			for(size_t i = 0; i < entries; ++i) {
+				static_cast<void>(map.insert(mix(i), i));
+			}
+
+			const std::vector<uint64_t> keys = lookup_keys(entries);
+			std::vector<uint64_t*>	    results(LookupBatch);
+			const std::string	    suffix = "/" + std::to_string(entries >> 10) + "K";
+
+			uint64_t   sum = 0;
+			BenchTimer timer;
+			for(size_t base = 0; base < LookupCount; base += LookupBatch) {
+				for(size_t i = 0; i < LookupBatch; ++i) {
+					results[i] = map.find(keys[base + i]).value();
+				}
+				sum += *results[LookupBatch - 1];
+			}
+			report("find" + suffix, 1, LookupCount, timer.elapsed_seconds());
+
+			timer.restart();
+			for(size_t base = 0; base < LookupCount; base += LookupBatch) {
+				map.find_many(std::span<const uint64_t>(keys).subspan(base, LookupBatch), results);
+				sum += *results[LookupBatch - 1];
+			}
+			report("find_many" + suffix, 1, LookupCount, timer.elapsed_seconds());
+
+			// The same with work on every resolved value.
+			timer.restart();
+			for(size_t base = 0; base < LookupCount; base += LookupBatch) {
+				for(size_t i = 0; i < LookupBatch; ++i) {
+					sum += work(*map.find(keys[base + i]).value());
+				}
+			}
+			report("find+work" + suffix, 1, LookupCount, timer.elapsed_seconds());
+
+			timer.restart();
+			for(size_t base = 0; base < LookupCount; base += LookupBatch) {
+				map.find_many(std::span<const uint64_t>(keys).subspan(base, LookupBatch), results);
+				for(uint64_t* value : results) {
+					sum += work(*value);
+				}
+			}
+			report("find_many+work" + suffix, 1, LookupCount, timer.elapsed_seconds());
+
+			escape(&sum);
+		}
+	}
+
+	// Hit and miss lookups with 16 and 32 byte control groups, in tables filled to just below the
+	// 3/4 growth point where probe sequences are longest. The 32 byte width needs AVX2.
+	BEGIN_BENCHMARK(Memory, HashMap, ProbeWidth)
+	{
+		using namespace foundation::memory;
+
+		constexpr size_t Capacities[] = {size_t(4) << 10, size_t(1) << 20, size_t(16) << 20};
+
+		HeapAllocator heap;
+
+		const size_t defaultWidth = foundation::flat_hash_map_probe_width();
+
+		for(size_t capacity : Capacities) {
+			const size_t entries = capacity * 3 / 4 - 1;
+
+			// Present keys, and keys from past the inserted range that are never present.
+			std::vector<uint64_t> hits(LookupCount);
+			std::vector<uint64_t> misses(LookupCount);
+			for(size_t i = 0; i < LookupCount; ++i) {
+				hits[i]	  = mix(mix(i) % entries);
+				misses[i] = mix(entries + i);
+			}
+
+			for(size_t width : {size_t(16), size_t(32)}) {
+				if(width == 32 && !foundation::simd::cpu_has_avx2()) {
+					continue;
+				}
+				// A table takes the width it is allocated with.
+				foundation::set_flat_hash_map_probe_width(width);
+
+				Map map(as_allocator(heap), capacity / 2);
+				for(size_t i = 0; i < entries; ++i) {
+					static_cast<void>(map.insert(mix(i), i));
+				}
+
+				const std::string suffix = "/w" + std::to_string(width) + "/" + std::to_string(capacity >> 10) + "K";
+
+				uint64_t   sum = 0;
+				BenchTimer timer;
+				for(uint64_t key : hits) {
+					sum += *map.find(key).value();
+				}
+				report("hit" + suffix, 1, LookupCount, timer.elapsed_seconds());
+
+				timer.restart();
+				for(uint64_t key : misses) {
+					sum += map.find(key).value() == nullptr;
+				}
+				report("miss" + suffix, 1, LookupCount, timer.elapsed_seconds());
+
+				escape(&sum);
+			}
+		}
+
+		foundation::set_flat_hash_map_probe_width(defaultWidth);
+	}
+
+	// Sequential entity IDs, the common integer key. Histograms of probe lengths for hits and
+	// misses (the next IDs), std::hash against the default foundation::Hash, in a table just
+	// below 3/4 load. The identity std::hash gives 128 consecutive IDs the same h1, and 2048
+	// the same first group, so the IDs pile up in one cluster; the table is kept small.
+	BEGIN_BENCHMARK(Memory, HashMap, ProbeLength)
+	{
+		using namespace foundation::memory;
+
+		constexpr size_t   Capacity = size_t(64) << 10;
+		constexpr uint32_t Ids	    = Capacity * 3 / 4 - 1;
+
+		HeapAllocator heap;
+
+		auto run = [&]<typename Hasher>(const std::string& name) {
+			foundation::FlatHashMap<uint32_t, uint32_t, Hasher> map(as_allocator(heap), Capacity / 2);
+			for(uint32_t id = 0; id < Ids; ++id) {
+				static_cast<void>(map.insert(id, id));
+			}
+
+			report_probe_lengths(map, name + "/hit", 0, Ids);
+			report_probe_lengths(map, name + "/miss", Ids, Ids);
+		};
+
+		run.operator()<std::hash<uint32_t>>("std::hash");
+		run.operator()<foundation::Hash<uint32_t>>("Hash");
+	}
+
+	// Counting the IDs of a frame in a map cleared every frame, about 70% are new. find()
+	// then insert() against one find_or_insert(). Then looking up names held as string_views,
+	// by a std::string built for the lookup against the view itself; names are past the small
+	// string buffer, so a built key allocates. Ops are lookups.
+	BEGIN_BENCHMARK(Memory, HashMap, Upsert)
+	{
+		using namespace foundation::memory;
+
+		constexpr size_t FrameIds  = size_t(64) << 10;
+		constexpr size_t IdRange   = FrameIds * 3 / 2;
+		constexpr size_t Names	   = size_t(16) << 10;
+		constexpr size_t Lookups   = size_t(4) << 20;
+		constexpr size_t NameBytes = 24;
+
+		HeapAllocator heap;
+
+		std::vector<uint64_t> ids(Lookups);
+		for(size_t i = 0; i < Lookups; ++i) {
+			ids[i] = mix(i) % IdRange;
+		}
+
+		{
+			Map counts(as_allocator(heap), FrameIds);
+
+			BenchTimer timer;
+			for(size_t frame = 0; frame < Lookups; frame += FrameIds) {
+				counts.clear();
+				for(size_t i = frame; i < frame + FrameIds; ++i) {
+					if(uint64_t* count = counts.find(ids[i]).value()) {
+						++*count;
+					} else {
+						static_cast<void>(counts.insert(ids[i], 1));
+					}
+				}
+			}
+			report("find+insert", 1, Lookups, timer.elapsed_seconds());
+		}
+
+		{
+			Map counts(as_allocator(heap), FrameIds);
+
+			BenchTimer timer;
+			for(size_t frame = 0; frame < Lookups; frame += FrameIds) {
+				counts.clear();
+				for(size_t i = frame; i < frame + FrameIds; ++i) {
+					++counts.find_or_insert(ids[i]).value().value;
+				}
+			}
+			report("find_or_insert", 1, Lookups, timer.elapsed_seconds());
+		}
+
+		std::vector<std::string>      names(Names);
+		std::vector<std::string_view> stream(Lookups);
+		for(size_t i = 0; i < Names; ++i) {
+			names[i] = "mesh/" + std::to_string(mix(i));
+			names[i].resize(NameBytes, '_');
+		}
+		for(size_t i = 0; i < Lookups; ++i) {
+			stream[i] = names[mix(i) % Names];
+		}
+
+		foundation::FlatHashMap<std::string, uint32_t> byName(as_allocator(heap), Names);
+		for(const std::string& name : names) {
+			static_cast<void>(byName.insert(name, 1));
+		}
+
+		uint64_t   sum = 0;
+		BenchTimer timer;
+		for(std::string_view name : stream) {
+			sum += *byName.find(std::string(name)).value();
+		}
+		report("find(std::string)", 1, Lookups, timer.elapsed_seconds());
+
+		timer.restart();
+		for(std::string_view name : stream) {
+			sum += *byName.find(name).value();
+		}
+		report("find(string_view)", 1, Lookups, timer.elapsed_seconds());
+
+		escape(&sum);
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
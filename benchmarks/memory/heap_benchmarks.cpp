@@ -0,0 +1,128 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/containers/include/flat_hash_map.hpp>
+#include <foundation/memory/include/heap_allocator.hpp>
+
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t Rounds		= 2000;
+		constexpr size_t BlocksPerRound = 256;
+		constexpr size_t ThreadCounts[] = {1, 2, 4, 8};
+		constexpr size_t ZeroedRounds	= 20;
+		constexpr size_t ZeroedSize	= size_t(64) << 20;
+		constexpr size_t ZeroedEntries	= size_t(1) << 20;
+
+		void* system_aligned_alloc(size_t size, size_t alignment) {
+#ifdef _WIN32
+			return _aligned_malloc(size, alignment);
+#else
+			void* ptr = nullptr;
+			return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+#endif
+		}
+
+		void system_aligned_free(void* ptr) {
+#ifdef _WIN32
+			_aligned_free(ptr);
+#else
+			std::free(ptr);
+#endif
+		}
+
+		// Mixed small sizes with the alignments containers typically ask for.
+		constexpr size_t size_for(size_t i) { return 16 + (i * 40) % 512; }
+
+		template <typename AllocFn, typename FreeFn>
+		void small_churn(AllocFn&& alloc, FreeFn&& free) {
+			void* blocks[BlocksPerRound];
+
+			for(size_t round = 0; round < Rounds; ++round) {
+				for(size_t i = 0; i < BlocksPerRound; ++i) {
+					blocks[i]			       = alloc(size_for(i));
+					*static_cast<unsigned char*>(blocks[i]) = static_cast<unsigned char>(i);
+				}
+				escape(blocks);
+				for(size_t i = BlocksPerRound; i-- > 0;) {
+					free(blocks[i], size_for(i));
+				}
+			}
+		}
+	} // namespace
+
+	// Small aligned allocations through HeapAllocator's thread cache vs. the system aligned allocator.
+	BEGIN_BENCHMARK(Memory, Heap, SmallChurn)
+	{
+		using namespace foundation::memory;
+
+		for(size_t threadCount : ThreadCounts) {
+			const size_t operations = threadCount * Rounds * BlocksPerRound * 2;
+
+			{
+				HeapAllocator heap;
+
+				const double seconds = run_threads(threadCount, [&](size_t) {
+					small_churn([&](size_t size) { return heap.allocate(size, 16); },
+						    [&](void* p, size_t size) { heap.deallocate(p, size, 16); });
+				});
+				report("HeapAllocator", threadCount, operations, seconds);
+			}
+
+			{
+				const double seconds = run_threads(threadCount, [&](size_t) {
+					small_churn([](size_t size) { return system_aligned_alloc(size, 16); },
+						    [](void* p, size_t) { system_aligned_free(p); });
+				});
+				report("SystemAlignedAlloc", threadCount, operations, seconds);
+			}
+		}
+	}
+
+	// A 64 MB zero-filled block and a 1M entry map table: memset after allocate vs. zeroed OS pages.
+	// Ops are allocations, each round frees the block again.
+	BEGIN_BENCHMARK(Memory, Heap, ZeroedLarge)
+	{
+		using namespace foundation::memory;
+
+		HeapAllocator heap;
+
+		{
+			BenchTimer timer;
+			for(size_t round = 0; round < ZeroedRounds; ++round) {
+				void* block = heap.allocate(ZeroedSize, 64);
+				std::memset(block, 0, ZeroedSize);
+				escape(block);
+				heap.deallocate(block, ZeroedSize, 64);
+			}
+			report("allocate+memset", 1, ZeroedRounds, timer.elapsed_seconds());
+		}
+
+		{
+			BenchTimer timer;
+			for(size_t round = 0; round < ZeroedRounds; ++round) {
+				void* block = heap.try_allocate_zeroed(ZeroedSize, 64).value();
+				escape(block);
+				heap.deallocate(block, ZeroedSize, 64);
+			}
+			report("try_allocate_zeroed", 1, ZeroedRounds, timer.elapsed_seconds());
+		}
+
+		{
+			BenchTimer timer;
+			for(size_t round = 0; round < ZeroedRounds; ++round) {
+				foundation::FlatHashMap<uint32_t, uint32_t> map(as_allocator(heap), ZeroedEntries);
+				static_cast<void>(map.insert(static_cast<uint32_t>(round), 1));
+				escape(&map);
+			}
+			report("FlatHashMap(1M entries)", 1, ZeroedRounds, timer.elapsed_seconds());
+		}
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
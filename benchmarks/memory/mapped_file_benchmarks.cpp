@@ -0,0 +1,80 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/memory/include/mapped_file.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#ifdef __linux__
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t FileBytes  = size_t(256) << 20;
+		constexpr size_t ChunkBytes = size_t(1) << 20;
+
+		uint64_t checksum(const std::byte* data, size_t size) {
+			uint64_t sum = 0;
+			for(size_t i = 0; i < size; i += sizeof(uint64_t)) {
+				uint64_t word;
+				std::memcpy(&word, data + i, sizeof(word));
+				sum += word;
+			}
+			return sum;
+		}
+
+		void read_mapped(std::FILE* file, const foundation::memory::MappedFileOptions& options, std::string_view variant) {
+			using namespace foundation::memory;
+
+			BenchTimer timer;
+			{
+				MappedFile view = std::move(MappedFile::map(fileno(file), options).value());
+				uint64_t   sum	= checksum(view.data(), view.size());
+				escape(&sum);
+			}
+			report(variant, 1, FileBytes / ChunkBytes, timer.elapsed_seconds());
+		}
+	} // namespace
+
+	// Checksums a 256 MB file that is already in the page cache, ops are 1 MB chunks.
+	BEGIN_BENCHMARK(Memory, Files, ReadWholeFile)
+	{
+		using namespace foundation::memory;
+
+		std::FILE* file = std::tmpfile();
+		{
+			std::unique_ptr<std::byte[]> chunk(new std::byte[ChunkBytes]);
+			for(size_t i = 0; i < ChunkBytes; ++i) {
+				chunk[i] = static_cast<std::byte>(i * 31);
+			}
+			for(size_t written = 0; written < FileBytes; written += ChunkBytes) {
+				std::fwrite(chunk.get(), 1, ChunkBytes, file);
+			}
+			std::fflush(file);
+		}
+
+		{
+			std::unique_ptr<std::byte[]> chunk(new std::byte[ChunkBytes]);
+
+			BenchTimer timer;
+			std::fseek(file, 0, SEEK_SET);
+			uint64_t sum = 0;
+			while(const size_t bytes = std::fread(chunk.get(), 1, ChunkBytes, file)) {
+				sum += checksum(chunk.get(), bytes);
+			}
+			escape(&sum);
+			report("fread", 1, FileBytes / ChunkBytes, timer.elapsed_seconds());
+		}
+
+		read_mapped(file, MappedFileOptions{}, "MappedFile");
+		read_mapped(file, MappedFileOptions{.pattern = MemoryAccessPattern::Sequential}, "MappedFile+sequential");
+		read_mapped(file, MappedFileOptions{.prefault = FilePrefault::Populate}, "MappedFile+populate");
+
+		std::fclose(file);
+	}
+} // namespace opus3d::benchmarks
+
+#endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/memory/include/concurrent_pool_allocator.hpp>
+#include <foundation/memory/include/pool_allocator.hpp>
+
+#include <barrier>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t BlockSize	= 64;
+		constexpr size_t BlocksPerRound = 256;
+		constexpr size_t Rounds		= 2000;
+		constexpr size_t ThreadCounts[] = {1, 2, 4, 8};
+
+		// Allocates a round of blocks, touches them and frees them in reverse, like a
+		// job system creating and retiring short lived objects.
+		template <typename AllocFn, typename FreeFn>
+		void local_churn(AllocFn&& alloc, FreeFn&& free) {
+			void* blocks[BlocksPerRound];
+
+			for(size_t round = 0; round < Rounds; ++round) {
+				for(void*& block : blocks) {
+					block				    = alloc();
+					*static_cast<unsigned char*>(block) = static_cast<unsigned char>(round);
+				}
+				escape(blocks);
+				for(size_t i = BlocksPerRound; i-- > 0;) {
+					free(blocks[i]);
+				}
+			}
+		}
+
+		// Every round each thread allocates a batch and frees the batch of its neighbour.
+		template <typename AllocFn, typename FreeFn>
+		double cross_thread_churn(size_t threadCount, AllocFn&& alloc, FreeFn&& free) {
+			std::vector<std::vector<void*>> batches(threadCount, std::vector<void*>(BlocksPerRound));
+			std::barrier			roundSync(static_cast<std::ptrdiff_t>(threadCount));
+
+			return run_threads(threadCount, [&](size_t t) {
+				for(size_t round = 0; round < Rounds; ++round) {
+					for(void*& block : batches[t]) {
+						block = alloc();
+					}
+					roundSync.arrive_and_wait();
+
+					for(void* block : batches[(t + 1) % threadCount]) {
+						free(block);
+					}
+					roundSync.arrive_and_wait();
+				}
+			});
+		}
+
+		constexpr size_t operations(size_t threadCount) { return threadCount * Rounds * BlocksPerRound * 2; }
+	} // namespace
+
+	// Same-thread alloc/free: shared concurrent pool vs. a private pool per thread vs. malloc.
+	BEGIN_BENCHMARK(Memory, Pool, LocalChurn)
+	{
+		using namespace foundation::memory;
+
+		for(size_t threadCount : ThreadCounts) {
+			const size_t maxBlocks = threadCount * BlocksPerRound * 2;
+
+			{
+				ConcurrentPoolAllocator pool = std::move(ConcurrentPoolAllocator::create(BlockSize, 16, maxBlocks).value());
+
+				const double seconds = run_threads(threadCount, [&](size_t) {
+					local_churn([&] { return pool.allocate(); }, [&](void* p) { pool.deallocate(p); });
+				});
+				report("ConcurrentPool", threadCount, operations(threadCount), seconds);
+			}
+
+			{
+				std::vector<PoolAllocator> pools;
+				for(size_t t = 0; t < threadCount; ++t) {
+					pools.push_back(std::move(PoolAllocator::create(BlockSize, 16, BlocksPerRound).value()));
+				}
+
+				const double seconds = run_threads(threadCount, [&](size_t t) {
+					PoolAllocator& pool = pools[t];
+					local_churn([&] { return pool.allocate(); }, [&](void* p) { pool.deallocate(p); });
+				});
+				report("PoolAllocator/thread", threadCount, operations(threadCount), seconds);
+			}
+
+			{
+				const double seconds = run_threads(threadCount, [&](size_t) {
+					local_churn([] { return std::malloc(BlockSize); }, [](void* p) { std::free(p); });
+				});
+				report("SystemHeap", threadCount, operations(threadCount), seconds);
+			}
+		}
+	}
+
+	// Blocks are freed on a different thread than the one that allocated them. The
+	// single-thread pool can not take part, so only the concurrent pool and malloc run.
+	BEGIN_BENCHMARK(Memory, Pool, CrossThreadChurn)
+	{
+		using namespace foundation::memory;
+
+		for(size_t threadCount : ThreadCounts) {
+			const size_t maxBlocks = threadCount * BlocksPerRound * 4;
+
+			{
+				ConcurrentPoolAllocator pool = std::move(ConcurrentPoolAllocator::create(BlockSize, 16, maxBlocks).value());
+
+				const double seconds = cross_thread_churn(
+					threadCount, [&] { return pool.allocate(); }, [&](void* p) { pool.deallocate(p); });
+				report("ConcurrentPool", threadCount, operations(threadCount), seconds);
+			}
+
+			{
+				const double seconds = cross_thread_churn(
+					threadCount, [] { return std::malloc(BlockSize); }, [](void* p) { std::free(p); });
+				report("SystemHeap", threadCount, operations(threadCount), seconds);
+			}
+		}
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/containers/include/vector_dynamic.hpp>
+#include <foundation/memory/include/heap_allocator.hpp>
+
+#include <cstdint>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t TargetBytes  = size_t(1) << 30;
+		constexpr size_t InitialCount = 1024;
+		constexpr size_t TargetCount  = TargetBytes / sizeof(uint64_t);
+
+		// Doubles the vector up to TargetBytes, filling each new half before growing again.
+		void grow_by_doubling(foundation::memory::Allocator allocator, std::string_view variant) {
+			foundation::VectorDynamic<uint64_t> values(allocator);
+
+			double growthSeconds = 0.0;
+			size_t growthCount   = 0;
+
+			BenchTimer total;
+			for(size_t capacity = InitialCount; capacity <= TargetCount; capacity *= 2) {
+				BenchTimer growth;
+				values.reserve(capacity);
+				growthSeconds += growth.elapsed_seconds();
+				++growthCount;
+
+				while(values.size() < capacity) {
+					values.push_back(values.size());
+				}
+			}
+			const double totalSeconds = total.elapsed_seconds();
+			escape(values.data());
+
+			report(std::string(variant) + "/total", 1, values.size(), totalSeconds);
+			report(std::string(variant) + "/growth", 1, growthCount, growthSeconds);
+		}
+	} // namespace
+
+	// Growing a 1 GB vector: mremap through Allocator::try_resize vs. allocate + copy.
+	BEGIN_BENCHMARK(Memory, Heap, VectorDoubling1GB)
+	{
+		using namespace foundation::memory;
+
+		HeapAllocator heap;
+
+		grow_by_doubling(as_allocator(heap), "HeapAllocator+remap");
+
+		// Same allocator with the ResizeFn slot left empty, every growth copies.
+		Allocator copying(
+			&heap,
+			[](void* ctx, size_t size, size_t alignment) noexcept {
+				return static_cast<HeapAllocator*>(ctx)->try_allocate(size, alignment);
+			},
+			[](void* ctx, void* ptr, size_t size, size_t alignment) noexcept {
+				static_cast<HeapAllocator*>(ctx)->deallocate(ptr, size, alignment);
+			});
+
+		grow_by_doubling(copying, "HeapAllocator+copy");
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/memory/include/virtual_range.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t WorkingSetBytes = size_t(512) << 20;
+		constexpr size_t SlotBytes	 = 64;
+		constexpr size_t SlotCount	 = WorkingSetBytes / SlotBytes;
+		constexpr size_t ChaseSteps	 = size_t(16) << 20;
+
+		const char* backing_name(foundation::memory::PageBacking backing) {
+			switch(backing) {
+				case foundation::memory::PageBacking::TransparentHuge: return "thp";
+				case foundation::memory::PageBacking::HugeTlb: return "hugetlb";
+				default: return "4k";
+			}
+		}
+
+		// Links every cache line into one random cycle (Sattolo), then follows it. Each step
+		// is a dependent load to an unpredictable page, so the run is dominated by TLB and
+		// cache misses rather than bandwidth.
+		void random_chase(foundation::memory::MemoryPageSize pageSize, std::string_view variant) {
+			using namespace foundation;
+			using namespace foundation::memory;
+
+			Result<VirtualRange> reserved = VirtualRange::reserve(WorkingSetBytes, pageSize);
+			if(!reserved.has_value() || !reserved.value().grow(WorkingSetBytes).has_value()) {
+				std::printf("  %-28s unavailable\n", std::string(variant).c_str());
+				return;
+			}
+
+			VirtualRange range = std::move(reserved.value());
+			uint64_t*    slots = reinterpret_cast<uint64_t*>(range.data());
+			constexpr size_t Stride = SlotBytes / sizeof(uint64_t);
+
+			for(size_t i = 0; i < SlotCount; ++i) {
+				slots[i * Stride] = i;
+			}
+
+			uint64_t rng = 0x9E3779B97F4A7C15ull;
+			for(size_t i = SlotCount - 1; i > 0; --i) {
+				rng ^= rng << 13;
+				rng ^= rng >> 7;
+				rng ^= rng << 17;
+
+				const size_t j = rng % i;
+				std::swap(slots[i * Stride], slots[j * Stride]);
+			}
+
+			uint64_t   slot = 0;
+			BenchTimer timer;
+			for(size_t step = 0; step < ChaseSteps; ++step) {
+				slot = slots[slot * Stride];
+			}
+			const double seconds = timer.elapsed_seconds();
+			escape(&slot);
+
+			report(std::string(variant) + "/" + backing_name(range.page_backing()), 1, ChaseSteps, seconds);
+		}
+	} // namespace
+
+	// Dependent random reads over 512 MB, normal pages vs. whatever Large gets from the OS.
+	BEGIN_BENCHMARK(Memory, Pages, RandomAccessTlb)
+	{
+		using namespace foundation::memory;
+
+		random_chase(MemoryPageSize::Normal, "VirtualRange/Normal");
+		random_chase(MemoryPageSize::Large, "VirtualRange/Large");
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
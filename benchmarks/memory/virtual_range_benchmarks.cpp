@@ -0,0 +1,98 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/memory/include/virtual_range.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t Frames	       = 2000;
+		constexpr size_t FrameBytes    = 1024 * 1024;
+		constexpr size_t GrowStepBytes = 16 * 1024;
+		constexpr size_t GrowthBytes   = size_t(256) << 20;
+		constexpr size_t PageBytes     = 4096;
+
+		// A frame arena: grows in small steps up to FrameBytes, touches the memory and
+		// drops back to empty at the end of the frame. Ops are frames.
+		void oscillate(const foundation::memory::CommitPolicy& policy, std::string_view variant) {
+			using namespace foundation::memory;
+
+			VirtualRange range = std::move(VirtualRange::reserve(64 * 1024 * 1024).value());
+			range.set_commit_policy(policy);
+
+			BenchTimer timer;
+			for(size_t frame = 0; frame < Frames; ++frame) {
+				for(size_t bytes = 0; bytes < FrameBytes; bytes += GrowStepBytes) {
+					static_cast<void>(range.grow(GrowStepBytes));
+					range.data()[range.size() - 1] = std::byte{1};
+				}
+				static_cast<void>(range.shrink(range.size()));
+			}
+			const double seconds = timer.elapsed_seconds();
+
+			const CommitStats& stats = range.commit_stats();
+			report(variant, 1, Frames, seconds);
+			report(std::string(variant) + "/syscalls", 1, stats.commits + stats.decommits, static_cast<double>(stats.syscallNanoseconds) * 1e-9);
+		}
+
+		// A streaming buffer filling up: grows to GrowthBytes in steps of 4-64 KB and touches
+		// every new page. Ops and latency are grow calls.
+		void growth(const foundation::memory::CommitPolicy& policy, std::string_view variant) {
+			using namespace foundation::memory;
+
+			VirtualRange range = std::move(VirtualRange::reserve(GrowthBytes * 2).value());
+			range.set_commit_policy(policy);
+
+			LatencyRecorder latency(GrowthBytes / PageBytes);
+			uint32_t	seed	  = 1;
+			size_t		grows	  = 0;
+			const size_t	rssBefore = current_rss_bytes();
+
+			BenchTimer timer;
+			while(range.size() < GrowthBytes) {
+				seed		   = seed * 1664525u + 1013904223u;
+				const size_t begin = range.size();
+
+				latency.begin();
+				static_cast<void>(range.grow(PageBytes * (1 + (seed >> 16) % 16)));
+				latency.end();
+				++grows;
+
+				for(size_t offset = begin; offset < range.size(); offset += PageBytes) {
+					range.data()[offset] = std::byte{1};
+				}
+			}
+			const double seconds = timer.elapsed_seconds();
+			const size_t rss     = current_rss_bytes();
+
+			report(variant, 1, grows, seconds);
+			report_latency(variant, 1, latency);
+			report_metric(variant, "rss_growth", rss > rssBefore ? double(rss - rssBefore) / double(1 << 20) : 0.0, "MiB");
+			report_metric(variant, "committed_over_size", double(range.committed_size()) / double(range.size()), "x");
+		}
+	} // namespace
+
+	// Per-page commit/decommit vs. chunked commit-ahead with decommit slack.
+	BEGIN_BENCHMARK(Memory, Pages, OscillatingCommit)
+	{
+		using namespace foundation::memory;
+
+		oscillate(CommitPolicy{}, "exact");
+		oscillate(CommitPolicy{.minCommitChunk = 256 * 1024}, "chunk256K");
+		oscillate(CommitPolicy{.minCommitChunk = 64 * 1024, .growthPercent = 100, .decommitSlack = 2 * FrameBytes}, "geometric+slack");
+	}
+
+	// Growth of a range to 256 MB: exact commits vs. chunked vs. geometric commit-ahead.
+	BEGIN_BENCHMARK(Memory, Pages, Growth)
+	{
+		using namespace foundation::memory;
+
+		growth(CommitPolicy{}, "exact");
+		growth(CommitPolicy{.minCommitChunk = 1024 * 1024}, "chunk1M");
+		growth(CommitPolicy{.minCommitChunk = 64 * 1024, .growthPercent = 50}, "geometric");
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
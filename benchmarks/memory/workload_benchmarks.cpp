@@ -0,0 +1,351 @@
+#include "../benchmark_framework.hpp"
+
+#include <foundation/memory/include/concurrent_pool_allocator.hpp>
+#include <foundation/memory/include/heap_allocator.hpp>
+#include <foundation/memory/include/linear_allocator.hpp>
+#include <foundation/memory/include/tlsf_allocator.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Workloads shaped like an engine frame rather than a single allocation pattern. Besides
+// throughput they report latency percentiles and how much resident memory the allocator
+// needed for what was live. RSS is process wide, so compare a variant across commits
+// rather than variants that ran one after another in the same process.
+namespace opus3d::benchmarks
+{
+	namespace
+	{
+		constexpr size_t Frames		  = 300;
+		constexpr size_t AllocsPerFrame	  = 4000;
+		constexpr size_t MaxLifetime	  = 8; // Frames a long lived block survives at most.
+		constexpr size_t MixedSteps	  = 1000000;
+		constexpr size_t MixedSlots	  = 16384;
+		constexpr size_t ItemsPerProducer = 200000;
+		constexpr size_t QueueCapacity	  = 1024;
+		constexpr size_t MessageSize	  = 128;
+		constexpr size_t PairCounts[]	  = {1, 2, 4};
+		constexpr size_t ArenaReserveSize = size_t(256) << 20;
+		constexpr size_t TlsfReserveSize  = size_t(1) << 30;
+		constexpr double MiB		  = 1024.0 * 1024.0;
+
+		// Deterministic, every variant sees the same sequence of sizes.
+		struct Rng
+		{
+			uint64_t state;
+
+			uint32_t next() {
+				state = state * 6364136223846793005ull + 1442695040888963407ull;
+				return static_cast<uint32_t>(state >> 33);
+			}
+		};
+
+		// 80% 16-256 bytes, 18% up to 4 KB, 2% up to 64 KB.
+		size_t mixed_size(Rng& rng) {
+			const uint32_t r      = rng.next();
+			const uint32_t bucket = r % 100;
+			if(bucket < 80) {
+				return 16 + (r >> 8) % 241;
+			}
+			if(bucket < 98) {
+				return 256 + (r >> 8) % (4096 - 256);
+			}
+			return 4096 + (r >> 8) % (65536 - 4096);
+		}
+
+		struct Block
+		{
+			void*  ptr;
+			size_t size;
+		};
+
+		double rss_growth_mib(size_t before) {
+			const size_t after = current_rss_bytes();
+			return after > before ? double(after - before) / MiB : 0.0;
+		}
+
+		// Frame-temporary and long lived blocks come from the same allocator.
+		template <typename A>
+		struct SharedFrameAllocs
+		{
+			A& allocator;
+
+			void* alloc_temp(size_t size) { return allocator.allocate(size, 16); }
+			void  free_temp(void* ptr, size_t size) { allocator.deallocate(ptr, size, 16); }
+			void* alloc_long(size_t size) { return allocator.allocate(size, 16); }
+			void  free_long(void* ptr, size_t size) { allocator.deallocate(ptr, size, 16); }
+			void  end_frame() {}
+		};
+
+		struct SystemAllocs
+		{
+			void* alloc_temp(size_t size) { return std::malloc(size); }
+			void  free_temp(void* ptr, size_t) { std::free(ptr); }
+			void* alloc_long(size_t size) { return std::malloc(size); }
+			void  free_long(void* ptr, size_t) { std::free(ptr); }
+			void  end_frame() {}
+		};
+
+		// The engine pattern: temporaries in a frame arena that is reset at the end of the
+		// frame, only the long lived blocks go to the heap.
+		struct ArenaFrameAllocs
+		{
+			foundation::memory::LinearAllocator& arena;
+			foundation::memory::HeapAllocator&   heap;
+
+			void* alloc_temp(size_t size) { return arena.allocate(size, 16); }
+			void  free_temp(void*, size_t) {}
+			void* alloc_long(size_t size) { return heap.allocate(size, 16); }
+			void  free_long(void* ptr, size_t size) { heap.deallocate(ptr, size, 16); }
+			void  end_frame() { arena.reset(); }
+		};
+
+		// Free space split into pieces, for allocators that can tell while the blocks are live.
+		template <typename Allocs>
+		void report_fragmentation(Allocs& allocs, std::string_view variant) {
+			if constexpr(requires { allocs.allocator.stats().fragmentation(); }) {
+				report_metric(variant, "fragmentation", allocs.allocator.stats().fragmentation(), "ratio");
+			}
+		}
+
+		// Every frame allocates AllocsPerFrame blocks of mixed size, 90% die at the end of the
+		// frame and the rest live for 1 to MaxLifetime - 1 frames. Ops are allocations and frees.
+		template <typename Allocs>
+		void frame_churn(Allocs&& allocs, std::string_view variant) {
+			std::vector<Block> temps;
+			std::vector<Block> retiring[MaxLifetime];
+			LatencyRecorder	   latency(Frames * AllocsPerFrame);
+			Rng		   rng{1};
+			size_t		   operations = 0;
+
+			temps.reserve(AllocsPerFrame);
+			const size_t rssBefore = current_rss_bytes();
+
+			BenchTimer timer;
+			for(size_t frame = 0; frame < Frames; ++frame) {
+				for(size_t i = 0; i < AllocsPerFrame; ++i) {
+					const size_t size      = mixed_size(rng);
+					const bool   longLived = rng.next() % 10 == 0;
+
+					latency.begin();
+					void* ptr = longLived ? allocs.alloc_long(size) : allocs.alloc_temp(size);
+					latency.end();
+
+					*static_cast<unsigned char*>(ptr) = static_cast<unsigned char>(i);
+					if(longLived) {
+						retiring[(frame + 1 + rng.next() % (MaxLifetime - 1)) % MaxLifetime].push_back(Block{ptr, size});
+					} else {
+						temps.push_back(Block{ptr, size});
+					}
+				}
+
+				for(size_t i = temps.size(); i-- > 0;) {
+					allocs.free_temp(temps[i].ptr, temps[i].size);
+				}
+				for(const Block& block : retiring[frame % MaxLifetime]) {
+					allocs.free_long(block.ptr, block.size);
+				}
+				operations += AllocsPerFrame + temps.size() + retiring[frame % MaxLifetime].size();
+				temps.clear();
+				retiring[frame % MaxLifetime].clear();
+				allocs.end_frame();
+			}
+			const double seconds = timer.elapsed_seconds();
+			const double rss     = rss_growth_mib(rssBefore);
+
+			report(variant, 1, operations, seconds);
+			report_latency(variant, 1, latency);
+			report_metric(variant, "rss_growth", rss, "MiB");
+			report_fragmentation(allocs, variant);
+
+			for(std::vector<Block>& blocks : retiring) {
+				for(const Block& block : blocks) {
+					allocs.free_long(block.ptr, block.size);
+				}
+			}
+		}
+
+		// Replaces a random slot of a large live set with a block of a new random size, the
+		// live set stays roughly constant while the free space splinters. Ops are
+		// allocations and frees. footprint_ratio is resident growth over live bytes.
+		template <typename Allocs>
+		void mixed_sizes(Allocs&& allocs, std::string_view variant) {
+			std::vector<Block> slots(MixedSlots, Block{nullptr, 0});
+			LatencyRecorder	   latency(MixedSteps);
+			Rng		   rng{7};
+			size_t		   liveBytes  = 0;
+			size_t		   operations = 0;
+
+			const size_t rssBefore = current_rss_bytes();
+
+			BenchTimer timer;
+			for(size_t step = 0; step < MixedSteps; ++step) {
+				Block& slot = slots[rng.next() % MixedSlots];
+				if(slot.ptr) {
+					allocs.free_long(slot.ptr, slot.size);
+					liveBytes -= slot.size;
+					++operations;
+				}
+
+				const size_t size = mixed_size(rng);
+
+				latency.begin();
+				slot = Block{allocs.alloc_long(size), size};
+				latency.end();
+
+				*static_cast<unsigned char*>(slot.ptr) = static_cast<unsigned char>(step);
+				liveBytes += size;
+				++operations;
+			}
+			const double seconds = timer.elapsed_seconds();
+			const double rss     = rss_growth_mib(rssBefore);
+
+			report(variant, 1, operations, seconds);
+			report_latency(variant, 1, latency);
+			report_metric(variant, "live", double(liveBytes) / MiB, "MiB");
+			report_metric(variant, "footprint_ratio", liveBytes ? rss * MiB / double(liveBytes) : 0.0, "x");
+			report_fragmentation(allocs, variant);
+
+			for(const Block& block : slots) {
+				if(block.ptr) {
+					allocs.free_long(block.ptr, block.size);
+				}
+			}
+		}
+
+		// Single producer, single consumer ring of block pointers.
+		struct MessageQueue
+		{
+			void*		    slots[QueueCapacity];
+			alignas(64) std::atomic<size_t> head{0};
+			alignas(64) std::atomic<size_t> tail{0};
+
+			bool try_push(void* ptr) {
+				const size_t t = tail.load(std::memory_order_relaxed);
+				if(t - head.load(std::memory_order_acquire) == QueueCapacity) {
+					return false;
+				}
+				slots[t % QueueCapacity] = ptr;
+				tail.store(t + 1, std::memory_order_release);
+				return true;
+			}
+
+			bool try_pop(void*& ptr) {
+				const size_t h = head.load(std::memory_order_relaxed);
+				if(h == tail.load(std::memory_order_acquire)) {
+					return false;
+				}
+				ptr = slots[h % QueueCapacity];
+				head.store(h + 1, std::memory_order_release);
+				return true;
+			}
+		};
+
+		// Producers allocate messages and hand them to a consumer thread that frees them, so
+		// every free is a cross-thread free. Ops are allocations and frees, latency is the
+		// producer's allocation.
+		template <typename AllocFn, typename FreeFn>
+		void producer_consumer(size_t pairs, AllocFn&& alloc, FreeFn&& free, std::string_view variant) {
+			std::unique_ptr<MessageQueue[]> queues(new MessageQueue[pairs]);
+			std::vector<LatencyRecorder>	latencies;
+			for(size_t pair = 0; pair < pairs; ++pair) {
+				latencies.emplace_back(ItemsPerProducer);
+			}
+
+			const double seconds = run_threads(pairs * 2, [&](size_t t) {
+				MessageQueue& queue = queues[t / 2];
+
+				if(t % 2 == 0) {
+					LatencyRecorder& latency = latencies[t / 2];
+					for(size_t i = 0; i < ItemsPerProducer; ++i) {
+						latency.begin();
+						void* message = alloc();
+						latency.end();
+
+						*static_cast<size_t*>(message) = i;
+						while(!queue.try_push(message)) {
+							std::this_thread::yield();
+						}
+					}
+				} else {
+					void* message = nullptr;
+					for(size_t received = 0; received < ItemsPerProducer;) {
+						if(queue.try_pop(message)) {
+							free(message);
+							++received;
+						} else {
+							std::this_thread::yield();
+						}
+					}
+				}
+			});
+
+			LatencyRecorder latency;
+			for(const LatencyRecorder& producer : latencies) {
+				latency.merge(producer);
+			}
+
+			report(variant, pairs * 2, pairs * ItemsPerProducer * 2, seconds);
+			report_latency(variant, pairs * 2, latency);
+		}
+	} // namespace
+
+	// Frame temporaries plus blocks that live a few frames.
+	BEGIN_BENCHMARK(Memory, Workloads, FrameChurn)
+	{
+		using namespace foundation::memory;
+
+		{
+			TlsfAllocator tlsf = std::move(TlsfAllocator::create(TlsfReserveSize).value());
+			frame_churn(SharedFrameAllocs<TlsfAllocator>{tlsf}, "Tlsf");
+		}
+
+		HeapAllocator heap;
+		frame_churn(SharedFrameAllocs<HeapAllocator>{heap}, "Heap");
+
+		LinearAllocator arena = std::move(LinearAllocator::create(ArenaReserveSize).value());
+		frame_churn(ArenaFrameAllocs{arena, heap}, "Linear+Heap");
+
+		frame_churn(SystemAllocs{}, "System");
+	}
+
+	// A live set of mixed sizes under constant replacement.
+	BEGIN_BENCHMARK(Memory, Workloads, MixedSizes)
+	{
+		using namespace foundation::memory;
+
+		{
+			TlsfAllocator tlsf = std::move(TlsfAllocator::create(TlsfReserveSize).value());
+			mixed_sizes(SharedFrameAllocs<TlsfAllocator>{tlsf}, "Tlsf");
+		}
+
+		HeapAllocator heap;
+		mixed_sizes(SharedFrameAllocs<HeapAllocator>{heap}, "Heap");
+		mixed_sizes(SystemAllocs{}, "System");
+	}
+
+	// Fixed-size messages allocated on one thread and freed on another.
+	BEGIN_BENCHMARK(Memory, Workloads, ProducerConsumer)
+	{
+		using namespace foundation::memory;
+
+		for(size_t pairs : PairCounts) {
+			{
+				ConcurrentPoolAllocator pool = std::move(ConcurrentPoolAllocator::create(MessageSize, 16, pairs * QueueCapacity * 4).value());
+				producer_consumer(pairs, [&] { return pool.allocate(); }, [&](void* p) { pool.deallocate(p); }, "ConcurrentPool");
+			}
+
+			HeapAllocator heap;
+			producer_consumer(
+				pairs, [&] { return heap.allocate(MessageSize, 16); }, [&](void* p) { heap.deallocate(p, MessageSize, 16); }, "Heap");
+
+			producer_consumer(pairs, [] { return std::malloc(MessageSize); }, [](void* p) { std::free(p); }, "System");
+		}
+	}
+} // namespace opus3d::benchmarks
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "engine_context.hpp"
 #include "engine_result.hpp"
 
+#include <engine/memory/include/frame_arena_ring.hpp>
+
 #include <atomic>
 
 namespace opus3d::engine
@@ -51,6 +53,9 @@ namespace opus3d::engine
 
 		const EngineContext& context() const noexcept;
 
+		// Transient per-frame memory, valid after initialize().
+		FrameArenaRing& frame_arenas() noexcept;
+
 	private:
 
 		enum class State : uint8_t
@@ -75,6 +80,7 @@ namespace opus3d::engine
 		void shutdown_internal() noexcept;
 
 		const EngineContext	m_context;
+		FrameArenaRing		m_frameArenas;
 		std::atomic<State>	m_state{State::Constructed};
 		std::atomic<bool>	m_exitRequested{false};
 		std::atomic<ExitReason> m_exitReason{ExitReason::None};
@@ -2,6 +2,8 @@
 
 #include <foundation/application/include/event_poller.hpp>
 #include <foundation/core/include/assert.hpp>
+#include <foundation/memory/include/memory_budget.hpp>
+#include <foundation/memory/include/tracking_allocator.hpp>
 #include <foundation/window/include/window.hpp>
 
 namespace opus3d::engine
@@ -43,6 +45,11 @@ namespace opus3d::engine
 		// --- perform initialization here ---
 		// logging, memory, jobs, platform, renderer, etc.
 
+		if(Result<void> arenas = m_frameArenas.initialize(m_context.config.framesInFlight, m_context.config.perFrameArenaSizeBytes); !arenas.has_value())
+		{
+			return arenas;
+		}
+
 		set_state(State::Initialized);
 
 		return {};
@@ -84,6 +91,8 @@ namespace opus3d::engine
 
 	const EngineContext& Engine::context() const noexcept { return m_context; }
 
+	FrameArenaRing& Engine::frame_arenas() noexcept { return m_frameArenas; }
+
 	bool Engine::state_transition(State expectedState, State newState) noexcept
 	{
 		return m_state.compare_exchange_strong(expectedState, newState, std::memory_order_acq_rel);
@@ -104,6 +113,10 @@ namespace opus3d::engine
 				// timing (tick clocks)
 
 				// aquire frame context (ring buffer)
+				// Releases the transient memory of the frame that last used this slot.
+				m_frameArenas.begin_frame();
+				foundation::memory::memory_tracking_begin_frame();
+				foundation::memory::memory_budget_begin_frame();
 
 				// gather tasks
 
@@ -134,6 +147,12 @@ namespace opus3d::engine
 		return RunResult{.reason = exitReason, .exitCode = exitCode};
 	}
 
-	void Engine::shutdown_internal() noexcept {}
+	void Engine::shutdown_internal() noexcept
+	{
+		m_frameArenas.shutdown();
+
+		// Per-subsystem usage and whatever is still live, empty without memory tracking.
+		foundation::memory::write_memory_report(stderr);
+	}
 
 } // namespace opus3d::engine
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <engine/core/include/engine_result.hpp>
+
+#include <foundation/containers/include/vector_static.hpp>
+#include <foundation/memory/include/allocator.hpp>
+#include <foundation/memory/include/linear_allocator.hpp>
+
+#include <cstdint>
+
+namespace opus3d::engine
+{
+	struct FrameArenaStats
+	{
+		// Engine frame the numbers belong to.
+		uint64_t frameIndex = 0;
+
+		// Highest number of bytes that frame had allocated at once.
+		size_t peakBytes = 0;
+
+		// Bytes committed by the slot's arena at the end of that frame.
+		size_t committedBytes = 0;
+	};
+
+	// One linear arena per frame in flight.
+	//
+	// Transient frame data (render packets, input snapshots, temporary arrays) is
+	// allocated from the current frame's arena and never freed individually.
+	// The whole arena is released in O(1) when its slot comes around again,
+	// i.e. framesInFlight frames later, once nothing can reference it anymore.
+	class FrameArenaRing
+	{
+	public:
+
+		static constexpr uint32_t MaxFramesInFlight = 4;
+
+		// Infallible, reserves nothing. See initialize().
+		FrameArenaRing() noexcept = default;
+
+		FrameArenaRing(const FrameArenaRing&)		 = delete;
+		FrameArenaRing& operator=(const FrameArenaRing&) = delete;
+
+		// Reserves one arena of arenaSizeBytes per frame in flight.
+		// Pages are committed lazily, so the reservation itself costs no memory.
+		[[nodiscard]] Result<void> initialize(uint32_t framesInFlight, size_t arenaSizeBytes) noexcept;
+
+		// Releases all arenas. Any frame allocation still referenced dangles after this.
+		void shutdown() noexcept;
+
+		// Frame boundary, called at the start of every frame. The first call opens frame 0 in
+		// the first slot. Every later one records the finished frame's stats, moves to the next
+		// slot and bulk-releases everything that was allocated the last time the slot was used.
+		void begin_frame() noexcept;
+
+		// Allocator for data that lives until this frame slot is reused.
+		foundation::memory::Allocator allocator() noexcept { return foundation::memory::as_allocator(current_arena()); }
+
+		foundation::memory::LinearAllocator& current_arena() noexcept { return m_arenas[m_current]; }
+
+		// Stats of the most recently finished frame.
+		const FrameArenaStats& last_frame_stats() const noexcept { return m_lastFrameStats; }
+
+		// Highest per-frame peak seen since initialize().
+		size_t max_frame_peak() const noexcept { return m_maxFramePeak; }
+
+		uint64_t frame_index() const noexcept { return m_frameIndex; }
+		uint32_t frames_in_flight() const noexcept { return static_cast<uint32_t>(m_arenas.size()); }
+		bool	 initialized() const noexcept { return !m_arenas.empty(); }
+
+	private:
+
+		foundation::VectorStatic<foundation::memory::LinearAllocator, MaxFramesInFlight> m_arenas;
+
+		// Peak of the last use of every slot, used to size the retained commit.
+		size_t m_slotPeaks[MaxFramesInFlight] = {};
+
+		FrameArenaStats m_lastFrameStats;
+		size_t		m_maxFramePeak = 0;
+		uint64_t	m_frameIndex   = 0;
+		uint32_t	m_current      = 0;
+		bool		m_frameOpen    = false;
+	};
+} // namespace opus3d::engine
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include <engine/memory/include/frame_arena_ring.hpp>
+
+#include <foundation/core/include/assert.hpp>
+
+#include <algorithm>
+
+namespace opus3d::engine
+{
+	Result<void> FrameArenaRing::initialize(uint32_t framesInFlight, size_t arenaSizeBytes) noexcept
+	{
+		ASSERT_MSG(framesInFlight >= 1 && framesInFlight <= MaxFramesInFlight, "framesInFlight must be in [1, 4]");
+		ASSERT_MSG(!initialized(), "FrameArenaRing initialized twice");
+
+		for(uint32_t i = 0; i < framesInFlight; ++i)
+		{
+			if(Result<foundation::memory::LinearAllocator> arena = foundation::memory::LinearAllocator::create(arenaSizeBytes); arena.has_value())
+			{
+				m_arenas.emplace_back(std::move(arena.value()));
+			}
+			else
+			{
+				m_arenas.clear();
+				return foundation::Unexpected(arena.error());
+			}
+		}
+
+		m_current	 = 0;
+		m_frameIndex	 = 0;
+		m_maxFramePeak	 = 0;
+		m_lastFrameStats = {};
+		m_frameOpen	 = false;
+		std::fill(std::begin(m_slotPeaks), std::end(m_slotPeaks), size_t{0});
+
+		return {};
+	}
+
+	void FrameArenaRing::shutdown() noexcept { m_arenas.clear(); }
+
+	void FrameArenaRing::begin_frame() noexcept
+	{
+		DEBUG_ASSERT(initialized());
+
+		// Nothing ran before the first frame, there is no frame to close yet.
+		if(!m_frameOpen)
+		{
+			m_frameOpen = true;
+			return;
+		}
+
+		// Close the frame that just ended. Its arena stays untouched, it is still in flight.
+		{
+			const foundation::memory::LinearAllocator& finished = m_arenas[m_current];
+
+			m_lastFrameStats = FrameArenaStats{
+				.frameIndex	= m_frameIndex,
+				.peakBytes	= finished.peak_used(),
+				.committedBytes = finished.committed(),
+			};
+
+			m_slotPeaks[m_current] = m_lastFrameStats.peakBytes;
+			m_maxFramePeak	       = std::max(m_maxFramePeak, m_lastFrameStats.peakBytes);
+		}
+
+		m_current = (m_current + 1) % frames_in_flight();
+		++m_frameIndex;
+
+		// Keep as many pages committed as the recent frames needed. A one-off spike is
+		// handed back to the OS once it has left the ring.
+		const size_t recentPeak = *std::max_element(std::begin(m_slotPeaks), std::begin(m_slotPeaks) + frames_in_flight());
+
+		foundation::memory::LinearAllocator& arena = m_arenas[m_current];
+		arena.set_retained_commit(recentPeak);
+		arena.reset();
+		arena.reset_peak();
+	}
+} // namespace opus3d::engine
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/panic.hpp>
 #include <foundation/core/include/result.hpp>
 #include <foundation/memory/include/allocator.hpp>
 
@@ -8,10 +9,14 @@
 
 #include "hash.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <bit>
 #include <concepts>
 #include <cstring>
+#include <span>
 #include <type_traits>
+#include <utility>
 
 namespace opus3d::foundation
 {
@@ -30,37 +35,124 @@ namespace opus3d::foundation
 			concept SwissProbeDeleted = requires(T v, size_t idx) {
 				{ v.on_deleted(idx) };
 			};
+
+			// The hasher and the key compare take K as it is, no key is constructed from it.
+			template <typename Hash, typename Key, typename K>
+			concept TransparentLookup = requires { typename Hash::is_transparent; } && HashFor<Hash, K> && requires(const Key& key, const K& other) {
+				{ key == other } -> std::convertible_to<bool>;
+			};
 		} // namespace concepts
 
-		static constexpr int8_t SWISS_PROBE_CTRL_EMPTY	 = static_cast<int8_t>(0x80);
-		static constexpr int8_t SWISS_PROBE_CTRL_DELETED = static_cast<int8_t>(0xFE);
+		// Control bytes: a full slot is 0x80 | h2, so the sign bit alone tells full slots
+		// apart. EMPTY is zero, a table in freshly zeroed memory is an empty table.
+		static constexpr int8_t SWISS_PROBE_CTRL_EMPTY	 = 0x00;
+		static constexpr int8_t SWISS_PROBE_CTRL_DELETED = 0x01;
+
+		// The table's control bytes are laid out in 16 byte groups, probe sequences start on
+		// a group and walk the table linearly. A probe step compares one Group, 16 or 32 bytes,
+		// both widths see the slots in the same order. A 32 byte load from the last group
+		// reads 16 bytes into the control tail, which therefore mirrors the first 16 slots.
+		// In a 16 slot table that load holds every slot twice, the probe drops the mirror half.
+		// Lookups visit the same slots at either width, so probe_length() does not depend on it.
+		static constexpr size_t SWISS_PROBE_CTRL_TAIL = 16;
+
+		// Sets the control byte of slot idx and its mirror in the tail. Past the first 16 slots
+		// the mirror index is idx itself.
+		inline void swiss_set_ctrl(int8_t* ctrl, size_t capacity, size_t idx, int8_t value) noexcept
+		{
+			const size_t mirror = ((idx - SWISS_PROBE_CTRL_TAIL) & (capacity - 1)) + SWISS_PROBE_CTRL_TAIL;
 
-		template <concepts::SwissProbeBase Visitor>
-		inline auto swiss_probe(int8_t* ctrl, size_t capacity, size_t startGroup, int8_t h2, Visitor& visit) noexcept
+			ctrl[idx]    = value;
+			ctrl[mirror] = value;
+		}
+
+		struct SwissGroup16
 		{
-			using namespace simd;
+			static constexpr size_t width = 16;
 
-			constexpr size_t GROUP_SIZE = simd128<int8_t>::width;
+			simd::simd128<int8_t> ctrl;
 
-			simd128<int8_t> match(h2);
-			simd128<int8_t> empty(SWISS_PROBE_CTRL_EMPTY);
+			explicit SwissGroup16(const int8_t* p) noexcept : ctrl(simd::simd128<int8_t>::load(p)) {}
 
+			uint32_t match(int8_t value) const noexcept
+			{
+				return simd::simd128<int8_t>::movemask(simd::simd128<int8_t>::cmpeq(ctrl, simd::simd128<int8_t>(value)));
+			}
+
+			// Full slots have the sign bit set.
+			uint32_t match_non_full() const noexcept { return ~simd::simd128<int8_t>::movemask(ctrl) & 0xFFFF; }
+		};
+
+#if FOUNDATION_SIMD_X64
+		// Only used from FOUNDATION_SIMD_TARGET_AVX2 functions.
+		struct SwissGroup32
+		{
+			static constexpr size_t width = 32;
+
+			__m256i ctrl;
+
+			FOUNDATION_SIMD_TARGET_AVX2 explicit SwissGroup32(const int8_t* p) noexcept
+				: ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)))
+			{
+			}
+
+			FOUNDATION_SIMD_TARGET_AVX2 uint32_t match(int8_t value) const noexcept
+			{
+				return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(ctrl, _mm256_set1_epi8(value))));
+			}
+
+			FOUNDATION_SIMD_TARGET_AVX2 uint32_t match_non_full() const noexcept { return ~static_cast<uint32_t>(_mm256_movemask_epi8(ctrl)); }
+		};
+#endif
+
+		// Control bytes a new table compares per probe step. Read once per table allocation,
+		// the table keeps its width, so probes never touch it. 32 is the default only in builds
+		// that target AVX2. When AVX2 is found at runtime the probe can not be inlined into its
+		// caller, and that measured slower than inline 16 byte groups, so there it has to be
+		// asked for.
+#if FOUNDATION_SIMD_AVX2
+		inline std::atomic<size_t> g_swissProbeWidth = 32;
+#else
+		inline std::atomic<size_t> g_swissProbeWidth = 16;
+#endif
+
+		template <typename Group, concepts::SwissProbeBase Visitor>
+		inline auto swiss_probe_groups(int8_t* ctrl, size_t capacity, size_t startGroup, int8_t h2, Visitor& visit) noexcept
+		{
 #ifndef NDEBUG
 			size_t probes = 0;
 #endif
 
+			// A group wider than the table wraps onto its first slots again.
+			uint32_t slotMask = ~0u;
+			if constexpr(Group::width > SWISS_PROBE_CTRL_TAIL)
+			{
+				slotMask = capacity < Group::width ? (1u << capacity) - 1 : ~0u;
+			}
+
 			size_t group = startGroup;
 
 			for(;;)
 			{
-				simd128<int8_t> c = simd128<int8_t>::load(ctrl + group);
+				const Group g(ctrl + group);
 
 				// h2 matches, visitor decides
-				uint32_t matchMask = simd128<int8_t>::cmpeq(c, match).movemask();
+				uint32_t matchMask = g.match(h2) & slotMask;
 				while(matchMask)
 				{
 					uint32_t bit = std::countr_zero(matchMask);
-					size_t	 idx = (group + bit) & (capacity - 1);
+
+					// A 16 byte probe stops at the first 16 slot group holding an EMPTY, a wider
+					// group does not look past it either.
+					if constexpr(Group::width > SWISS_PROBE_CTRL_TAIL)
+					{
+						if(bit >= SWISS_PROBE_CTRL_TAIL && (g.match(SWISS_PROBE_CTRL_EMPTY) & 0xFFFF))
+						{
+							break;
+						}
+					}
+
+					size_t idx = (group + bit) & (capacity - 1);
 
 					if(visit.on_match(idx))
 					{
@@ -70,11 +162,13 @@ namespace opus3d::foundation
 					matchMask &= matchMask - 1;
 				}
 
-				// deleted, visitor decides
+				uint32_t emptyMask = g.match(SWISS_PROBE_CTRL_EMPTY) & slotMask;
+
+				// deleted, visitor decides. Only those before the first EMPTY, so an insert takes
+				// the first free slot of the sequence whatever the group width.
 				if constexpr(concepts::SwissProbeDeleted<Visitor>)
 				{
-					simd128<int8_t> deleted(SWISS_PROBE_CTRL_DELETED);
-					uint32_t	delMask = simd128<int8_t>::cmpeq(c, deleted).movemask();
+					uint32_t delMask = g.match(SWISS_PROBE_CTRL_DELETED) & ((emptyMask & (0u - emptyMask)) - 1);
 					while(delMask)
 					{
 						uint32_t bit = std::countr_zero(delMask);
@@ -87,7 +181,6 @@ namespace opus3d::foundation
 				}
 
 				// empty, visitor decides
-				uint32_t emptyMask = simd128<int8_t>::cmpeq(c, empty).movemask();
 				if(emptyMask)
 				{
 					uint32_t bit = std::countr_zero(emptyMask);
@@ -98,38 +191,159 @@ namespace opus3d::foundation
 				}
 
 				// advance probe
-				group = (group + GROUP_SIZE) & (capacity - 1);
+				group = (group + Group::width) & (capacity - 1);
 
 				DEBUG_ASSERT_MSG(probes++ < capacity, "SwissTable invariant violated: no EMPTY slot");
 			}
 		}
+
+		// First EMPTY or DELETED slot in the probe sequence from startGroup.
+		template <typename Group>
+		inline size_t swiss_find_first_non_full_groups(const int8_t* ctrl, size_t capacity, size_t startGroup) noexcept
+		{
+			for(size_t group = startGroup;; group = (group + Group::width) & (capacity - 1))
+			{
+				if(const uint32_t freeMask = Group(ctrl + group).match_non_full(); freeMask)
+				{
+					return (group + std::countr_zero(freeMask)) & (capacity - 1);
+				}
+			}
+		}
+
+#if FOUNDATION_SIMD_X64
+		template <concepts::SwissProbeBase Visitor>
+		FOUNDATION_SIMD_TARGET_AVX2 inline auto swiss_probe_avx2(int8_t* ctrl, size_t capacity, size_t startGroup, int8_t h2, Visitor& visit) noexcept
+		{
+			return swiss_probe_groups<SwissGroup32>(ctrl, capacity, startGroup, h2, visit);
+		}
+
+		FOUNDATION_SIMD_TARGET_AVX2 inline size_t swiss_find_first_non_full_avx2(const int8_t* ctrl, size_t capacity, size_t startGroup) noexcept
+		{
+			return swiss_find_first_non_full_groups<SwissGroup32>(ctrl, capacity, startGroup);
+		}
+#endif
+
+		template <concepts::SwissProbeBase Visitor>
+		inline auto swiss_probe(int8_t* ctrl, size_t capacity, size_t width, size_t startGroup, int8_t h2, Visitor& visit) noexcept
+		{
+#if FOUNDATION_SIMD_X64
+			if(width == 32)
+			{
+				return swiss_probe_avx2(ctrl, capacity, startGroup, h2, visit);
+			}
+#endif
+			(void)width;
+			return swiss_probe_groups<SwissGroup16>(ctrl, capacity, startGroup, h2, visit);
+		}
+
+		inline size_t swiss_find_first_non_full(const int8_t* ctrl, size_t capacity, size_t width, size_t startGroup) noexcept
+		{
+#if FOUNDATION_SIMD_X64
+			if(width == 32)
+			{
+				return swiss_find_first_non_full_avx2(ctrl, capacity, startGroup);
+			}
+#endif
+			(void)width;
+			return swiss_find_first_non_full_groups<SwissGroup16>(ctrl, capacity, startGroup);
+		}
 	} // namespace detail
 
+	// Control bytes a new FlatHashMap table compares per probe step, 16 or 32.
+	inline size_t flat_hash_map_probe_width() noexcept { return detail::g_swissProbeWidth.load(std::memory_order_relaxed); }
+
+	// Overrides the default width, 32 needs a CPU with AVX2. Only tables allocated after the
+	// call use it, a live map keeps its width until it grows.
+	inline void set_flat_hash_map_probe_width(size_t width) noexcept
+	{
+		ASSERT(width == 16 || (width == 32 && simd::cpu_has_avx2()));
+		detail::g_swissProbeWidth.store(width, std::memory_order_relaxed);
+	}
+
 	// Swiss Table Flat HashMap (SIMD enhanced)
 	//
 	// NOTE: this class has some hard requirements:
 	//
 	// Capacity must be clamped >= SIMD minimum size and must be power of 2.
 	// EMPTY slots must always exist.
+	//
+	// Alloc works like VectorDynamic's: memory::Allocator by default, or any
+	// memory::AllocatorType, by reference for stateful allocators.
+	//
+	// Hash must spread its result over all bits, the low 7 bits are h2. foundation::Hash
+	// does, std::hash does not for integers.
 
-	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	template <typename Key, typename Value, typename Hash = foundation::Hash<Key>, typename Alloc = memory::Allocator>
 		requires HashFor<Hash, Key>
 	class FlatHashMap
 	{
 	public:
 
-		FlatHashMap(memory::Allocator allocator, size_t entries = 16) noexcept;
+		// What a lookup costs, to judge a hasher by.
+		struct ProbeLength
+		{
+			uint32_t groups;      // 16 slot groups from the first probed to the one the lookup ends in.
+			uint32_t keyCompares; // h2 matches that needed a key compare.
+		};
+
+		FlatHashMap(Alloc allocator, size_t entries = 16) noexcept;
 
 		~FlatHashMap();
 
 		void clear() noexcept;
 
+		// Drops every entry and the table in O(1), no entries are visited and no control
+		// bytes are reset. The table is only freed if the allocator's frees are not no-ops,
+		// so a frame-temporary map in an arena costs nothing to discard. The map is empty
+		// afterwards and allocates a new table on the next insert. Only for trivially
+		// destructible keys and values.
+		void abandon() noexcept;
+
+		// What try_emplace and find_or_insert hand back: the value stored under the key and
+		// whether this call created it.
+		struct InsertResult
+		{
+			Value& value;
+			bool   inserted;
+		};
+
+		// Inserts value, or assigns it to the value already stored under key.
 		Result<void> insert(const Key& key, Value value) noexcept;
 
+		// Constructs the value from args unless key is present. An existing value is left
+		// alone, args are not touched and the table does not grow, so references into it stay
+		// valid. Either way the key is hashed once and the table probed once.
+		template <typename... Args>
+		Result<InsertResult> try_emplace(const Key& key, Args&&... args) noexcept;
+
+		// The value under key, value-initialized first if key was not present.
+		Result<InsertResult> find_or_insert(const Key& key) noexcept;
+
 		Result<Value*> find(const Key& key) noexcept;
 
+		// Looks up by anything the hasher and the key compare take directly, a string_view
+		// for std::string keys say, without constructing a key. Hash must be transparent.
+		template <typename K>
+			requires detail::concepts::TransparentLookup<Hash, Key, K>
+		Result<Value*> find(const K& key) noexcept;
+
+		// Looks up every key, results[i] is the value of keys[i] or nullptr. Keys are handled
+		// in batches: all of a batch is hashed and its control groups and first candidate
+		// entries are prefetched before any probe runs, so the cache misses overlap instead
+		// of stalling each lookup in turn. Pays off when the table is larger than the cache.
+		void find_many(std::span<const Key> keys, std::span<Value*> results) noexcept;
+
+		// Probes for key like find() and reports how far it went.
+		ProbeLength probe_length(const Key& key) noexcept;
+
 		bool erase(const Key& key) noexcept;
 
+		template <typename K>
+			requires detail::concepts::TransparentLookup<Hash, Key, K>
+		bool erase(const K& key) noexcept;
+
+		// Moves every entry into a table of newCapacity slots (rounded up to a power of two).
+		// At the current capacity no memory is allocated, tombstones are purged in place.
 		void rehash(size_t newCapacity) noexcept;
 
 	private:
@@ -138,13 +352,19 @@ namespace opus3d::foundation
 		{
 			Key   key;
 			Value value;
+
+			template <typename... Args>
+			Entry(const Key& k, Args&&... args) : key(k), value(std::forward<Args>(args)...)
+			{
+			}
 		};
 
+		template <typename K>
 		struct FindVisitor
 		{
-			Entry*	   entries;
-			const Key& key;
-			Value*	   found = nullptr;
+			Entry*	 entries;
+			const K& key;
+			Value*	 found = nullptr;
 
 			bool on_match(size_t idx) noexcept
 			{
@@ -169,11 +389,37 @@ namespace opus3d::foundation
 			Value* result() const noexcept { return found; }
 		};
 
-		struct EraseVisitor
+		struct ProbeLengthVisitor
 		{
 			Entry*	   entries;
-			int8_t*	   ctrl;
 			const Key& key;
+			size_t	   groupStart;
+			size_t	   capacity;
+			uint32_t   keyCompares = 0;
+			size_t	   end	       = 0;
+
+			bool on_match(size_t idx) noexcept
+			{
+				++keyCompares;
+				end = idx;
+				return entries[idx].key == key;
+			}
+
+			void on_empty(size_t idx) noexcept { end = idx; }
+
+			ProbeLength result() const noexcept
+			{
+				return ProbeLength{.groups = static_cast<uint32_t>(((end - groupStart) & (capacity - 1)) / GROUP_SIZE + 1), .keyCompares = keyCompares};
+			}
+		};
+
+		template <typename K>
+		struct EraseVisitor
+		{
+			Entry*	 entries;
+			int8_t*	 ctrl;
+			size_t	 capacity;
+			const K& key;
 
 			bool erased = false;
 
@@ -185,7 +431,7 @@ namespace opus3d::foundation
 					std::destroy_at(entries + idx);
 
 					// Mark as DELETED
-					ctrl[idx] = CTRL_DELETED;
+					detail::swiss_set_ctrl(ctrl, capacity, idx, CTRL_DELETED);
 
 					erased = true;
 					return true; // stop probing
@@ -210,20 +456,18 @@ namespace opus3d::foundation
 		struct InsertVisitor
 		{
 			Entry*	   entries;
-			int8_t*	   ctrl;
 			const Key& key;
-			Value&	   value;
 
 			size_t firstDeleted = static_cast<size_t>(-1);
-			size_t insertIndex  = static_cast<size_t>(-1);
+			size_t index	    = static_cast<size_t>(-1);
 			bool   found	    = false;
 
 			bool on_match(size_t idx) noexcept
 			{
 				if(entries[idx].key == key)
 				{
-					entries[idx].value = std::move(value);
-					found		   = true;
+					index = idx;
+					found = true;
 					return true;
 				}
 				return false;
@@ -237,7 +481,7 @@ namespace opus3d::foundation
 				}
 			}
 
-			void on_empty(size_t idx) noexcept { insertIndex = (firstDeleted != static_cast<size_t>(-1)) ? firstDeleted : idx; }
+			void on_empty(size_t idx) noexcept { index = (firstDeleted != static_cast<size_t>(-1)) ? firstDeleted : idx; }
 
 			bool result() const noexcept { return found; }
 		};
@@ -248,12 +492,18 @@ namespace opus3d::foundation
 			size_t groupStart;
 		};
 
+		struct InsertSlot
+		{
+			size_t index;
+			bool   found;
+		};
+
 		static constexpr int8_t CTRL_EMPTY   = detail::SWISS_PROBE_CTRL_EMPTY;
 		static constexpr int8_t CTRL_DELETED = detail::SWISS_PROBE_CTRL_DELETED;
 
 		// Prevent future refactors from silently breaking SIMD logic.
-		static_assert(CTRL_EMPTY < 0);
-		static_assert(CTRL_DELETED < 0);
+		static_assert(CTRL_EMPTY == 0, "allocate() relies on zeroed memory being empty");
+		static_assert(CTRL_DELETED >= 0);
 
 	private:
 
@@ -261,6 +511,25 @@ namespace opus3d::foundation
 
 		Result<void> allocate(size_t entries) noexcept;
 
+		// The one probe of every insert. Returns the slot holding key, or a free slot already
+		// claimed for it: its control byte is set and counted, the entry is for the caller to
+		// construct before anything else touches the map. Only a miss may grow the table,
+		// the free slot is then looked up again in the new one.
+		Result<InsertSlot> prepare_insert(const Key& key) noexcept;
+
+		template <typename K>
+		Value* lookup(const K& key) noexcept;
+
+		template <typename K>
+		bool erase_key(const K& key) noexcept;
+
+		// Allocates an empty table of exactly capacity slots, a power of two.
+		Result<void> allocate_slots(size_t capacity) noexcept;
+
+		// Reclaims every tombstone without allocating, entries are moved closer to the
+		// start of their probe sequence where that frees up a slot.
+		void drop_deleted_without_resize() noexcept;
+
 		size_t storage_block_size(size_t entries) const noexcept;
 
 		// Returns the start of the metadata array:
@@ -269,9 +538,12 @@ namespace opus3d::foundation
 		// Returns the start of the Entry array.
 		Entry* entries() noexcept;
 
-		ProbeSeed make_probe_seed(const Key& key) const noexcept;
+		template <typename K>
+		ProbeSeed make_probe_seed(const K& key) const noexcept;
 
-		static inline bool is_full(int8_t ctrl) noexcept { return ctrl >= 0; }
+		ProbeSeed probe_seed(size_t hash) const noexcept;
+
+		static inline bool is_full(int8_t ctrl) noexcept { return ctrl < 0; }
 
 		static inline bool is_empty(int8_t ctrl) noexcept { return ctrl == CTRL_EMPTY; }
 
@@ -291,17 +563,25 @@ namespace opus3d::foundation
 		// number of deleted-but-not-empty slots
 		size_t m_tombstones = 0;
 
-		Hash	  m_hash = {};
-		Allocator m_allocator;
+		// control bytes per probe step, fixed when the table is allocated
+		size_t m_probeWidth = GROUP_SIZE;
+
+		Hash				m_hash = {};
+		memory::AllocatorHandle<Alloc> m_allocator;
 
 		static constexpr size_t GROUP_SIZE   = simd::simd128<int8_t>::width;
 		static constexpr size_t CTRL_ALIGN   = alignof(simd::simd128<int8_t>);
 		static constexpr size_t MIN_CAPACITY = GROUP_SIZE;
+
+		static_assert(GROUP_SIZE == detail::SWISS_PROBE_CTRL_TAIL, "The control tail must cover a 32 byte load from the last group");
+
+		// Lookups find_many keeps in flight, about what a core can have outstanding in misses.
+		static constexpr size_t FIND_BATCH = 16;
 	};
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	FlatHashMap<Key, Value, Hash>::FlatHashMap(Allocator allocator, size_t entries) noexcept : m_allocator(allocator), m_capacity(0)
+	FlatHashMap<Key, Value, Hash, Alloc>::FlatHashMap(Alloc allocator, size_t entries) noexcept : m_allocator(allocator), m_capacity(0)
 	{
 		// Capacity is set in allocate.
 		// TODO: create a factory method that returns Result cleanly
@@ -311,18 +591,52 @@ namespace opus3d::foundation
 		}
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	FlatHashMap<Key, Value, Hash, Alloc>::~FlatHashMap()
+	{
+		// The control bytes do not need resetting, the table is going away.
+		if constexpr(!std::is_trivially_destructible_v<Entry>)
+		{
+			if(m_data)
+			{
+				int8_t* ctrl = metadata();
+				Entry*	ent  = entries();
+
+				for(size_t i = 0; i < m_capacity; ++i)
+				{
+					if(is_full(ctrl[i]))
+					{
+						std::destroy_at(ent + i);
+					}
+				}
+			}
+		}
+
+		deallocate();
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	FlatHashMap<Key, Value, Hash>::~FlatHashMap()
+	void FlatHashMap<Key, Value, Hash, Alloc>::abandon() noexcept
 	{
-		clear();
+		static_assert(std::is_trivially_destructible_v<Entry>, "abandon() would skip destructors, use clear()");
+
 		deallocate();
+
+		m_size	     = 0;
+		m_tombstones = 0;
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	void FlatHashMap<Key, Value, Hash>::clear() noexcept
+	void FlatHashMap<Key, Value, Hash, Alloc>::clear() noexcept
 	{
+		if(!m_data)
+		{
+			return;
+		}
+
 		int8_t* ctrl = metadata();
 		Entry*	ent  = entries();
 
@@ -344,62 +658,224 @@ namespace opus3d::foundation
 		m_tombstones = 0;
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	Result<void> FlatHashMap<Key, Value, Hash>::insert(const Key& key, Value value) noexcept
+	Result<typename FlatHashMap<Key, Value, Hash, Alloc>::InsertSlot> FlatHashMap<Key, Value, Hash, Alloc>::prepare_insert(const Key& key) noexcept
 	{
-		// TODO: write clear message explaing the math here.
+		// An abandoned map has no table.
+		if(!m_data)
+		{
+			if(Result<void> alloc = allocate(MIN_CAPACITY); !alloc.has_value())
+			{
+				return Unexpected(alloc.error());
+			}
+		}
+
+		const size_t hash = m_hash(key);
+
+		auto [h2, groupStart] = probe_seed(hash);
+
+		InsertVisitor visitor{entries(), key};
+
+		if(detail::swiss_probe(metadata(), m_capacity, m_probeWidth, groupStart, h2, visitor))
+		{
+			return InsertSlot{.index = visitor.index, .found = true};
+		}
+
+		// Only a new key can grow the table, a hit leaves every reference into it valid.
+		// The table is full at 3/4 load. Tombstones count because they lengthen probes like
+		// live entries. If live entries fill at most 5/8 of the table the tombstones are to
+		// blame, they are purged in place and the next purge is at least 1/8 of the capacity
+		// in inserts away. Otherwise the table doubles.
 		if((m_size + m_tombstones + 1) * 4 >= m_capacity * 3)
 		{
-			rehash(m_capacity * 2);
+			rehash((m_size + 1) * 8 <= m_capacity * 5 ? m_capacity : m_capacity * 2);
+
+			// No tombstones are left, the first free slot of the new sequence is EMPTY.
+			visitor.index	     = detail::swiss_find_first_non_full(metadata(), m_capacity, m_probeWidth, probe_seed(hash).groupStart);
+			visitor.firstDeleted = static_cast<size_t>(-1);
 		}
 
-		Entry*	ent  = entries();
-		int8_t* ctrl = metadata();
+		detail::swiss_set_ctrl(metadata(), m_capacity, visitor.index, h2);
+
+		if(visitor.firstDeleted != static_cast<size_t>(-1))
+		{
+			--m_tombstones;
+		}
+
+		++m_size;
+
+		return InsertSlot{.index = visitor.index, .found = false};
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	Result<void> FlatHashMap<Key, Value, Hash, Alloc>::insert(const Key& key, Value value) noexcept
+	{
+		Result<InsertSlot> slot = prepare_insert(key);
+		if(!slot.has_value())
+		{
+			return Unexpected(slot.error());
+		}
+
+		Entry* ent = entries() + slot.value().index;
+		if(slot.value().found)
+		{
+			ent->value = std::move(value);
+		}
+		else
+		{
+			std::construct_at(ent, key, std::move(value));
+		}
+
+		return {};
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	template <typename... Args>
+	Result<typename FlatHashMap<Key, Value, Hash, Alloc>::InsertResult> FlatHashMap<Key, Value, Hash, Alloc>::try_emplace(const Key& key, Args&&... args) noexcept
+	{
+		Result<InsertSlot> slot = prepare_insert(key);
+		if(!slot.has_value())
+		{
+			return Unexpected(slot.error());
+		}
+
+		Entry* ent = entries() + slot.value().index;
+		if(!slot.value().found)
+		{
+			std::construct_at(ent, key, std::forward<Args>(args)...);
+		}
+
+		return InsertResult{.value = ent->value, .inserted = !slot.value().found};
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	Result<typename FlatHashMap<Key, Value, Hash, Alloc>::InsertResult> FlatHashMap<Key, Value, Hash, Alloc>::find_or_insert(const Key& key) noexcept
+	{
+		return try_emplace(key);
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	Result<Value*> FlatHashMap<Key, Value, Hash, Alloc>::find(const Key& key) noexcept
+	{
+		return lookup(key);
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	template <typename K>
+		requires detail::concepts::TransparentLookup<Hash, Key, K>
+	Result<Value*> FlatHashMap<Key, Value, Hash, Alloc>::find(const K& key) noexcept
+	{
+		return lookup(key);
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	template <typename K>
+	Value* FlatHashMap<Key, Value, Hash, Alloc>::lookup(const K& key) noexcept
+	{
+		if(m_capacity == 0 || m_size == 0)
+		{
+			return nullptr;
+		}
 
 		auto [h2, groupStart] = make_probe_seed(key);
 
-		InsertVisitor visitor{ent, ctrl, key, value};
+		FindVisitor<K> visitor{entries(), key};
+
+		return detail::swiss_probe(metadata(), m_capacity, m_probeWidth, groupStart, h2, visitor);
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	void FlatHashMap<Key, Value, Hash, Alloc>::find_many(std::span<const Key> keys, std::span<Value*> results) noexcept
+	{
+		using Group = simd::simd128<int8_t>;
 
-		bool existed = detail::swiss_probe(ctrl, m_capacity, groupStart, h2, visitor);
+		ASSERT(results.size() >= keys.size());
 
-		if(!existed)
+		if(m_capacity == 0 || m_size == 0)
 		{
-			size_t idx = visitor.insertIndex;
+			std::fill_n(results.begin(), keys.size(), nullptr);
+			return;
+		}
+
+		int8_t* ctrl = metadata();
+		Entry*	ent  = entries();
+
+		ProbeSeed seeds[FIND_BATCH];
 
-			std::construct_at(ent + idx, key, std::move(value));
-			ctrl[idx] = h2;
+		for(size_t base = 0; base < keys.size(); base += FIND_BATCH)
+		{
+			const size_t count = std::min(FIND_BATCH, keys.size() - base);
 
-			if(visitor.firstDeleted != static_cast<size_t>(-1))
+			// Hash the batch and start loading every first control group.
+			for(size_t i = 0; i < count; ++i)
 			{
-				--m_tombstones;
+				seeds[i] = make_probe_seed(keys[base + i]);
+				simd::prefetch(ctrl + seeds[i].groupStart);
 			}
 
-			++m_size;
-		}
+			// The groups are in cache or on their way, start loading the first h2 match of each.
+			for(size_t i = 0; i < count; ++i)
+			{
+				const Group    group	 = Group::load(ctrl + seeds[i].groupStart);
+				const uint32_t matchMask = Group::movemask(Group::cmpeq(group, Group(seeds[i].h2)));
+				if(matchMask)
+				{
+					simd::prefetch(ent + seeds[i].groupStart + std::countr_zero(matchMask));
+				}
+			}
 
-		return {};
+			for(size_t i = 0; i < count; ++i)
+			{
+				FindVisitor<Key> visitor{ent, keys[base + i]};
+				results[base + i] = detail::swiss_probe(ctrl, m_capacity, m_probeWidth, seeds[i].groupStart, seeds[i].h2, visitor);
+			}
+		}
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	Result<Value*> FlatHashMap<Key, Value, Hash>::find(const Key& key) noexcept
+	typename FlatHashMap<Key, Value, Hash, Alloc>::ProbeLength FlatHashMap<Key, Value, Hash, Alloc>::probe_length(const Key& key) noexcept
 	{
 		if(m_capacity == 0 || m_size == 0)
 		{
-			return nullptr;
+			return ProbeLength{.groups = 0, .keyCompares = 0};
 		}
 
 		auto [h2, groupStart] = make_probe_seed(key);
 
-		FindVisitor visitor{entries(), key};
+		ProbeLengthVisitor visitor{entries(), key, groupStart, m_capacity};
+
+		return detail::swiss_probe(metadata(), m_capacity, m_probeWidth, groupStart, h2, visitor);
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	bool FlatHashMap<Key, Value, Hash, Alloc>::erase(const Key& key) noexcept
+	{
+		return erase_key(key);
+	}
 
-		return detail::swiss_probe(metadata(), m_capacity, groupStart, h2, visitor);
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	template <typename K>
+		requires detail::concepts::TransparentLookup<Hash, Key, K>
+	bool FlatHashMap<Key, Value, Hash, Alloc>::erase(const K& key) noexcept
+	{
+		return erase_key(key);
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	bool FlatHashMap<Key, Value, Hash>::erase(const Key& key) noexcept
+	template <typename K>
+	bool FlatHashMap<Key, Value, Hash, Alloc>::erase_key(const K& key) noexcept
 	{
 		if(m_size == 0)
 		{
@@ -411,9 +887,9 @@ namespace opus3d::foundation
 
 		auto [h2, groupStart] = make_probe_seed(key);
 
-		EraseVisitor visitor{ent, ctrl, key};
+		EraseVisitor<K> visitor{ent, ctrl, m_capacity, key};
 
-		bool erased = detail::swiss_probe(ctrl, m_capacity, groupStart, h2, visitor);
+		bool erased = detail::swiss_probe(ctrl, m_capacity, m_probeWidth, groupStart, h2, visitor);
 
 		if(erased)
 		{
@@ -424,68 +900,136 @@ namespace opus3d::foundation
 		return erased;
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	void FlatHashMap<Key, Value, Hash>::rehash(size_t newCapacity) noexcept
+	void FlatHashMap<Key, Value, Hash, Alloc>::rehash(size_t newCapacity) noexcept
 	{
-		DEBUG_ASSERT_MSG(newCapacity >= m_size * 2, "Rehash capacity too small");
+		DEBUG_ASSERT_MSG(newCapacity >= m_size * 2 || newCapacity == m_capacity, "Rehash capacity too small");
 
-		// Allocate new table
-		FlatHashMap tmp(m_allocator, newCapacity);
+		const size_t pow2Capacity = std::bit_ceil(std::max<size_t>(GROUP_SIZE, newCapacity));
 
-		Entry*	oldEntries = entries();
-		int8_t* oldCtrl	   = metadata();
+		if(pow2Capacity == m_capacity)
+		{
+			drop_deleted_without_resize();
+			return;
+		}
 
-		for(size_t i = 0; i < m_capacity; ++i)
+		std::byte* oldData     = m_data;
+		size_t	   oldCapacity = m_capacity;
+		Entry*	   oldEntries  = m_data ? entries() : nullptr;
+		int8_t*	   oldCtrl     = m_data ? metadata() : nullptr;
+
+		if(Result<void> alloc = allocate_slots(pow2Capacity); !alloc.has_value())
 		{
-			if(is_full(oldCtrl[i]))
-			{
-				tmp.insert(std::move(oldEntries[i].key), std::move(oldEntries[i].value));
-			}
+			panic("FlatHashMap: oom", alloc.error());
 		}
 
-		// Destroy old entries
-		if constexpr(!std::is_trivially_destructible_v<Entry>)
+		Entry*	ent  = entries();
+		int8_t* ctrl = metadata();
+
+		// Keys are unique already, entries go straight to the first free slot of their probe.
+		for(size_t i = 0; i < oldCapacity; ++i)
 		{
-			for(size_t i = 0; i < m_capacity; ++i)
+			if(is_full(oldCtrl[i]))
 			{
-				if(is_full(oldCtrl[i]))
+				auto [h2, groupStart] = make_probe_seed(oldEntries[i].key);
+				const size_t idx      = detail::swiss_find_first_non_full(ctrl, m_capacity, m_probeWidth, groupStart);
+
+				std::construct_at(ent + idx, std::move(oldEntries[i]));
+				detail::swiss_set_ctrl(ctrl, m_capacity, idx, h2);
+
+				if constexpr(!std::is_trivially_destructible_v<Entry>)
 				{
 					std::destroy_at(oldEntries + i);
 				}
 			}
 		}
 
-		// Free old memory
-		deallocate();
+		if(oldData)
+		{
+			m_allocator.deallocate(oldData, storage_block_size(oldCapacity), CTRL_ALIGN);
+		}
 
-		// Steal tmp's storage
-		m_data	     = tmp.m_data;
-		m_capacity   = tmp.m_capacity;
-		m_size	     = tmp.m_size;
 		m_tombstones = 0;
 
-		tmp.m_data = nullptr; // prevent double free
-
 		// Sanity checks for debug.
 		DEBUG_ASSERT(m_size <= m_capacity);
-		DEBUG_ASSERT(m_tombstones == 0);
 		DEBUG_ASSERT(m_capacity >= GROUP_SIZE);
 		DEBUG_ASSERT(std::has_single_bit(m_capacity));
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	void FlatHashMap<Key, Value, Hash>::deallocate() noexcept
+	void FlatHashMap<Key, Value, Hash, Alloc>::drop_deleted_without_resize() noexcept
 	{
-		m_allocator.deallocate(m_data, storage_block_size(m_capacity), CTRL_ALIGN);
+		if(!m_data)
+		{
+			return;
+		}
+
+		int8_t* ctrl = metadata();
+		Entry*	ent  = entries();
+
+		// Tombstones become EMPTY and live entries DELETED, DELETED now means "not placed yet".
+		for(size_t i = 0; i < m_capacity; ++i)
+		{
+			ctrl[i] = is_full(ctrl[i]) ? CTRL_DELETED : CTRL_EMPTY;
+		}
+		std::memcpy(ctrl + m_capacity, ctrl, GROUP_SIZE);
+
+		for(size_t i = 0; i < m_capacity; ++i)
+		{
+			// Placed entries are never moved again, so every group in front of the one an entry
+			// lands in stays full and lookups still reach it.
+			while(is_deleted(ctrl[i]))
+			{
+				auto [h2, groupStart] = make_probe_seed(ent[i].key);
+				const size_t target   = detail::swiss_find_first_non_full(ctrl, m_capacity, m_probeWidth, groupStart);
+
+				// Already in the first group with room, it stays.
+				if((target & ~(GROUP_SIZE - 1)) == (i & ~(GROUP_SIZE - 1)))
+				{
+					detail::swiss_set_ctrl(ctrl, m_capacity, i, h2);
+					break;
+				}
+
+				if(is_empty(ctrl[target]))
+				{
+					std::construct_at(ent + target, std::move(ent[i]));
+					if constexpr(!std::is_trivially_destructible_v<Entry>)
+					{
+						std::destroy_at(ent + i);
+					}
+
+					detail::swiss_set_ctrl(ctrl, m_capacity, target, h2);
+					detail::swiss_set_ctrl(ctrl, m_capacity, i, CTRL_EMPTY);
+					break;
+				}
+
+				// The target holds an entry that is not placed yet, swap and place that one next.
+				std::swap(ent[i], ent[target]);
+				detail::swiss_set_ctrl(ctrl, m_capacity, target, h2);
+			}
+		}
+
+		m_tombstones = 0;
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	void FlatHashMap<Key, Value, Hash, Alloc>::deallocate() noexcept
+	{
+		if(m_data)
+		{
+			m_allocator.deallocate(m_data, storage_block_size(m_capacity), CTRL_ALIGN);
+		}
 		m_data	   = nullptr;
 		m_capacity = 0;
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	Result<void> FlatHashMap<Key, Value, Hash>::allocate(size_t entries) noexcept
+	Result<void> FlatHashMap<Key, Value, Hash, Alloc>::allocate(size_t entries) noexcept
 	{
 		// Ensure we have enough room for the load factor (e.g., max 75% full)
 		// load factor of 0.75 (4/3 ratio)
@@ -493,16 +1037,23 @@ namespace opus3d::foundation
 
 		// Entries *MUST* be a power of 2 for the bitwise logic to work.
 		// And it must be at least minimum GROUP_SIZE for SIMD.
-		size_t pow2Entries = std::bit_ceil(std::max<size_t>(GROUP_SIZE, required));
+		return allocate_slots(std::bit_ceil(std::max<size_t>(GROUP_SIZE, required)));
+	}
 
-		const size_t size = storage_block_size(pow2Entries);
-		if(Result<void*> alloc = m_allocator.try_allocate(size, CTRL_ALIGN); alloc.has_value())
-		{
-			m_capacity = pow2Entries;
-			m_data	   = std::assume_aligned<CTRL_ALIGN>(static_cast<std::byte*>(alloc.value()));
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	Result<void> FlatHashMap<Key, Value, Hash, Alloc>::allocate_slots(size_t capacity) noexcept
+	{
+		DEBUG_ASSERT(capacity >= GROUP_SIZE && std::has_single_bit(capacity));
 
-			// SwissTable requires control bytes initialized to Empty (0x80).
-			std::memset(metadata(), static_cast<int>(CTRL_EMPTY), m_capacity + GROUP_SIZE);
+		const size_t size = storage_block_size(capacity);
+		// Zeroed control bytes are all EMPTY. Large tables come straight from fresh OS pages
+		// that way and are never written before their first insert.
+		if(Result<void*> alloc = m_allocator.try_allocate_zeroed(size, CTRL_ALIGN); alloc.has_value())
+		{
+			m_capacity   = capacity;
+			m_probeWidth = detail::g_swissProbeWidth.load(std::memory_order_relaxed);
+			m_data	     = std::assume_aligned<CTRL_ALIGN>(static_cast<std::byte*>(alloc.value()));
 
 			return {};
 		}
@@ -512,9 +1063,9 @@ namespace opus3d::foundation
 		}
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	size_t FlatHashMap<Key, Value, Hash>::storage_block_size(size_t entries) const noexcept
+	size_t FlatHashMap<Key, Value, Hash, Alloc>::storage_block_size(size_t entries) const noexcept
 	{
 		// Calculate the actual storage size required
 		// if called with m_capacity returns the actual storage size.
@@ -533,16 +1084,16 @@ namespace opus3d::foundation
 		return metadataSize + padding + (entries * sizeof(Entry));
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	int8_t* FlatHashMap<Key, Value, Hash>::metadata() noexcept
+	int8_t* FlatHashMap<Key, Value, Hash, Alloc>::metadata() noexcept
 	{
 		return std::assume_aligned<CTRL_ALIGN>(reinterpret_cast<int8_t*>(m_data));
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	typename FlatHashMap<Key, Value, Hash>::Entry* FlatHashMap<Key, Value, Hash>::entries() noexcept
+	typename FlatHashMap<Key, Value, Hash, Alloc>::Entry* FlatHashMap<Key, Value, Hash, Alloc>::entries() noexcept
 	{
 		const size_t metadataSize = m_capacity + GROUP_SIZE;
 		const size_t entryAlign	  = alignof(Entry);
@@ -553,13 +1104,20 @@ namespace opus3d::foundation
 		return std::assume_aligned<alignof(Entry)>(std::launder(reinterpret_cast<Entry*>(ptr)));
 	}
 
-	template <typename Key, typename Value, typename Hash>
+	template <typename Key, typename Value, typename Hash, typename Alloc>
 		requires HashFor<Hash, Key>
-	FlatHashMap<Key, Value, Hash>::ProbeSeed FlatHashMap<Key, Value, Hash>::make_probe_seed(const Key& key) const noexcept
+	template <typename K>
+	FlatHashMap<Key, Value, Hash, Alloc>::ProbeSeed FlatHashMap<Key, Value, Hash, Alloc>::make_probe_seed(const K& key) const noexcept
 	{
-		const size_t hash = m_hash(key);
-		const int8_t h2	  = static_cast<int8_t>(hash & 0x7F);
-		const size_t h1	  = hash >> 7;
+		return probe_seed(m_hash(key));
+	}
+
+	template <typename Key, typename Value, typename Hash, typename Alloc>
+		requires HashFor<Hash, Key>
+	FlatHashMap<Key, Value, Hash, Alloc>::ProbeSeed FlatHashMap<Key, Value, Hash, Alloc>::probe_seed(size_t hash) const noexcept
+	{
+		const int8_t h2 = static_cast<int8_t>(0x80 | (hash & 0x7F));
+		const size_t h1 = hash >> 7;
 
 		size_t index	  = h1 & (m_capacity - 1);
 		size_t groupStart = index & ~(GROUP_SIZE - 1);
@@ -1,9 +1,17 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
+#include <cstring>
 #include <functional>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
 namespace opus3d::foundation
 {
 	template <typename H, typename K>
@@ -12,4 +20,122 @@ namespace opus3d::foundation
 		// 2. Is the result convertible to size_t?
 		{ hasher(key) } -> std::convertible_to<std::size_t>;
 	} && std::copy_constructible<H>; // Hashers usually need to be copyable for containers
+
+	namespace detail
+	{
+		// Full 64x64 -> 128 bit product, high and low halves folded together.
+		inline uint64_t hash_fold_mul(uint64_t a, uint64_t b) noexcept
+		{
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+			uint64_t high;
+			const uint64_t low = _umul128(a, b, &high);
+			return low ^ high;
+#elif defined(_MSC_VER) && !defined(__clang__)
+			return (a * b) ^ __umulh(a, b);
+#else
+			const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+			return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#endif
+		}
+
+		inline uint64_t hash_load64(const uint8_t* p) noexcept
+		{
+			uint64_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		inline uint64_t hash_load32(const uint8_t* p) noexcept
+		{
+			uint32_t v;
+			std::memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		inline constexpr uint64_t HASH_SECRET[] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull};
+	} // namespace detail
+
+	// Spreads every bit of value over the whole result, low bits included. A multiply and a
+	// fold of the product's halves, sequential integers come out as unrelated hashes.
+	inline size_t hash_mix(uint64_t value) noexcept { return detail::hash_fold_mul(value ^ detail::HASH_SECRET[0], detail::HASH_SECRET[1]); }
+
+	// Hashes size bytes, 16 per step with one multiply each. Shaped after wyhash, not
+	// compatible with it, and not meant to be stored: results may differ between builds.
+	inline size_t hash_bytes(const void* data, size_t size) noexcept
+	{
+		using namespace detail;
+
+		const uint8_t* p    = static_cast<const uint8_t*>(data);
+		uint64_t       seed = HASH_SECRET[0];
+		uint64_t       a    = 0;
+		uint64_t       b    = 0;
+
+		if(size <= 16)
+		{
+			if(size >= 4)
+			{
+				// Two overlapping 4 byte loads from each end cover 4 to 16 bytes.
+				const size_t middle = (size >> 3) << 2;
+				a		    = (hash_load32(p) << 32) | hash_load32(p + middle);
+				b		    = (hash_load32(p + size - 4) << 32) | hash_load32(p + size - 4 - middle);
+			}
+			else if(size > 0)
+			{
+				a = (uint64_t(p[0]) << 16) | (uint64_t(p[size >> 1]) << 8) | p[size - 1];
+			}
+		}
+		else
+		{
+			size_t remaining = size;
+			while(remaining > 16)
+			{
+				seed = hash_fold_mul(hash_load64(p) ^ HASH_SECRET[1], hash_load64(p + 8) ^ seed);
+				p += 16;
+				remaining -= 16;
+			}
+
+			// The last 16 bytes, overlapping what the loop already took.
+			a = hash_load64(p + remaining - 16);
+			b = hash_load64(p + remaining - 8);
+		}
+
+		return hash_fold_mul(HASH_SECRET[2] ^ size, hash_fold_mul(a ^ HASH_SECRET[1], b ^ seed));
+	}
+
+	// Default hasher of the containers. std::hash is the identity for integers and pointers on
+	// the common standard libraries, FlatHashMap takes h2 from the low 7 bits and h1 from the
+	// rest, so sequential keys would share groups and collide on h2. This one mixes.
+	template <typename T>
+	struct Hash
+	{
+		size_t operator()(const T& value) const noexcept(noexcept(std::hash<T>{}(value))) { return hash_mix(std::hash<T>{}(value)); }
+	};
+
+	template <typename T>
+		requires std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>
+	struct Hash<T>
+	{
+		size_t operator()(T value) const noexcept
+		{
+			if constexpr(std::is_pointer_v<T>)
+			{
+				return hash_mix(reinterpret_cast<uintptr_t>(value));
+			}
+			else
+			{
+				return hash_mix(static_cast<uint64_t>(value));
+			}
+		}
+	};
+
+	// Strings hash their bytes, so every type viewable as a string_view hashes alike. That
+	// makes it transparent: maps keyed by std::string look up by string_view or literals.
+	template <typename T>
+		requires std::is_convertible_v<const T&, std::string_view> && (!std::is_pointer_v<T>)
+	struct Hash<T>
+	{
+		using is_transparent = void;
+
+		size_t operator()(std::string_view text) const noexcept { return hash_bytes(text.data(), text.size()); }
+	};
 } // namespace opus3d::foundation
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <foundation/core/include/result.hpp>
 
 #include <foundation/memory/include/allocator.hpp>
+#include <cstring>
 #include <memory>
 #include <optional>
 
@@ -11,13 +12,17 @@ namespace opus3d::foundation
 {
 	// A VectorDynamic CANNOT exist without an allocator.
 	// A VectorDynamic MUST NOT outlive its allocator.
+	//
+	// Alloc is memory::Allocator by default. Any memory::AllocatorType can be used instead,
+	// by reference for stateful allocators, e.g. VectorDynamic<T, memory::LinearAllocator&>,
+	// which lets growth inline into the allocator instead of calling through a pointer.
 
-	template <typename T>
+	template <typename T, typename Alloc = memory::Allocator>
 	class VectorDynamic
 	{
 	public:
 
-		VectorDynamic(Allocator alloc) noexcept;
+		VectorDynamic(Alloc alloc) noexcept;
 
 		VectorDynamic(const VectorDynamic& rhs) noexcept;
 
@@ -53,6 +58,11 @@ namespace opus3d::foundation
 
 		void clear() noexcept;
 
+		// Drops the contents and the buffer without touching the elements, O(1). The buffer
+		// is only freed if the allocator's frees are not no-ops, e.g. a frame-temporary
+		// vector in an arena costs nothing to discard. Only for trivially destructible T.
+		void abandon() noexcept;
+
 		// shrink_to_fit()
 		// Attempts to reduce capacity to exactly size().
 		// This is an explicit, potentially expensive operation.
@@ -98,18 +108,18 @@ namespace opus3d::foundation
 
 	private:
 
-		Allocator m_allocator;
-		T*	  m_data     = nullptr;
-		size_t	  m_size     = 0;
-		size_t	  m_capacity = 0;
+		memory::AllocatorHandle<Alloc> m_allocator;
+		T*			       m_data	  = nullptr;
+		size_t			       m_size	  = 0;
+		size_t			       m_capacity = 0;
 	};
 
-	template <typename T>
-	VectorDynamic<T>::VectorDynamic(Allocator alloc) noexcept : m_allocator(alloc)
+	template <typename T, typename Alloc>
+	VectorDynamic<T, Alloc>::VectorDynamic(Alloc alloc) noexcept : m_allocator(alloc)
 	{}
 
-	template <typename T>
-	VectorDynamic<T>::VectorDynamic(const VectorDynamic& rhs) noexcept : m_allocator(rhs.m_allocator)
+	template <typename T, typename Alloc>
+	VectorDynamic<T, Alloc>::VectorDynamic(const VectorDynamic& rhs) noexcept : m_allocator(rhs.m_allocator)
 	{
 		static_assert(std::is_nothrow_copy_constructible_v<T>, "VectorDynamic does not support exceptions!");
 
@@ -134,8 +144,8 @@ namespace opus3d::foundation
 		}
 	}
 
-	template <typename T>
-	VectorDynamic<T>::VectorDynamic(VectorDynamic&& rhs) noexcept :
+	template <typename T, typename Alloc>
+	VectorDynamic<T, Alloc>::VectorDynamic(VectorDynamic&& rhs) noexcept :
 		m_allocator(rhs.m_allocator), m_data(rhs.m_data), m_size(rhs.m_size), m_capacity(rhs.m_capacity)
 	{
 		rhs.m_data     = nullptr;
@@ -143,14 +153,19 @@ namespace opus3d::foundation
 		rhs.m_capacity = 0;
 	}
 
-	template <typename T>
-	VectorDynamic<T>::~VectorDynamic() noexcept
+	template <typename T, typename Alloc>
+	VectorDynamic<T, Alloc>::~VectorDynamic() noexcept
 	{
 		clear();
+
+		if(m_data)
+		{
+			m_allocator.deallocate(m_data, sizeof(T) * m_capacity, alignof(T));
+		}
 	}
 
-	template <typename T>
-	VectorDynamic<T>& VectorDynamic<T>::operator=(VectorDynamic&& rhs) noexcept
+	template <typename T, typename Alloc>
+	VectorDynamic<T, Alloc>& VectorDynamic<T, Alloc>::operator=(VectorDynamic&& rhs) noexcept
 	{
 		if(this != &rhs)
 		{
@@ -188,8 +203,8 @@ namespace opus3d::foundation
 		return *this;
 	}
 
-	template <typename T>
-	VectorDynamic<T>& VectorDynamic<T>::operator=(const VectorDynamic& rhs) noexcept
+	template <typename T, typename Alloc>
+	VectorDynamic<T, Alloc>& VectorDynamic<T, Alloc>::operator=(const VectorDynamic& rhs) noexcept
 	{
 		if(this != &rhs)
 		{
@@ -217,9 +232,9 @@ namespace opus3d::foundation
 		return *this;
 	}
 
-	template <typename T>
+	template <typename T, typename Alloc>
 	template <typename... Args>
-	T& VectorDynamic<T>::emplace_back(Args&&... args)
+	T& VectorDynamic<T, Alloc>::emplace_back(Args&&... args)
 	{
 		if(m_size == m_capacity)
 		{
@@ -231,24 +246,24 @@ namespace opus3d::foundation
 		return m_data[m_size++];
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::push_back(const T& value)
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::push_back(const T& value)
 	{
 		emplace_back(value);
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::push_back(T&& value)
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::push_back(T&& value)
 	{
 		emplace_back(std::move(value));
 	}
 
-	template <typename T>
-	[[nodiscard]] Result<void> VectorDynamic<T>::try_push_back(const T& value)
+	template <typename T, typename Alloc>
+	[[nodiscard]] Result<void> VectorDynamic<T, Alloc>::try_push_back(const T& value)
 	{
 		if(m_size == m_capacity)
 		{
-			if(Result res = try_grow_capacity(); !res.has_value())
+			if(Result<void> res = try_grow_capacity(); !res.has_value())
 			{
 				return res;
 			}
@@ -258,8 +273,8 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::pop_back() noexcept
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::pop_back() noexcept
 	{
 		DEBUG_ASSERT(m_size > 0);
 		if constexpr(!std::is_trivially_destructible_v<T>)
@@ -269,8 +284,8 @@ namespace opus3d::foundation
 		--m_size;
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::resize(size_t n) noexcept
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::resize(size_t n) noexcept
 	{
 		if(n < m_size)
 		{
@@ -280,6 +295,16 @@ namespace opus3d::foundation
 			}
 			m_size = n;
 		}
+		else if(n > m_size && !m_data && std::is_trivially_default_constructible_v<T>)
+		{
+			// A fresh buffer, e.g. a grid or bitset, can come from memory that is already zero.
+			Result<void*> alloc = m_allocator.try_allocate_zeroed(sizeof(T) * n, alignof(T));
+			ASSERT_MSG(alloc.has_value(), "Out of memory");
+
+			m_data	   = static_cast<T*>(alloc.value());
+			m_size	   = n;
+			m_capacity = n;
+		}
 		else if(n > m_size)
 		{
 			reserve(n);
@@ -297,8 +322,8 @@ namespace opus3d::foundation
 		}
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::erase_unordered(size_t index) noexcept
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::erase_unordered(size_t index) noexcept
 	{
 		DEBUG_ASSERT(index < m_size);
 		if(index != m_size - 1)
@@ -308,20 +333,35 @@ namespace opus3d::foundation
 		pop_back();
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::reserve(size_t n) noexcept
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::reserve(size_t n) noexcept
 	{
 		Result<void> r = try_reserve(n);
 		ASSERT_MSG(r.has_value(), "Out of memory");
 	}
 
-	template <typename T>
-	[[nodiscard]] Result<void> VectorDynamic<T>::try_reserve(size_t n) noexcept
+	template <typename T, typename Alloc>
+	[[nodiscard]] Result<void> VectorDynamic<T, Alloc>::try_reserve(size_t n) noexcept
 	{
 		static_assert(std::is_nothrow_move_constructible_v<T>, "VectorDynamic does not support exceptions!");
 
 		if(n > m_capacity)
 		{
+			// Growing in place avoids the copy entirely. The allocator may move the block
+			// bytewise, which is only valid for trivially copyable elements.
+			if constexpr(std::is_trivially_copyable_v<T>)
+			{
+				if(m_data)
+				{
+					if(Result<void*> r = m_allocator.try_resize(m_data, sizeof(T) * m_capacity, sizeof(T) * n, alignof(T)); r.has_value())
+					{
+						m_data	   = static_cast<T*>(r.value());
+						m_capacity = n;
+						return {};
+					}
+				}
+			}
+
 			Result<T*> newBlock = try_allocate_objects(n);
 			if(!newBlock.has_value())
 			{
@@ -363,8 +403,8 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::clear() noexcept
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::clear() noexcept
 	{
 		static_assert(std::is_nothrow_destructible_v<T>, "VectorDynamic does not support exceptions!");
 
@@ -375,8 +415,23 @@ namespace opus3d::foundation
 		m_size = 0;
 	}
 
-	template <typename T>
-	Result<void> VectorDynamic<T>::shrink_to_fit() noexcept
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::abandon() noexcept
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "abandon() would skip destructors, use clear()");
+
+		if(m_data)
+		{
+			m_allocator.deallocate(m_data, sizeof(T) * m_capacity, alignof(T));
+		}
+
+		m_data	   = nullptr;
+		m_size	   = 0;
+		m_capacity = 0;
+	}
+
+	template <typename T, typename Alloc>
+	Result<void> VectorDynamic<T, Alloc>::shrink_to_fit() noexcept
 	{
 		if(m_size == m_capacity)
 		{
@@ -438,36 +493,36 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	template <typename T>
-	T& VectorDynamic<T>::operator[](size_t i) noexcept
+	template <typename T, typename Alloc>
+	T& VectorDynamic<T, Alloc>::operator[](size_t i) noexcept
 	{
 		DEBUG_ASSERT(i < m_size);
 		return m_data[i];
 	}
 
-	template <typename T>
-	const T& VectorDynamic<T>::operator[](size_t i) const noexcept
+	template <typename T, typename Alloc>
+	const T& VectorDynamic<T, Alloc>::operator[](size_t i) const noexcept
 	{
 		DEBUG_ASSERT(i < m_size);
 		return m_data[i];
 	}
 
-	template <typename T>
-	T& VectorDynamic<T>::at(size_t i) noexcept
+	template <typename T, typename Alloc>
+	T& VectorDynamic<T, Alloc>::at(size_t i) noexcept
 	{
 		ASSERT(i < m_size);
 		return m_data[i];
 	}
 
-	template <typename T>
-	const T& VectorDynamic<T>::at(size_t i) const noexcept
+	template <typename T, typename Alloc>
+	const T& VectorDynamic<T, Alloc>::at(size_t i) const noexcept
 	{
 		ASSERT(i < m_size);
 		return m_data[i];
 	}
 
-	template <typename T>
-	std::optional<size_t> VectorDynamic<T>::find(const T& value) const noexcept
+	template <typename T, typename Alloc>
+	std::optional<size_t> VectorDynamic<T, Alloc>::find(const T& value) const noexcept
 	{
 		for(size_t i = 0; i < m_size; ++i)
 		{
@@ -479,10 +534,10 @@ namespace opus3d::foundation
 		return std::nullopt;
 	}
 
-	template <typename T>
+	template <typename T, typename Alloc>
 	template <typename Pred>
 		requires std::predicate<Pred, const T&>
-	std::optional<size_t> VectorDynamic<T>::find_if(Pred&& pred) noexcept
+	std::optional<size_t> VectorDynamic<T, Alloc>::find_if(Pred&& pred) noexcept
 	{
 		for(size_t i = 0; i < m_size; ++i)
 		{
@@ -494,68 +549,70 @@ namespace opus3d::foundation
 		return std::nullopt;
 	}
 
-	template <typename T>
-	bool VectorDynamic<T>::empty() const noexcept
+	template <typename T, typename Alloc>
+	bool VectorDynamic<T, Alloc>::empty() const noexcept
 	{
 		return m_size == 0;
 	}
 
-	template <typename T>
-	size_t VectorDynamic<T>::size() const noexcept
+	template <typename T, typename Alloc>
+	size_t VectorDynamic<T, Alloc>::size() const noexcept
 	{
 		return m_size;
 	}
 
-	template <typename T>
-	size_t VectorDynamic<T>::capacity() const noexcept
+	template <typename T, typename Alloc>
+	size_t VectorDynamic<T, Alloc>::capacity() const noexcept
 	{
 		return m_capacity;
 	}
 
-	template <typename T>
-	T* VectorDynamic<T>::data() noexcept
+	template <typename T, typename Alloc>
+	T* VectorDynamic<T, Alloc>::data() noexcept
 	{
 		return m_data;
 	}
 
-	template <typename T>
-	const T* VectorDynamic<T>::data() const noexcept
+	template <typename T, typename Alloc>
+	const T* VectorDynamic<T, Alloc>::data() const noexcept
 	{
 		return m_data;
 	}
 
-	template <typename T>
-	T* VectorDynamic<T>::begin() noexcept
+	template <typename T, typename Alloc>
+	T* VectorDynamic<T, Alloc>::begin() noexcept
 	{
 		return m_data;
 	}
 
-	template <typename T>
-	const T* VectorDynamic<T>::begin() const noexcept
+	template <typename T, typename Alloc>
+	const T* VectorDynamic<T, Alloc>::begin() const noexcept
 	{
 		return m_data;
 	}
 
-	template <typename T>
-	T* VectorDynamic<T>::end() noexcept
+	template <typename T, typename Alloc>
+	T* VectorDynamic<T, Alloc>::end() noexcept
 	{
 		return m_data + m_size;
 	}
 
-	template <typename T>
-	const T* VectorDynamic<T>::end() const noexcept
+	template <typename T, typename Alloc>
+	const T* VectorDynamic<T, Alloc>::end() const noexcept
 	{
 		return m_data + m_size;
 	}
 
-	template <typename T>
-	T* VectorDynamic<T>::allocate_objects(size_t n) noexcept
+	template <typename T, typename Alloc>
+	T* VectorDynamic<T, Alloc>::allocate_objects(size_t n) noexcept
 	{
-		return m_allocator.allocate(sizeof(T) * n, alignof(T));
+		Result<T*> alloc = try_allocate_objects(n);
+		ASSERT_MSG(alloc.has_value(), "Out of memory");
+		return alloc.value();
 	}
 
-	template <typename T>
-	Result<T*> VectorDynamic<T>::try_allocate_objects(size_t n) noexcept
+	template <typename T, typename Alloc>
+	Result<T*> VectorDynamic<T, Alloc>::try_allocate_objects(size_t n) noexcept
 	{
 		// MSVC can't handle Result without <void*>
 		if(Result<void*> alloc = m_allocator.try_allocate(sizeof(T) * n, alignof(T)); alloc.has_value())
@@ -568,15 +625,15 @@ namespace opus3d::foundation
 		}
 	}
 
-	template <typename T>
-	void VectorDynamic<T>::grow_capacity()
+	template <typename T, typename Alloc>
+	void VectorDynamic<T, Alloc>::grow_capacity()
 	{
 		size_t new_cap = (m_capacity == 0) ? 8 : m_capacity * 2;
 		reserve(new_cap);
 	}
 
-	template <typename T>
-	Result<void> VectorDynamic<T>::try_grow_capacity()
+	template <typename T, typename Alloc>
+	Result<void> VectorDynamic<T, Alloc>::try_grow_capacity()
 	{
 		size_t new_cap = (m_capacity == 0) ? 8 : m_capacity * 2;
 		return try_reserve(new_cap);
@@ -226,7 +226,7 @@ namespace opus3d::foundation
 
 		if constexpr(!std::is_trivially_destructible_v<T>)
 		{
-			std::destroy_at(m_size - 1);
+			std::destroy_at(data() + m_size - 1);
 		}
 		--m_size;
 	}
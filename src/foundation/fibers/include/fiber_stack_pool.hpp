@@ -0,0 +1,129 @@
+#pragma once
+
+#include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation
+{
+	// Usable stack memory, pass base and size straight to Fiber.
+	struct FiberStack
+	{
+		void*  base = nullptr; // Lowest usable address, the guard page sits right below it.
+		size_t size = 0;
+	};
+
+	struct FiberStackPoolStats
+	{
+		size_t stackSize      = 0; // Usable bytes per stack, after page rounding.
+		size_t maxStacks      = 0;
+		size_t liveStacks     = 0;
+		size_t peakLiveStacks = 0;
+		size_t carvedStacks   = 0; // Stacks committed so far, they stay committed until destruction.
+	};
+
+	// Fixed-size fiber stacks carved out of one reserved address range.
+	//
+	// Every stack has a page below it that is never committed, so running off the end of
+	// a stack faults instead of silently corrupting the neighbour. Stack pages are only
+	// committed the first time a slot is handed out, after that acquire/release are a
+	// push/pop on an index stack and never touch the OS. Released stacks are reused LIFO,
+	// the most recently used stack is the one most likely to still be in cache.
+	//
+	// Not thread-safe, give each scheduler thread its own pool.
+	class FiberStackPool
+	{
+	public:
+
+		enum class IdlePolicy : uint8_t
+		{
+			KeepResident,	// Released stacks keep their physical pages.
+			DiscardOnRelease // Released stacks hand their pages back, costs a syscall and page faults on reuse.
+		};
+
+		[[nodiscard]] static Result<FiberStackPool> create(size_t stackSize, size_t maxStacks, IdlePolicy policy = IdlePolicy::KeepResident) noexcept;
+
+		FiberStackPool(const FiberStackPool&)		 = delete;
+		FiberStackPool& operator=(const FiberStackPool&) = delete;
+
+		FiberStackPool(FiberStackPool&& other) noexcept;
+		FiberStackPool& operator=(FiberStackPool&& other) noexcept;
+
+		~FiberStackPool() noexcept;
+
+		[[nodiscard]] Result<FiberStack> try_acquire() noexcept
+		{
+			if(m_freeCount > 0)
+			{
+				return on_acquired(m_freeSlots[--m_freeCount]);
+			}
+
+			return try_acquire_new();
+		}
+
+		[[nodiscard]] FiberStack acquire() noexcept
+		{
+			Result<FiberStack> stack = try_acquire();
+			ASSERT_MSG(stack.has_value(), "FiberStackPool out of stacks!");
+			return stack.value();
+		}
+
+		void release(FiberStack stack) noexcept;
+
+		// Hands the physical pages of every idle stack back to the OS.
+		void trim() noexcept;
+
+		bool owns(const void* ptr) const noexcept
+		{
+			const std::byte* p = static_cast<const std::byte*>(ptr);
+			return p >= m_slots && p < m_slots + m_carved * m_slotStride;
+		}
+
+		size_t stack_size() const noexcept { return m_stackSize; }
+		size_t max_stacks() const noexcept { return m_maxStacks; }
+		size_t live_stacks() const noexcept { return m_liveStacks; }
+
+		FiberStackPoolStats stats() const noexcept;
+
+	private:
+
+		FiberStackPool() = default;
+
+		FiberStack on_acquired(uint32_t slot) noexcept
+		{
+			if(++m_liveStacks > m_peakLiveStacks)
+			{
+				m_peakLiveStacks = m_liveStacks;
+			}
+			return FiberStack{.base = stack_base(slot), .size = m_stackSize};
+		}
+
+		std::byte* stack_base(uint32_t slot) const noexcept { return m_slots + slot * m_slotStride + m_guardSize; }
+
+		// Slow path: commits a slot that has never been used.
+		Result<FiberStack> try_acquire_new() noexcept;
+
+		void discard(uint32_t slot) noexcept;
+
+		void reset() noexcept;
+
+	private:
+
+		std::byte* m_base	    = nullptr; // Start of the reservation, holds m_freeSlots.
+		size_t	   m_reservedSize   = 0;
+		uint32_t*  m_freeSlots	    = nullptr; // LIFO of idle slot indices.
+		std::byte* m_slots	    = nullptr; // First slot, each is [guard page][stack].
+		size_t	   m_slotStride	    = 0;
+		size_t	   m_guardSize	    = 0;
+		size_t	   m_stackSize	    = 0;
+		uint32_t   m_maxStacks	    = 0;
+		uint32_t   m_carved	    = 0;
+		uint32_t   m_freeCount	    = 0;
+		uint32_t   m_liveStacks	    = 0;
+		uint32_t   m_peakLiveStacks = 0;
+		IdlePolicy m_policy	    = IdlePolicy::KeepResident;
+	};
+
+} // namespace opus3d::foundation
\ No newline at end of file
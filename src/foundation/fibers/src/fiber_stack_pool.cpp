@@ -0,0 +1,172 @@
+#include <foundation/fibers/include/fiber_stack_pool.hpp>
+
+#include <foundation/core/include/panic.hpp>
+#include <foundation/memory/include/alignment.hpp>
+#include <foundation/memory/include/memory_error.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include <utility>
+
+namespace opus3d::foundation
+{
+	Result<FiberStackPool> FiberStackPool::create(size_t stackSize, size_t maxStacks, IdlePolicy policy) noexcept
+	{
+		ASSERT_MSG(stackSize > 0 && maxStacks > 0, "FiberStackPool needs a stack size and a stack count");
+		ASSERT_MSG(maxStacks <= UINT32_MAX, "FiberStackPool stack count does not fit the slot index");
+
+		const size_t pageSize	= memory::get_system_page_size();
+		const size_t stack	= align_up(stackSize, pageSize);
+		const size_t stride	= stack + pageSize;
+		const size_t indexBytes = align_up(maxStacks * sizeof(uint32_t), pageSize);
+		const size_t total	= indexBytes + stride * maxStacks;
+
+		Result<void*> reserved = memory::reserve_pages(total);
+		if(!reserved.has_value())
+		{
+			return Unexpected(reserved.error());
+		}
+
+		std::byte* base = static_cast<std::byte*>(reserved.value());
+
+		// The index stack is tiny next to the stacks, commit all of it up front.
+		if(Result<void> commit = memory::commit_pages(base, indexBytes, memory::MemoryAccess::ReadWrite); !commit.has_value())
+		{
+			static_cast<void>(memory::release_pages(base, total));
+			return Unexpected(commit.error());
+		}
+
+		FiberStackPool pool;
+		pool.m_base	    = base;
+		pool.m_reservedSize = total;
+		pool.m_freeSlots    = reinterpret_cast<uint32_t*>(base);
+		pool.m_slots	    = base + indexBytes;
+		pool.m_slotStride   = stride;
+		pool.m_guardSize    = pageSize;
+		pool.m_stackSize    = stack;
+		pool.m_maxStacks    = static_cast<uint32_t>(maxStacks);
+		pool.m_policy	    = policy;
+		return pool;
+	}
+
+	FiberStackPool::FiberStackPool(FiberStackPool&& other) noexcept { *this = std::move(other); }
+
+	FiberStackPool& FiberStackPool::operator=(FiberStackPool&& other) noexcept
+	{
+		if(this != &other)
+		{
+			reset();
+
+			m_base		 = std::exchange(other.m_base, nullptr);
+			m_reservedSize	 = std::exchange(other.m_reservedSize, 0);
+			m_freeSlots	 = std::exchange(other.m_freeSlots, nullptr);
+			m_slots		 = std::exchange(other.m_slots, nullptr);
+			m_slotStride	 = std::exchange(other.m_slotStride, 0);
+			m_guardSize	 = std::exchange(other.m_guardSize, 0);
+			m_stackSize	 = std::exchange(other.m_stackSize, 0);
+			m_maxStacks	 = std::exchange(other.m_maxStacks, 0);
+			m_carved	 = std::exchange(other.m_carved, 0);
+			m_freeCount	 = std::exchange(other.m_freeCount, 0);
+			m_liveStacks	 = std::exchange(other.m_liveStacks, 0);
+			m_peakLiveStacks = std::exchange(other.m_peakLiveStacks, 0);
+			m_policy	 = other.m_policy;
+		}
+		return *this;
+	}
+
+	FiberStackPool::~FiberStackPool() noexcept { reset(); }
+
+	void FiberStackPool::release(FiberStack stack) noexcept
+	{
+		if(!stack.base)
+		{
+			return;
+		}
+
+		DEBUG_ASSERT_MSG(owns(stack.base), "Stack does not belong to this FiberStackPool!");
+		DEBUG_ASSERT_MSG(stack.size == m_stackSize, "Stack size does not match the pool!");
+
+		const size_t offset = static_cast<size_t>(static_cast<std::byte*>(stack.base) - m_slots);
+		DEBUG_ASSERT_MSG(offset % m_slotStride == m_guardSize, "Pointer is not the base of a stack!");
+
+		const uint32_t slot = static_cast<uint32_t>(offset / m_slotStride);
+
+		if(m_policy == IdlePolicy::DiscardOnRelease)
+		{
+			discard(slot);
+		}
+
+		m_freeSlots[m_freeCount++] = slot;
+		--m_liveStacks;
+	}
+
+	void FiberStackPool::trim() noexcept
+	{
+		for(uint32_t i = 0; i < m_freeCount; ++i)
+		{
+			discard(m_freeSlots[i]);
+		}
+	}
+
+	FiberStackPoolStats FiberStackPool::stats() const noexcept
+	{
+		return FiberStackPoolStats{
+			.stackSize	= m_stackSize,
+			.maxStacks	= m_maxStacks,
+			.liveStacks	= m_liveStacks,
+			.peakLiveStacks = m_peakLiveStacks,
+			.carvedStacks	= m_carved,
+		};
+	}
+
+	Result<FiberStack> FiberStackPool::try_acquire_new() noexcept
+	{
+		ASSERT_MSG(m_base, "Acquiring from an unreserved FiberStackPool!");
+
+		if(m_carved == m_maxStacks)
+		{
+			return Unexpected(memory::create_memory_error(memory::MemoryErrorCode::OutOfMemory));
+		}
+
+		// Only the stack is committed, the guard page below it stays reserved and faults on access.
+		const uint32_t slot = m_carved;
+		if(Result<void> commit = memory::commit_pages(stack_base(slot), m_stackSize, memory::MemoryAccess::ReadWrite); !commit.has_value())
+		{
+			return Unexpected(commit.error());
+		}
+
+		++m_carved;
+		return on_acquired(slot);
+	}
+
+	void FiberStackPool::discard(uint32_t slot) noexcept
+	{
+		// Every fiber touches the topmost page on entry, it is not worth faulting in again.
+		const size_t discardSize = m_stackSize - m_guardSize;
+		if(discardSize > 0)
+		{
+			// Failing to hand pages back is not fatal, the stack simply stays resident.
+			static_cast<void>(memory::discard_pages(stack_base(slot), discardSize));
+		}
+	}
+
+	void FiberStackPool::reset() noexcept
+	{
+		if(m_base)
+		{
+			DEBUG_ASSERT_MSG(m_liveStacks == 0, "FiberStackPool destroyed while stacks are still in use!");
+
+			if(Result<void> release = memory::release_pages(m_base, m_reservedSize); !release.has_value())
+			{
+				panic("FiberStackPool::reset", release.error());
+			}
+
+			m_base	     = nullptr;
+			m_freeSlots  = nullptr;
+			m_slots	     = nullptr;
+			m_carved     = 0;
+			m_freeCount  = 0;
+			m_liveStacks = 0;
+		}
+	}
+
+} // namespace opus3d::foundation
\ No newline at end of file
@@ -5,21 +5,47 @@
 
 #include "memory_error.hpp"
 
+#include <concepts>
+#include <cstring>
 #include <memory>
 #include <type_traits>
 
 namespace opus3d::foundation::memory
 {
+	enum class AllocatorCaps : uint8_t
+	{
+		None = 0,
+
+		// deallocate does nothing, memory comes back in bulk (arena reset, scope exit).
+		// Containers skip their frees and any teardown that only exists to prepare for them.
+		NoopFree = 1 << 0
+	};
+
+	constexpr AllocatorCaps operator|(AllocatorCaps a, AllocatorCaps b) noexcept
+	{
+		return static_cast<AllocatorCaps>(static_cast<uint8_t>(a) | static_cast<uint8_t>(b));
+	}
+
+	constexpr bool has_flag(AllocatorCaps value, AllocatorCaps flag) noexcept { return (static_cast<uint8_t>(value) & static_cast<uint8_t>(flag)) != 0; }
+
 	class Allocator
 	{
 	public:
 
 		using AllocateFn   = Result<void*> (*)(void* ctx, size_t size, size_t alignment) noexcept;
 		using DeallocateFn = void (*)(void* ctx, void* ptr, size_t size, size_t alignment) noexcept;
+		// Optional. Resizes a live block and returns its address, the first
+		// min(old_size, new_size) bytes are preserved. Shrinking never moves the block,
+		// growing may move it bytewise, so containers of non trivially copyable objects
+		// should only grow through it when that is acceptable. On failure the original
+		// block is untouched.
 		using ResizeFn	   = Result<void*> (*)(void* ctx, void* ptr, size_t old_size, size_t new_size, size_t alignment) noexcept;
 
-		Allocator(void* context, AllocateFn allocFn, DeallocateFn deallocFn, ResizeFn resizeFn = nullptr) :
-			m_context(context), m_allocateFn(allocFn), m_deallocateFn(deallocFn), m_resizeFn(resizeFn)
+		// allocZeroedFn is optional, for allocators that can hand out memory known to be zero
+		// (fresh OS pages) without writing it. Without it try_allocate_zeroed memsets.
+		Allocator(void* context, AllocateFn allocFn, DeallocateFn deallocFn, ResizeFn resizeFn = nullptr, AllocatorCaps caps = AllocatorCaps::None,
+			  AllocateFn allocZeroedFn = nullptr) :
+			m_context(context), m_allocateFn(allocFn), m_deallocateFn(deallocFn), m_resizeFn(resizeFn), m_allocateZeroedFn(allocZeroedFn), m_caps(caps)
 		{}
 
 		Allocator(const Allocator&) = default;
@@ -32,17 +58,35 @@ namespace opus3d::foundation::memory
 
 		[[nodiscard]] void* allocate(size_t size, size_t alignment) noexcept
 		{
-			Result r = try_allocate(size, alignment);
+			Result<void*> r = try_allocate(size, alignment);
 			ASSERT_MSG(r.has_value(), "Out of memory");
 			return r.value();
 		}
 
+		// Like try_allocate, the block reads as all zero bytes.
+		[[nodiscard]] Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept
+		{
+			if(m_allocateZeroedFn)
+			{
+				return m_allocateZeroedFn(m_context, size, alignment);
+			}
+
+			Result<void*> r = try_allocate(size, alignment);
+			if(r.has_value() && size > 0)
+			{
+				std::memset(r.value(), 0, size);
+			}
+			return r;
+		}
+
 		void deallocate(void* ptr, size_t size, size_t alignment) noexcept
 		{
 			ASSERT_MSG(m_deallocateFn, "Allocator is missing deallocate_fn");
 			m_deallocateFn(m_context, ptr, size, alignment);
 		}
 
+		AllocatorCaps caps() const noexcept { return m_caps; }
+
 		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept
 		{
 			if(!m_resizeFn)
@@ -136,12 +180,176 @@ namespace opus3d::foundation::memory
 
 	private:
 
-		void*	     m_context	    = nullptr;
-		AllocateFn   m_allocateFn   = nullptr;
-		DeallocateFn m_deallocateFn = nullptr;
-		ResizeFn     m_resizeFn	    = nullptr;
+		void*	      m_context		 = nullptr;
+		AllocateFn    m_allocateFn	 = nullptr;
+		DeallocateFn  m_deallocateFn	 = nullptr;
+		ResizeFn      m_resizeFn	 = nullptr;
+		AllocateFn    m_allocateZeroedFn = nullptr;
+		AllocatorCaps m_caps		 = AllocatorCaps::None;
+	};
+
+	// Compile-time allocator interface.
+	//
+	// Containers take their allocator as a template parameter, memory::Allocator by default.
+	// Any type with these members works in its place, e.g. VectorDynamic<T, LinearAllocator&>,
+	// and allocation then compiles to an inlined bump or free-list pop instead of an indirect call.
+	template <typename A>
+	concept AllocatorType = requires(A& a, void* ptr, size_t size, size_t alignment) {
+		{ a.try_allocate(size, alignment) } -> std::same_as<Result<void*>>;
+		{ a.deallocate(ptr, size, alignment) } -> std::same_as<void>;
+	};
+
+	template <typename A>
+	concept ResizableAllocatorType = AllocatorType<A> && requires(A& a, void* ptr, size_t size, size_t alignment) {
+		{ a.try_resize(ptr, size, size, alignment) } -> std::same_as<Result<void*>>;
 	};
 
+	// Capabilities of an allocator type, declared as a static constexpr AllocatorCaps Caps
+	// member. Allocator reports the caps of whatever it wraps at runtime.
+	template <typename A>
+	constexpr AllocatorCaps allocator_caps(const A& allocator) noexcept
+	{
+		if constexpr(requires { A::Caps; })
+		{
+			return A::Caps;
+		}
+		else if constexpr(requires { allocator.caps(); })
+		{
+			return allocator.caps();
+		}
+		else
+		{
+			return AllocatorCaps::None;
+		}
+	}
+
+	// Zeroed allocation through an allocator type, memset unless the type has try_allocate_zeroed.
+	template <typename A>
+	Result<void*> allocate_zeroed(A& allocator, size_t size, size_t alignment) noexcept
+	{
+		if constexpr(requires { allocator.try_allocate_zeroed(size, alignment); })
+		{
+			return allocator.try_allocate_zeroed(size, alignment);
+		}
+		else
+		{
+			Result<void*> r = allocator.try_allocate(size, alignment);
+			if(r.has_value() && size > 0)
+			{
+				std::memset(r.value(), 0, size);
+			}
+			return r;
+		}
+	}
+
+	// How a container holds its allocator parameter. Allocator (or any other copyable
+	// allocator) is stored by value, A& is stored as a pointer to the allocator.
+	template <typename A>
+	class AllocatorHandle
+	{
+	public:
+
+		using Type = A;
+
+		static_assert(AllocatorType<A>, "AllocatorHandle: A does not satisfy memory::AllocatorType");
+
+		AllocatorHandle(const A& allocator) noexcept : m_allocator(allocator) {}
+
+		A& get() noexcept { return m_allocator; }
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept { return m_allocator.try_allocate(size, alignment); }
+
+		[[nodiscard]] Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept { return allocate_zeroed(m_allocator, size, alignment); }
+
+		// Constant for allocator types, a flag test for Allocator.
+		bool noop_free() const noexcept { return has_flag(allocator_caps(m_allocator), AllocatorCaps::NoopFree); }
+
+		void deallocate(void* ptr, size_t size, size_t alignment) noexcept
+		{
+			if(!noop_free())
+			{
+				m_allocator.deallocate(ptr, size, alignment);
+			}
+		}
+
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept
+		{
+			if constexpr(ResizableAllocatorType<A>)
+			{
+				return m_allocator.try_resize(ptr, oldSize, newSize, alignment);
+			}
+			else
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::AllocatorNoResize));
+			}
+		}
+
+		// Buffers can only be handed over between equal allocators.
+		bool operator==(const AllocatorHandle& rhs) const noexcept
+		{
+			if constexpr(std::equality_comparable<A>)
+			{
+				return m_allocator == rhs.m_allocator;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+	private:
+
+		A m_allocator;
+	};
+
+	template <typename A>
+	class AllocatorHandle<A&>
+	{
+	public:
+
+		using Type = A;
+
+		static_assert(AllocatorType<A>, "AllocatorHandle: A does not satisfy memory::AllocatorType");
+
+		AllocatorHandle(A& allocator) noexcept : m_allocator(&allocator) {}
+
+		A& get() noexcept { return *m_allocator; }
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept { return m_allocator->try_allocate(size, alignment); }
+
+		[[nodiscard]] Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept { return allocate_zeroed(*m_allocator, size, alignment); }
+
+		bool noop_free() const noexcept { return has_flag(allocator_caps(*m_allocator), AllocatorCaps::NoopFree); }
+
+		void deallocate(void* ptr, size_t size, size_t alignment) noexcept
+		{
+			if(!noop_free())
+			{
+				m_allocator->deallocate(ptr, size, alignment);
+			}
+		}
+
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept
+		{
+			if constexpr(ResizableAllocatorType<A>)
+			{
+				return m_allocator->try_resize(ptr, oldSize, newSize, alignment);
+			}
+			else
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::AllocatorNoResize));
+			}
+		}
+
+		bool operator==(const AllocatorHandle& rhs) const noexcept { return m_allocator == rhs.m_allocator; }
+
+	private:
+
+		A* m_allocator;
+	};
+
+	static_assert(ResizableAllocatorType<Allocator>);
+
 	// Unique ptr deleter + typedef
 
 	template <typename T>
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+#include "memory_error.hpp"
+#include "virtual_range.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation::memory
+{
+	struct ConcurrentPoolStats
+	{
+		size_t blockSize      = 0;
+		size_t liveBlocks     = 0; // Approximate while other threads are allocating.
+		size_t carvedBlocks   = 0;
+		size_t maxBlocks      = 0;
+		size_t committedBytes = 0;
+	};
+
+	// Fixed-size block pool that any thread may allocate from and free to.
+	//
+	// Every thread owns a small cache of free blocks inside the pool, so the common case
+	// touches no shared state at all. Caches refill from, and spill back to, a lock-free
+	// global stack in batches of BatchSize blocks. A block freed on a thread other than
+	// the one that allocated it simply lands in the freeing thread's cache and travels
+	// back to the global stack with the next batch.
+	//
+	// The global stack is addressed by 32-bit block indices paired with a 32-bit tag that
+	// changes on every update, which makes the compare-exchange ABA-safe.
+	//
+	// Cache slots outlive their threads: a thread that exits leaves its cached blocks to
+	// the next thread that takes the slot. Workers can call flush_thread_cache() before
+	// exiting to hand them back right away.
+	//
+	// Only committing new slabs takes a lock. Creating, moving and destroying the pool
+	// are not thread-safe.
+	class ConcurrentPoolAllocator
+	{
+	public:
+
+		// Threads beyond this count share the global stack directly.
+		static constexpr uint32_t MaxThreadSlots = 64;
+
+		// Blocks moved between a thread cache and the global stack at once.
+		static constexpr uint32_t BatchSize = 32;
+
+		// Pages are committed in slabs of at least this size.
+		static constexpr size_t SlabSize = 64 * 1024;
+
+		[[nodiscard]] static Result<ConcurrentPoolAllocator> create(size_t blockSize, size_t blockAlignment, size_t maxBlocks) noexcept;
+
+		ConcurrentPoolAllocator(const ConcurrentPoolAllocator&)		   = delete;
+		ConcurrentPoolAllocator& operator=(const ConcurrentPoolAllocator&) = delete;
+
+		ConcurrentPoolAllocator(ConcurrentPoolAllocator&& other) noexcept;
+		ConcurrentPoolAllocator& operator=(ConcurrentPoolAllocator&& other) noexcept;
+
+		[[nodiscard]] Result<void*> try_allocate() noexcept;
+
+		[[nodiscard]] void* allocate() noexcept
+		{
+			Result<void*> alloc = try_allocate();
+			ASSERT_MSG(alloc.has_value(), "ConcurrentPoolAllocator out of memory!");
+			return alloc.value();
+		}
+
+		// Allocator-compatible overload, fails if the request does not fit a block.
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept
+		{
+			if(size > m_stride || alignment > m_alignment)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::UnsupportedRequest));
+			}
+			return try_allocate();
+		}
+
+		void deallocate(void* ptr) noexcept;
+
+		void deallocate(void* ptr, size_t, size_t) noexcept { deallocate(ptr); }
+
+		// Hands the calling thread's cached blocks back to the global stack.
+		void flush_thread_cache() noexcept;
+
+		bool owns(const void* ptr) const noexcept
+		{
+			const std::byte* p = static_cast<const std::byte*>(ptr);
+			return p >= m_blocks && p < m_blocks + max_blocks() * m_stride;
+		}
+
+		size_t block_size() const noexcept { return m_stride; }
+		size_t block_alignment() const noexcept { return m_alignment; }
+		size_t max_blocks() const noexcept { return m_maxBlocks; }
+
+		ConcurrentPoolStats stats() const noexcept;
+
+	private:
+
+		static constexpr uint32_t NullIndex = UINT32_MAX;
+
+		// Layout of a block while it is free.
+		struct FreeBlock
+		{
+			uint32_t next;	     // Next block in the same batch or thread cache.
+			uint32_t nextBatch;  // Next batch on the global stack, only valid on a batch head.
+			uint32_t batchCount; // Blocks in this batch, only valid on a batch head.
+		};
+
+		// Owned by one thread at a time, padded so neighbouring caches never share a line.
+		struct alignas(64) ThreadCache
+		{
+			uint32_t	    head  = NullIndex;
+			uint32_t	    count = 0;
+			std::atomic<size_t> allocations{0};
+			std::atomic<size_t> frees{0};
+		};
+
+		ConcurrentPoolAllocator() = default;
+
+		FreeBlock* block_at(uint32_t index) const noexcept { return reinterpret_cast<FreeBlock*>(m_blocks + size_t(index) * m_stride); }
+
+		uint32_t index_of(const void* ptr) const noexcept
+		{
+			return static_cast<uint32_t>((static_cast<const std::byte*>(ptr) - m_blocks) / m_stride);
+		}
+
+		void	 push_batch(uint32_t head, uint32_t count) noexcept;
+		uint32_t pop_batch(uint32_t& count) noexcept;
+
+		// Slow path: links up to BatchSize never used blocks, committing a slab if needed.
+		uint32_t carve_batch(uint32_t& count) noexcept;
+
+		uint32_t acquire_batch(uint32_t& count) noexcept;
+
+		void lock_growth() noexcept;
+		void unlock_growth() noexcept;
+
+	private:
+
+		// [thread caches][blocks...], the cache array is committed at creation.
+		VirtualRange m_range;
+		ThreadCache* m_caches	 = nullptr;
+		std::byte*   m_blocks	 = nullptr;
+		size_t	     m_stride	 = 0;
+		size_t	     m_alignment = 0;
+		size_t	     m_maxBlocks = 0;
+
+		// Tagged head of the global batch stack: (tag << 32) | blockIndex.
+		alignas(64) std::atomic<uint64_t> m_globalHead{NullIndex};
+
+		// Only written while m_growing is held, atomic so stats() can read them.
+		alignas(64) std::atomic<bool> m_growing{false};
+		std::atomic<size_t> m_carved{0};    // Blocks handed out of the committed slabs so far.
+		std::atomic<size_t> m_committed{0}; // Bytes of block storage committed.
+	};
+
+	// Helper functions:
+
+	inline Allocator as_allocator(ConcurrentPoolAllocator& a) noexcept
+	{
+		static auto deallocFn = [](void* ctx, void* ptr, size_t, size_t) noexcept {
+			static_cast<ConcurrentPoolAllocator*>(ctx)->deallocate(ptr);
+		};
+		static auto poolAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<ConcurrentPoolAllocator*>(ctx)->try_allocate(size, alignment);
+		};
+
+		return Allocator(&a, poolAllocFn, deallocFn);
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+#include "memory_error.hpp"
+#include "virtual_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation::memory
+{
+	enum class StackEnd : uint8_t
+	{
+		Bottom, // Grows up from the start of the range, e.g. persistent load results.
+		Top	// Grows down from the end of the range, e.g. temporary decode buffers.
+	};
+
+	// Two bump stacks sharing one reserved VirtualRange, growing towards each other.
+	//
+	// Each end has its own marker and rewind, so a loader can drop every temporary on the
+	// top in O(1) without touching what it kept on the bottom. Pages are committed on
+	// demand from both ends. The committed pages of the two ends never overlap, so the
+	// stacks meet at page granularity: an allocation fails once it would need a page the
+	// other end has committed.
+	//
+	// Markers are the number of bytes in use at that end.
+	class DoubleEndedStackAllocator
+	{
+	public:
+
+		// Never decommit on rewind, each end keeps whatever it has committed.
+		static constexpr size_t RetainAllCommitted = SIZE_MAX;
+
+		// Pages are committed in chunks of at least this size to keep the slow path rare.
+		static constexpr size_t CommitChunkSize = 64 * 1024;
+
+		// retainedCommitBytes applies to each end separately.
+		[[nodiscard]] static Result<DoubleEndedStackAllocator> create(size_t reservedBytes, size_t retainedCommitBytes = RetainAllCommitted) noexcept;
+
+		DoubleEndedStackAllocator(const DoubleEndedStackAllocator&)	       = delete;
+		DoubleEndedStackAllocator& operator=(const DoubleEndedStackAllocator&) = delete;
+
+		DoubleEndedStackAllocator(DoubleEndedStackAllocator&& other) noexcept;
+		DoubleEndedStackAllocator& operator=(DoubleEndedStackAllocator&& other) noexcept;
+
+		[[nodiscard]] void* allocate(StackEnd end, size_t size, size_t alignment = alignof(std::max_align_t)) noexcept;
+
+		[[nodiscard]] Result<void*> try_allocate(StackEnd end, size_t size, size_t alignment) noexcept
+		{
+			return end == StackEnd::Bottom ? try_allocate_bottom(size, alignment) : try_allocate_top(size, alignment);
+		}
+
+		[[nodiscard]] Result<void*> try_allocate_bottom(size_t size, size_t alignment) noexcept
+		{
+			DEBUG_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+			const uintptr_t base	= reinterpret_cast<uintptr_t>(m_range.data());
+			const uintptr_t aligned = (base + m_bottom + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+			const size_t	begin	= static_cast<size_t>(aligned - base);
+
+			// Fast path: fits inside the pages the bottom has already committed.
+			if(size <= m_range.size() && begin <= m_range.size() - size)
+			{
+				m_bottom = begin + size;
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			return try_allocate_bottom_commit(begin, size);
+		}
+
+		[[nodiscard]] Result<void*> try_allocate_top(size_t size, size_t alignment) noexcept
+		{
+			DEBUG_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+			// Offsets are measured from the end of the range, the address is aligned downwards.
+			const uintptr_t end = reinterpret_cast<uintptr_t>(m_range.data()) + m_range.capacity();
+			if(size > m_range.capacity() - m_top)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+
+			const uintptr_t aligned = (end - m_top - size) & ~static_cast<uintptr_t>(alignment - 1);
+			const size_t	top	= static_cast<size_t>(end - aligned);
+
+			if(top <= m_topCommitted)
+			{
+				m_top = top;
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			return try_allocate_top_commit(top);
+		}
+
+		size_t marker(StackEnd end) const noexcept { return end == StackEnd::Bottom ? m_bottom : m_top; }
+
+		// O(1) unless pages above the retained commit of that end have to be released.
+		void rewind(StackEnd end, size_t m) noexcept
+		{
+			if(end == StackEnd::Bottom)
+			{
+				ASSERT(m <= m_bottom);
+				m_bottomPeak = std::max(m_bottomPeak, m_bottom);
+				m_bottom     = m;
+
+				if(m_range.size() > m_retainedCommit)
+				{
+					decommit_bottom();
+				}
+			}
+			else
+			{
+				ASSERT(m <= m_top);
+				m_topPeak = std::max(m_topPeak, m_top);
+				m_top	  = m;
+
+				if(m_topCommitted > m_retainedCommit)
+				{
+					decommit_top();
+				}
+			}
+		}
+
+		void reset(StackEnd end) noexcept { rewind(end, 0); }
+
+		void reset() noexcept
+		{
+			reset(StackEnd::Bottom);
+			reset(StackEnd::Top);
+		}
+
+		size_t used(StackEnd end) const noexcept { return marker(end); }
+		size_t peak_used(StackEnd end) const noexcept { return end == StackEnd::Bottom ? std::max(m_bottomPeak, m_bottom) : std::max(m_topPeak, m_top); }
+		size_t committed(StackEnd end) const noexcept { return end == StackEnd::Bottom ? m_range.size() : m_topCommitted; }
+
+		// Bytes left between the two stacks, ignoring alignment and the shared page.
+		size_t available() const noexcept { return m_range.capacity() - m_bottom - m_top; }
+		size_t capacity() const noexcept { return m_range.capacity(); }
+
+		std::byte*	 base() noexcept { return m_range.data(); }
+		const std::byte* base() const noexcept { return m_range.data(); }
+
+	private:
+
+		DoubleEndedStackAllocator() = default;
+
+		// Slow paths: commit enough pages at that end, top is the new marker of the top end.
+		Result<void*> try_allocate_bottom_commit(size_t begin, size_t size) noexcept;
+		Result<void*> try_allocate_top_commit(size_t top) noexcept;
+
+		// Release committed pages above max(marker, m_retainedCommit) of that end.
+		void decommit_bottom() noexcept;
+		void decommit_top() noexcept;
+
+	private:
+
+		// The bottom commits through the range itself, the top commits pages below the
+		// end of the range directly and the range releases them with the reservation.
+		VirtualRange m_range;
+		size_t	     m_bottom	      = 0;
+		size_t	     m_top	      = 0;
+		size_t	     m_topCommitted   = 0;
+		size_t	     m_bottomPeak     = 0;
+		size_t	     m_topPeak	      = 0;
+		size_t	     m_retainedCommit = RetainAllCommitted;
+	};
+
+	// Helper functions:
+
+	// Allocator view of one end, frees are no-ops and memory is released by rewinding that end.
+	inline Allocator as_allocator(DoubleEndedStackAllocator& a, StackEnd end) noexcept
+	{
+		static auto freeNoop	  = [](void*, void*, size_t, size_t) noexcept {};
+		static auto bottomAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<DoubleEndedStackAllocator*>(ctx)->try_allocate_bottom(size, alignment);
+		};
+		static auto topAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<DoubleEndedStackAllocator*>(ctx)->try_allocate_top(size, alignment);
+		};
+
+		const AllocatorCaps caps = AllocatorCaps::NoopFree;
+		return end == StackEnd::Bottom ? Allocator(&a, bottomAllocFn, freeNoop, nullptr, caps) : Allocator(&a, topAllocFn, freeNoop, nullptr, caps);
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
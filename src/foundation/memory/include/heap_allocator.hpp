@@ -5,14 +5,39 @@
 
 #include "allocator.hpp"
 
+#include <atomic>
 #include <memory>
 
 namespace opus3d::foundation::memory
 {
+	// General purpose allocator over the system heap.
+	//
+	// Small blocks (up to MaxSmallSize bytes, alignment up to MaxSmallAlignment) are served
+	// from per-thread magazines, one per size class. A magazine refills from, and spills to,
+	// a central cache shared by all threads in batches, and the central cache carves its
+	// blocks out of slabs taken from the system heap. In steady state a small allocation
+	// or free is a magazine push/pop without any lock or syscall. Larger blocks go straight
+	// to the system heap.
+	//
+	// Blocks of LargeBlockThreshold bytes and up are mapped directly from the OS. On Linux
+	// try_resize grows and shrinks them with mremap, so a large container buffer can
+	// double without its contents ever being copied.
+	//
+	// The caches are process wide, blocks may be freed by any HeapAllocator on any thread.
+	// Memory held by the caches is kept for reuse and not returned to the system.
 	class HeapAllocator
 	{
 	public:
 
+		static constexpr size_t MaxSmallSize	    = 1024;
+		static constexpr size_t MaxSmallAlignment   = 64;
+		static constexpr size_t LargeBlockThreshold = 256 * 1024;
+
+		HeapAllocator() = default;
+
+		HeapAllocator(const HeapAllocator&)	       = delete;
+		HeapAllocator& operator=(const HeapAllocator&) = delete;
+
 		Result<void*> try_allocate(size_t size, size_t alignment) noexcept;
 
 		void* allocate(size_t size, size_t alignment) noexcept
@@ -23,16 +48,44 @@ namespace opus3d::foundation::memory
 			return alloc.value();
 		}
 
+		// Large blocks are fresh page mappings and already zero, everything else is memset.
+		Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept;
+
+		// size and alignment must match the allocation, they select the size class.
 		void deallocate(void* ptr, size_t size, size_t alignment) noexcept;
 
-		size_t bytes_allocated() const noexcept { return m_totalAllocatedSize; }
+		// Succeeds when both sizes map to the same small size class, or when both are large
+		// blocks and the platform can remap pages. Fails with ResizeNotInPlace otherwise.
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept;
+
+		// Exact across threads, cheap enough to poll every frame.
+		size_t bytes_allocated() const noexcept;
+
+		size_t allocation_count() const noexcept;
+
+		// Returns the calling thread's cached blocks to the central cache.
+		// Runs automatically when a thread exits.
+		static void flush_thread_cache() noexcept;
+
+	private:
+
+		// The first threads each own a stripe and update it without read-modify-write,
+		// the rest share the last one. A stripe may wrap below zero when a block is freed
+		// on another thread than it was allocated on, the sum is still exact.
+		static constexpr size_t OwnedStatStripeCount = 15;
+
+		struct alignas(64) StatStripe
+		{
+			std::atomic<size_t> count{0};
+			std::atomic<size_t> bytes{0};
+		};
 
-		size_t allocation_count() const noexcept { return m_allocationCount; }
+		// Deltas are added modulo 2^64, pass size_t(-1) to subtract one.
+		void record(size_t countDelta, size_t bytesDelta) noexcept;
 
 	private:
 
-		size_t m_totalAllocatedSize = 0;
-		size_t m_allocationCount    = 0;
+		StatStripe m_stats[OwnedStatStripeCount + 1];
 	};
 
 	// Helper functions:
@@ -45,8 +98,15 @@ namespace opus3d::foundation::memory
 		static auto linearAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
 			return static_cast<HeapAllocator*>(ctx)->try_allocate(size, alignment);
 		};
+		static auto resizeFn = [](void* ctx, void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept {
+			return static_cast<HeapAllocator*>(ctx)->try_resize(ptr, oldSize, newSize, alignment);
+		};
+
+		static auto zeroedFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<HeapAllocator*>(ctx)->try_allocate_zeroed(size, alignment);
+		};
 
-		return Allocator(&a, linearAllocFn, deallocFn);
+		return Allocator(&a, linearAllocFn, deallocFn, resizeFn, AllocatorCaps::None, zeroedFn);
 	}
 
-} // namespace opus3d::foundation
\ No newline at end of file
+} // namespace opus3d::foundation::memory
\ No newline at end of file
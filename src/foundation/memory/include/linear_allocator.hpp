@@ -4,39 +4,152 @@
 #include <foundation/core/include/result.hpp>
 
 #include "allocator.hpp"
+#include "memory_error.hpp"
 #include "virtual_range.hpp"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 
 namespace opus3d::foundation::memory
 {
+	// Bump allocator over a reserved VirtualRange.
+	//
+	// The full address range is reserved up front, pages are committed on demand as the
+	// offset advances. Allocation is a pointer bump, the OS is only involved when the
+	// offset crosses the committed boundary.
+	//
+	// reset()/reset_to() rewind the offset. Committed pages above the retained commit
+	// (the "high-water mark") are handed back to the OS, everything below stays committed
+	// so the next frame does not pay for the page faults again.
 	class LinearAllocator
 	{
 	public:
 
-		static Result<LinearAllocator> create(size_t reservedBytes);
+		// Never decommit on reset, the arena keeps whatever it has committed.
+		static constexpr size_t RetainAllCommitted = SIZE_MAX;
 
-		explicit LinearAllocator(size_t reserveSize);
+		// Pages are committed in chunks of at least this size to keep the slow path rare.
+		static constexpr size_t CommitChunkSize = 64 * 1024;
 
-		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept;
+		// numa places the arena's pages, e.g. NumaPolicy::prefer(current_numa_node()) for a worker-owned arena.
+		[[nodiscard]] static Result<LinearAllocator> create(size_t reservedBytes, size_t retainedCommitBytes = RetainAllCommitted, NumaPolicy numa = {}) noexcept;
 
-		Result<void*> try_allocate(size_t size, size_t alignment) noexcept;
+		// Panics if the address range can not be reserved, prefer create().
+		explicit LinearAllocator(size_t reserveSize, size_t retainedCommitBytes = RetainAllCommitted) noexcept;
 
-		void reset() noexcept; // O(1)
+		LinearAllocator(const LinearAllocator&)		   = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+		LinearAllocator(LinearAllocator&& other) noexcept;
+		LinearAllocator& operator=(LinearAllocator&& other) noexcept;
+
+		[[nodiscard]] void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept;
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept
+		{
+			DEBUG_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0);
+
+			// Align the address, not the offset, so alignments above the page size work too.
+			const uintptr_t base	= reinterpret_cast<uintptr_t>(m_range.data());
+			const uintptr_t aligned = (base + m_offset + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+			const size_t	begin	= static_cast<size_t>(aligned - base);
+
+			// Fast path: fits inside the already committed pages.
+			if(size <= m_range.size() && begin <= m_range.size() - size)
+			{
+				m_offset = begin + size;
+				return reinterpret_cast<void*>(aligned);
+			}
+
+			return try_allocate_commit(begin, size);
+		}
+
+		// Memory above everything handed out since it was last committed is still zero from
+		// the OS, only the part of the block below that gets memset.
+		[[nodiscard]] Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept
+		{
+			const size_t  dirtyEnd = std::max(m_dirty, m_offset);
+			Result<void*> alloc    = try_allocate(size, alignment);
+
+			if(alloc.has_value())
+			{
+				const size_t begin = static_cast<size_t>(static_cast<std::byte*>(alloc.value()) - m_range.data());
+				if(begin < dirtyEnd)
+				{
+					std::memset(alloc.value(), 0, std::min(size, dirtyEnd - begin));
+				}
+			}
+
+			return alloc;
+		}
+
+		static constexpr AllocatorCaps Caps = AllocatorCaps::NoopFree;
+
+		// Memory is only released by reset()/reset_to().
+		void deallocate(void*, size_t, size_t) noexcept {}
+
+		// The most recent allocation grows and shrinks in place by moving the offset, any
+		// other block can only shrink (a no-op). Lets a vector on an arena grow without copies.
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t) noexcept
+		{
+			const size_t begin = static_cast<size_t>(static_cast<std::byte*>(ptr) - m_range.data());
+
+			if(begin + oldSize == m_offset)
+			{
+				// A shrink moves the offset back, keep what it reached.
+				m_peak	= std::max(m_peak, m_offset);
+				m_dirty = std::max(m_dirty, m_offset);
+
+				if(newSize <= m_range.size() - begin)
+				{
+					m_offset = begin + newSize;
+					return ptr;
+				}
+				return try_allocate_commit(begin, newSize);
+			}
+
+			if(newSize <= oldSize)
+			{
+				return ptr;
+			}
+			return Unexpected(create_memory_error(MemoryErrorCode::AllocatorNoResize));
+		}
+
+		// O(1) unless pages above the retained commit have to be released.
+		void reset() noexcept { reset_to(0); }
 
 		size_t marker() const noexcept { return m_offset; }
 
 		void reset_to(size_t m) noexcept
 		{
 			ASSERT(m <= m_offset);
+
+			// The peak is folded in here rather than on every allocation.
+			m_peak	 = std::max(m_peak, m_offset);
+			m_dirty	 = std::max(m_dirty, m_offset);
 			m_offset = m;
+
+			if(m_range.size() > m_retainedCommit)
+			{
+				decommit_unused();
+			}
 		}
 
+		// Bytes committed above this value are released on reset()/reset_to().
+		void set_retained_commit(size_t bytes) noexcept { m_retainedCommit = bytes; }
+
+		size_t retained_commit() const noexcept { return m_retainedCommit; }
+
 		size_t used() const noexcept { return m_offset; }
-		size_t peak_used() const noexcept { return m_peak; }
+		size_t peak_used() const noexcept { return std::max(m_peak, m_offset); }
 		size_t committed() const noexcept { return m_range.size(); }
 		size_t capacity() const noexcept { return m_range.capacity(); }
 
+		// Forgets the peak, e.g. at the start of a new measurement window.
+		void reset_peak() noexcept { m_peak = m_offset; }
+
 		std::byte*	 base() noexcept { return m_range.data(); }
 		const std::byte* base() const noexcept { return m_range.data(); }
 
@@ -44,23 +157,38 @@ namespace opus3d::foundation::memory
 
 		LinearAllocator() = default;
 
+		// Slow path: commits enough pages to fit [begin, begin + size).
+		Result<void*> try_allocate_commit(size_t begin, size_t size) noexcept;
+
+		// Releases committed pages above max(m_offset, m_retainedCommit).
+		void decommit_unused() noexcept;
+
 	private:
 
 		VirtualRange m_range;
-		size_t	     m_offset = 0;
-		size_t	     m_peak   = 0;
+		size_t	     m_offset	      = 0;
+		size_t	     m_peak	      = 0;
+		size_t	     m_dirty	      = 0; // Bytes at and above max(m_dirty, m_offset) are still zero.
+		size_t	     m_retainedCommit = RetainAllCommitted;
 	};
 
 	// Helper functions:
 
-	Allocator as_allocator(LinearAllocator& a) noexcept
+	inline Allocator as_allocator(LinearAllocator& a) noexcept
 	{
-		static auto freeNoop	  = [](void*, void*, size_t, size_t) noexcept {};
-		static auto linearAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+		static auto freeNoop	   = [](void*, void*, size_t, size_t) noexcept {};
+		static auto linearAllocFn  = [](void* ctx, size_t size, size_t alignment) noexcept {
 			return static_cast<LinearAllocator*>(ctx)->try_allocate(size, alignment);
 		};
+		static auto linearResizeFn = [](void* ctx, void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept {
+			return static_cast<LinearAllocator*>(ctx)->try_resize(ptr, oldSize, newSize, alignment);
+		};
+
+		static auto linearZeroedFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<LinearAllocator*>(ctx)->try_allocate_zeroed(size, alignment);
+		};
 
-		return Allocator(&a, linearAllocFn, freeNoop);
+		return Allocator(&a, linearAllocFn, freeNoop, linearResizeFn, AllocatorCaps::NoopFree, linearZeroedFn);
 	}
 
 } // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <foundation/core/include/platform_types.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include "pages.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace opus3d::foundation::memory
+{
+	struct MappedFileOptions
+	{
+		MemoryAccessPattern pattern  = MemoryAccessPattern::Normal;
+		FilePrefault	    prefault = FilePrefault::None;
+
+		// Start reading the whole file in the background right after mapping it.
+		bool prefetch = false;
+	};
+
+	// Read-only view of a whole file.
+	//
+	// The bytes come straight from the OS page cache, there are no copies and no read
+	// calls, pages are faulted in on first touch unless prefaulted or prefetched. The
+	// file handle can be closed once the view exists. An empty file maps to an empty span.
+	class MappedFile
+	{
+	public:
+
+		MappedFile() = default;
+
+		[[nodiscard]] static Result<MappedFile> map(NativeFileHandle file, const MappedFileOptions& options = {}) noexcept;
+
+		MappedFile(const MappedFile&)		 = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		~MappedFile() noexcept { reset(); }
+
+		std::span<const std::byte> bytes() const noexcept { return {m_data, m_size}; }
+
+		const std::byte* data() const noexcept { return m_data; }
+		size_t		 size() const noexcept { return m_size; }
+		bool		 empty() const noexcept { return m_size == 0; }
+
+		// Both take byte ranges of the file, clamped to its size and widened to whole pages.
+		Result<void> advise(MemoryAccessPattern pattern, size_t offset = 0, size_t length = SIZE_MAX) noexcept;
+		Result<void> prefetch(size_t offset = 0, size_t length = SIZE_MAX) noexcept;
+
+		// Unmaps the view, the object is empty afterwards.
+		void reset() noexcept;
+
+	private:
+
+		const std::byte* m_data = nullptr;
+		size_t		 m_size = 0;
+	};
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
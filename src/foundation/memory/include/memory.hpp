@@ -4,8 +4,17 @@
 
 #include "alignment.hpp"
 #include "allocator.hpp"
+#include "concurrent_pool_allocator.hpp"
+#include "double_ended_stack_allocator.hpp"
 #include "heap_allocator.hpp"
 #include "linear_allocator.hpp"
+#include "mapped_file.hpp"
+#include "memory_budget.hpp"
 #include "memory_error.hpp"
+#include "numa.hpp"
 #include "pages.hpp"
+#include "pool_allocator.hpp"
+#include "scratch_arena.hpp"
+#include "tlsf_allocator.hpp"
+#include "tracking_allocator.hpp"
 #include "virtual_range.hpp"
\ No newline at end of file
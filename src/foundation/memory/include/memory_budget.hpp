@@ -0,0 +1,167 @@
+#pragma once
+
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+#include "memory_error.hpp"
+#include "tracking_allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation::memory
+{
+	inline constexpr uint64_t NoMemoryLimit = UINT64_MAX;
+
+	// How many pressure callbacks can be registered at once, over all tags.
+	inline constexpr size_t MaxMemoryPressureCallbacks = 32;
+
+	struct MemoryBudgetStats
+	{
+		uint64_t usedBytes	    = 0;
+		uint64_t peakBytes	    = 0; // Highest usedBytes since startup.
+		uint64_t lastFramePeakBytes = 0; // Highest usedBytes during the previous frame.
+		uint64_t softLimit	    = NoMemoryLimit;
+		uint64_t hardLimit	    = NoMemoryLimit;
+		uint64_t softCrossings	    = 0; // How often usedBytes rose above the soft limit.
+		uint64_t hardFailures	    = 0; // Charges refused at the hard limit.
+
+		bool	 over_soft_limit() const noexcept { return usedBytes > softLimit; }
+		uint64_t headroom() const noexcept { return usedBytes < hardLimit ? hardLimit - usedBytes : 0; }
+	};
+
+	// Asked to give memory of a tag back, e.g. by evicting cache entries or shrinking a
+	// VirtualRange. excessBytes is how far the tag is above its soft limit, including the
+	// charge that triggered the call. Runs on the allocating thread, allocations made from
+	// inside the callback are charged but never trigger callbacks themselves.
+	using MemoryPressureFn = void (*)(void* user, MemoryTag tag, uint64_t excessBytes) noexcept;
+
+	// Both limits are in bytes, softBytes must not be above hardBytes. Lowering a limit
+	// below the current usage does not fail anything that is already charged.
+	void set_memory_budget(MemoryTag tag, uint64_t softBytes, uint64_t hardBytes = NoMemoryLimit) noexcept;
+
+	// Relaxed counters, cheap enough to read every frame.
+	MemoryBudgetStats memory_budget_stats(MemoryTag tag) noexcept;
+
+	// Rolls the per-frame peaks and calls the pressure callbacks of every tag that is still
+	// above its soft limit. Call once per frame from one thread.
+	void memory_budget_begin_frame() noexcept;
+
+	// Charges bytes to a tag. At the hard limit the pressure callbacks of that tag run once
+	// and the charge is retried, if it still does not fit it fails with BudgetExceeded.
+	// For memory that does not come through a BudgetAllocator, e.g. committed pages.
+	[[nodiscard]] Result<void> charge_memory_budget(MemoryTag tag, size_t bytes) noexcept;
+	void			   release_memory_budget(MemoryTag tag, size_t bytes) noexcept;
+
+	// Returns a handle for unregister_memory_pressure_callback(). A callback may still be
+	// running on another thread when unregister returns.
+	[[nodiscard]] Result<uint32_t> register_memory_pressure_callback(MemoryTag tag, MemoryPressureFn fn, void* user) noexcept;
+	void			       unregister_memory_pressure_callback(uint32_t handle) noexcept;
+
+	// Forwards to an inner allocator and charges every block to the budget of a tag.
+	//
+	// Unlike TrackingAllocator it is meant for release builds: the cost is one atomic
+	// compare-exchange per allocation and one atomic add per free. Blocks are charged
+	// their requested size, not what the inner allocator rounds them up to.
+	class BudgetAllocator
+	{
+	public:
+
+		BudgetAllocator(Allocator inner, MemoryTag tag) noexcept : m_inner(inner), m_tag(tag) {}
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept
+		{
+			if(Result<void> charge = charge_memory_budget(m_tag, size); !charge.has_value())
+			{
+				return Unexpected(charge.error());
+			}
+
+			Result<void*> alloc = m_inner.try_allocate(size, alignment);
+			if(!alloc.has_value())
+			{
+				release_memory_budget(m_tag, size);
+			}
+			return alloc;
+		}
+
+		[[nodiscard]] Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept
+		{
+			if(Result<void> charge = charge_memory_budget(m_tag, size); !charge.has_value())
+			{
+				return Unexpected(charge.error());
+			}
+
+			Result<void*> alloc = m_inner.try_allocate_zeroed(size, alignment);
+			if(!alloc.has_value())
+			{
+				release_memory_budget(m_tag, size);
+			}
+			return alloc;
+		}
+
+		void deallocate(void* ptr, size_t size, size_t alignment) noexcept
+		{
+			if(ptr)
+			{
+				m_inner.deallocate(ptr, size, alignment);
+				release_memory_budget(m_tag, size);
+			}
+		}
+
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept
+		{
+			// Growth is charged up front so a resize can not step over the hard limit.
+			if(newSize > oldSize)
+			{
+				if(Result<void> charge = charge_memory_budget(m_tag, newSize - oldSize); !charge.has_value())
+				{
+					return Unexpected(charge.error());
+				}
+			}
+
+			Result<void*> resized = m_inner.try_resize(ptr, oldSize, newSize, alignment);
+
+			if(newSize > oldSize && !resized.has_value())
+			{
+				release_memory_budget(m_tag, newSize - oldSize);
+			}
+			else if(newSize < oldSize && resized.has_value())
+			{
+				release_memory_budget(m_tag, oldSize - newSize);
+			}
+			return resized;
+		}
+
+		MemoryTag tag() const noexcept { return m_tag; }
+
+		Allocator& inner() noexcept { return m_inner; }
+
+	private:
+
+		Allocator m_inner;
+		MemoryTag m_tag;
+	};
+
+	// Helper functions:
+
+	// Frees always reach the budget, so the view never reports no-op frees even if the
+	// inner allocator does.
+	inline Allocator as_allocator(BudgetAllocator& a) noexcept
+	{
+		static auto budgetAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<BudgetAllocator*>(ctx)->try_allocate(size, alignment);
+		};
+		static auto budgetFreeFn = [](void* ctx, void* ptr, size_t size, size_t alignment) noexcept {
+			static_cast<BudgetAllocator*>(ctx)->deallocate(ptr, size, alignment);
+		};
+		static auto budgetResizeFn = [](void* ctx, void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept {
+			return static_cast<BudgetAllocator*>(ctx)->try_resize(ptr, oldSize, newSize, alignment);
+		};
+		static auto budgetZeroedFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<BudgetAllocator*>(ctx)->try_allocate_zeroed(size, alignment);
+		};
+
+		return Allocator(&a, budgetAllocFn, budgetFreeFn, budgetResizeFn, AllocatorCaps::None, budgetZeroedFn);
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
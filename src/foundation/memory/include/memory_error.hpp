@@ -1,5 +1,6 @@
 #pragma once
 
+#include <foundation/core/include/error_code.hpp>
 #include <foundation/core/include/error_domain.hpp>
 
 #include <span>
@@ -11,6 +12,10 @@ namespace opus3d::foundation::memory
 		Unknown,
 		OutOfMemory,
 		AllocatorNoResize,
+		UnsupportedRequest,
+		ResizeNotInPlace,
+		PlatformUnsupported,
+		BudgetExceeded,
 	};
 } // namespace opus3d::foundation::memory
 
@@ -20,4 +25,10 @@ namespace opus3d::foundation::error_domains
 	size_t memory_error_formatter(uint32_t code, std::span<char> strBuffer);
 
 	inline constexpr ErrorDomain Memory = {"Memory", memory_error_formatter};
-} // namespace opus3d::foundation::error_domains
\ No newline at end of file
+} // namespace opus3d::foundation::error_domains
+
+namespace opus3d::foundation::memory
+{
+	// Wraps a MemoryErrorCode in an ErrorCode of the Memory domain.
+	ErrorCode create_memory_error(MemoryErrorCode errorCode) noexcept;
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <foundation/core/include/result.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation::memory
+{
+	inline constexpr uint32_t MaxNumaNodes = 64;
+	inline constexpr uint32_t MaxNumaCpus  = 1024;
+
+	enum class NumaPlacement : uint8_t
+	{
+		Default,    // Whatever the thread policy says, normally the node of the first touch.
+		PreferNode, // The given node while it has free memory, other nodes after that.
+		Interleave  // Round-robin over all nodes with memory, page by page.
+	};
+
+	struct NumaPolicy
+	{
+		NumaPlacement placement = NumaPlacement::Default;
+		uint32_t      node	= 0;
+
+		static constexpr NumaPolicy prefer(uint32_t node) noexcept { return NumaPolicy{.placement = NumaPlacement::PreferNode, .node = node}; }
+		static constexpr NumaPolicy interleave() noexcept { return NumaPolicy{.placement = NumaPlacement::Interleave}; }
+	};
+
+	struct NumaTopology
+	{
+		uint32_t nodeCount	= 1;
+		uint32_t cpuCount	= 0;
+		uint64_t memoryNodeMask = 1; // Nodes that have memory, CPU-only nodes can not be bound to.
+		uint8_t	 cpuToNode[MaxNumaCpus]{};
+
+		bool is_numa() const noexcept { return nodeCount > 1; }
+
+		uint32_t node_of_cpu(uint32_t cpu) const noexcept { return cpu < MaxNumaCpus ? cpuToNode[cpu] : 0; }
+
+		bool node_has_memory(uint32_t node) const noexcept { return node < MaxNumaNodes && (memoryNodeMask >> node) & 1; }
+	};
+
+	// Read once, on Linux from /sys/devices/system/node. Machines without NUMA, or where the
+	// topology can not be read, report a single node that owns every CPU.
+	const NumaTopology& numa_topology() noexcept;
+
+	// Node of the CPU the calling thread runs on right now, 0 without NUMA.
+	uint32_t current_numa_node() noexcept;
+
+	// Places the pages of a reserved range, must be applied before the pages are first
+	// touched. Succeeds without doing anything on a single node machine or for
+	// NumaPlacement::Default. Uses raw mbind, libnuma is not needed.
+	Result<void> apply_numa_policy(void* address, size_t size, const NumaPolicy& policy) noexcept;
+
+	// Default placement for everything the calling thread touches first from now on,
+	// e.g. to keep a worker's malloc and stack pages on its node. Uses raw set_mempolicy.
+	Result<void> set_thread_numa_policy(const NumaPolicy& policy) noexcept;
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <optional>
 
+#include <foundation/core/include/platform_types.hpp>
 #include <foundation/core/include/result.hpp>
 
 namespace opus3d::foundation::memory
@@ -30,35 +32,112 @@ namespace opus3d::foundation::memory
 
 	constexpr bool has_flag(MemoryAccess value, MemoryAccess flag) noexcept { return (static_cast<uint32_t>(value) & static_cast<uint32_t>(flag)) != 0; }
 
+	// How a range is going to be read, lets the OS tune read-ahead and reclaim.
+	enum class MemoryAccessPattern : uint8_t
+	{
+		Normal,
+		Sequential, // Aggressive read-ahead, pages behind the reader can be dropped early.
+		Random	    // No read-ahead.
+	};
+
+	enum class FilePrefault : uint8_t
+	{
+		None,	 // Pages are read in on first touch.
+		Populate // The whole file is read in and mapped before map_file returns.
+	};
+
 	enum class MemoryPageSize
 	{
 		Normal, // Default OS page size
-		Large	// @note On Linux, large page requests are best-effort and use madvise(MADV_HUGEPAGE).
+		Large	// Explicit huge pages when available, transparent huge pages otherwise.
+	};
+
+	// What actually backs a reservation.
+	enum class PageBacking : uint8_t
+	{
+		Normal,
+		TransparentHuge, // Linux THP: huge page aligned and advised, the kernel decides per fault.
+		HugeTlb		 // Explicit huge pages from a preallocated pool (hugetlbfs).
+	};
+
+	enum class TransparentHugePageMode : uint8_t
+	{
+		Unsupported,
+		Never,
+		Madvise, // Only regions advised with MADV_HUGEPAGE.
+		Always
+	};
+
+	struct HugePagePool
+	{
+		size_t pageSize	 = 0;
+		size_t freePages = 0;
+	};
+
+	struct LargePageInfo
+	{
+		TransparentHugePageMode transparentMode	    = TransparentHugePageMode::Unsupported;
+		size_t			transparentPageSize = 0;
+
+		// Explicit huge page pools, smallest page size first.
+		HugePagePool pools[4]{};
+		uint32_t     poolCount = 0;
 	};
 
 	size_t get_system_page_size() noexcept;
 
+	// The huge page size Large reservations align to, nullopt when neither transparent
+	// nor explicit huge pages are available.
 	Result<std::optional<size_t>> get_system_large_page_size() noexcept;
 
+	// Reads the current huge page configuration, on Linux from /sys/kernel/mm. Not cached,
+	// free page counts change as other processes use the pools.
+	LargePageInfo query_large_page_info() noexcept;
+
 	Result<void*> reserve_pages(size_t size, MemoryPageSize pageSize = MemoryPageSize::Normal) noexcept;
 
+	// Same as above and reports the backing that was obtained. Large reservations only try
+	// explicit huge pages when size is a multiple of get_system_large_page_size(), and then
+	// have to be committed and decommitted in multiples of it too.
+	Result<void*> reserve_pages(size_t size, MemoryPageSize pageSize, PageBacking& obtained) noexcept;
+
 	Result<void> commit_pages(void* address, size_t size, MemoryAccess access) noexcept;
 
 	Result<void> decommit_pages(void* address, size_t size) noexcept;
 
+	// Drops the contents of committed pages and hands their physical memory back, the
+	// range stays accessible and reads back as zero (Linux) or undefined (Windows).
+	Result<void> discard_pages(void* address, size_t size) noexcept;
+
 	Result<void*> allocate_pages(size_t size, MemoryAccess access) noexcept;
 
 	Result<void> release_pages(void* address, size_t size) noexcept;
 
+	// Resizes a block returned by allocate_pages, keeping its contents. The block may move
+	// to a new address, pages are remapped rather than copied. Linux only, elsewhere this
+	// fails with MemoryErrorCode::PlatformUnsupported.
+	Result<void*> remap_pages(void* address, size_t oldSize, size_t newSize) noexcept;
+
 	Result<void> set_committed_page_access(void* address, size_t size, MemoryAccess access) noexcept;
 
 	Result<void> set_committed_page_noaccess(void* address, size_t size, GuardMode mode = GuardMode::None) noexcept;
 
-	Result<void*> map_file(NativeFileHandle openFileHandle, size_t fileSize, MemoryAccess access) noexcept;
+	// Access pattern hint for committed or file mapped pages, a no-op where unsupported.
+	// Like the other page functions address has to be page aligned.
+	Result<void> advise_pages(void* address, size_t size, MemoryAccessPattern pattern) noexcept;
+
+	// Starts reading the pages of a file mapping in the background, returns without waiting.
+	Result<void> prefetch_pages(void* address, size_t size) noexcept;
+
+	Result<size_t> get_file_size(NativeFileHandle openFileHandle) noexcept;
+
+	// Maps the first fileSize bytes of the file. Write access maps copy-on-write, changes
+	// never reach the file.
+	Result<void*> map_file(NativeFileHandle openFileHandle, size_t fileSize, MemoryAccess access, FilePrefault prefault = FilePrefault::None) noexcept;
 
 	Result<void> unmap_file(void* address, size_t size) noexcept;
 
 	inline Result<void> make_guard_pages(void* address, size_t size) noexcept { return set_committed_page_noaccess(address, size, GuardMode::Guard); }
 	inline Result<void> make_noaccess_pages(void* address, size_t size) noexcept { return set_committed_page_noaccess(address, size, GuardMode::None); }
 
-} // namespace opus3d::foundation
\ No newline at end of file
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+#include "memory_error.hpp"
+#include "virtual_range.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation::memory
+{
+	struct PoolAllocatorStats
+	{
+		size_t blockSize      = 0; // Bytes handed out per block, after padding.
+		size_t liveBlocks     = 0; // Blocks currently allocated.
+		size_t peakLiveBlocks = 0; // Highest liveBlocks since creation or release_all().
+		size_t carvedBlocks   = 0; // Blocks ever carved out of the committed slabs.
+		size_t maxBlocks      = 0; // Blocks that fit in the reservation.
+		size_t committedBytes = 0;
+	};
+
+	// Fixed-size block pool over a reserved VirtualRange.
+	//
+	// The range is committed one slab at a time. Blocks are carved out of the committed
+	// slabs with a bump pointer and recycled through an intrusive free list, so both
+	// allocate and deallocate are O(1) and never touch the OS in steady state.
+	//
+	// Not thread-safe.
+	class PoolAllocator
+	{
+	public:
+
+		// Pages are committed in slabs of at least this size.
+		static constexpr size_t SlabSize = 64 * 1024;
+
+		[[nodiscard]] static Result<PoolAllocator> create(size_t blockSize, size_t blockAlignment, size_t maxBlocks, NumaPolicy numa = {}) noexcept;
+
+		PoolAllocator(const PoolAllocator&)	       = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		PoolAllocator(PoolAllocator&& other) noexcept;
+		PoolAllocator& operator=(PoolAllocator&& other) noexcept;
+
+		[[nodiscard]] Result<void*> try_allocate() noexcept
+		{
+			if(FreeBlock* block = m_freeList; block)
+			{
+				m_freeList = block->next;
+				return on_allocated(block);
+			}
+
+			if(m_carved + m_stride <= m_range.size())
+			{
+				std::byte* block = m_range.data() + m_carved;
+				m_carved += m_stride;
+				return on_allocated(block);
+			}
+
+			return try_allocate_slab();
+		}
+
+		[[nodiscard]] void* allocate() noexcept
+		{
+			Result<void*> alloc = try_allocate();
+			ASSERT_MSG(alloc.has_value(), "PoolAllocator out of memory!");
+			return alloc.value();
+		}
+
+		// Allocator-compatible overload, fails if the request does not fit a block.
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept
+		{
+			if(size > m_stride || alignment > m_alignment)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::UnsupportedRequest));
+			}
+			return try_allocate();
+		}
+
+		void deallocate(void* ptr) noexcept
+		{
+			if(!ptr)
+			{
+				return;
+			}
+
+			DEBUG_ASSERT_MSG(owns(ptr), "Pointer does not belong to this PoolAllocator!");
+			DEBUG_ASSERT_MSG((static_cast<std::byte*>(ptr) - m_range.data()) % m_stride == 0, "Pointer is not the start of a block!");
+
+			FreeBlock* block = static_cast<FreeBlock*>(ptr);
+			block->next	 = m_freeList;
+			m_freeList	 = block;
+			--m_liveBlocks;
+		}
+
+		void deallocate(void* ptr, size_t, size_t) noexcept { deallocate(ptr); }
+
+		// Returns every block to the pool at once, O(1).
+		// If decommit is set the slabs are handed back to the OS as well.
+		void release_all(bool decommit = false) noexcept;
+
+		bool owns(const void* ptr) const noexcept
+		{
+			const std::byte* p = static_cast<const std::byte*>(ptr);
+			return p >= m_range.data() && p < m_range.data() + m_carved;
+		}
+
+		size_t block_size() const noexcept { return m_stride; }
+		size_t block_alignment() const noexcept { return m_alignment; }
+		size_t live_blocks() const noexcept { return m_liveBlocks; }
+		size_t max_blocks() const noexcept { return m_range.capacity() / m_stride; }
+
+		PoolAllocatorStats stats() const noexcept;
+
+	private:
+
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		PoolAllocator() = default;
+
+		void* on_allocated(void* block) noexcept
+		{
+			m_peakLiveBlocks = std::max(m_peakLiveBlocks, ++m_liveBlocks);
+			return block;
+		}
+
+		// Slow path: commits the next slab and carves a block from it.
+		Result<void*> try_allocate_slab() noexcept;
+
+	private:
+
+		VirtualRange m_range;
+		FreeBlock*   m_freeList	      = nullptr;
+		size_t	     m_carved	      = 0; // Bytes of the committed range carved into blocks.
+		size_t	     m_stride	      = 0;
+		size_t	     m_alignment      = 0;
+		size_t	     m_liveBlocks     = 0;
+		size_t	     m_peakLiveBlocks = 0;
+	};
+
+	// Helper functions:
+
+	inline Allocator as_allocator(PoolAllocator& a) noexcept
+	{
+		static auto deallocFn = [](void* ctx, void* ptr, size_t, size_t) noexcept { static_cast<PoolAllocator*>(ctx)->deallocate(ptr); };
+		static auto poolAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<PoolAllocator*>(ctx)->try_allocate(size, alignment);
+		};
+
+		return Allocator(&a, poolAllocFn, deallocFn);
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+#include "linear_allocator.hpp"
+
+#include <cstddef>
+
+namespace opus3d::foundation::memory
+{
+	// Per-thread scratch memory for short-lived temporaries.
+	//
+	// Every thread owns two lazily reserved linear arenas. Memory is taken through a
+	// ScratchScope, which records the arena marker on construction and rewinds to it on
+	// destruction, so scopes nest naturally:
+	//
+	//	ScratchScope scratch;
+	//	float* tmp = scratch.allocate_array<float>(count);
+	//	... // tmp is released when scratch goes out of scope.
+	//
+	// Two arenas exist so that a function which receives an arena from its caller can take
+	// scratch memory without trampling the caller's allocations: pass the caller's arena as
+	// the conflict and the scope picks the other one.
+	//
+	// Fibers: a scope keeps using the arena it was opened on, also after the fiber migrates
+	// to another thread, where that arena belongs to someone else. A fiber that may yield while
+	// holding a scope must therefore not share the thread's arenas. Give it its own
+	// ScratchArenaSet and have the scheduler bind it with bind_thread_scratch_arenas() around
+	// every resume. In debug builds a scope taken from the thread arenas asserts that it
+	// closes on a thread they are still bound to.
+
+	inline constexpr size_t ScratchArenaReserveSize = 64 * 1024 * 1024;
+
+	// Commit above this is returned to the OS when a scope rewinds below it.
+	inline constexpr size_t ScratchArenaRetainedCommit = 1024 * 1024;
+
+	struct ScratchArenaSet
+	{
+		LinearAllocator* arenas[2] = {nullptr, nullptr};
+	};
+
+	// Returns a scratch arena of the calling thread that is not conflict.
+	// Reserves the thread's arenas on first use, panics if that fails.
+	LinearAllocator& thread_scratch_arena(const LinearAllocator* conflict = nullptr) noexcept;
+
+	// Redirects the calling thread's scratch arenas, returns the previous binding.
+	// Binding an empty set restores the thread's own arenas.
+	ScratchArenaSet bind_thread_scratch_arenas(ScratchArenaSet arenas) noexcept;
+
+	// True if arena is one of the calling thread's current scratch arenas. Never reserves
+	// the thread's arenas.
+	bool is_thread_scratch_arena(const LinearAllocator* arena) noexcept;
+
+	class ScratchScope
+	{
+	public:
+
+		explicit ScratchScope(const LinearAllocator* conflict = nullptr) noexcept : ScratchScope(thread_scratch_arena(conflict))
+		{
+			m_threadArena = true;
+		}
+
+		explicit ScratchScope(LinearAllocator& arena) noexcept : m_arena(&arena), m_marker(arena.marker()) {}
+
+		~ScratchScope() noexcept
+		{
+			// A fiber that moved threads would rewind an arena another thread is using.
+			DEBUG_ASSERT_MSG(!m_threadArena || is_thread_scratch_arena(m_arena), "ScratchScope closed on a thread that does not own its arena!");
+
+			// Asserts if an inner scope outlived this one.
+			m_arena->reset_to(m_marker);
+		}
+
+		ScratchScope(const ScratchScope&)	     = delete;
+		ScratchScope& operator=(const ScratchScope&) = delete;
+
+		[[nodiscard]] void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept { return m_arena->allocate(size, alignment); }
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept { return m_arena->try_allocate(size, alignment); }
+
+		// Uninitialized storage for count objects of T.
+		template <typename T>
+		[[nodiscard]] T* allocate_array(size_t count) noexcept
+		{
+			return static_cast<T*>(m_arena->allocate(sizeof(T) * count, alignof(T)));
+		}
+
+		// Allocator view, frees are no-ops and everything is released with the scope.
+		Allocator allocator() noexcept { return as_allocator(*m_arena); }
+
+		LinearAllocator& arena() noexcept { return *m_arena; }
+
+		size_t marker() const noexcept { return m_marker; }
+
+	private:
+
+		LinearAllocator* m_arena;
+		size_t		 m_marker;
+		bool		 m_threadArena = false;
+	};
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <foundation/core/include/assert.hpp>
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+#include "virtual_range.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace opus3d::foundation::memory
+{
+	struct TlsfStats
+	{
+		size_t usedBytes	= 0; // Payload bytes of live blocks, including rounding.
+		size_t freeBytes	= 0; // Payload bytes of free blocks.
+		size_t freeBlockCount	= 0;
+		size_t largestFreeBlock = 0;
+		size_t liveBlockCount	= 0;
+		size_t committedBytes	= 0;
+		size_t capacity		= 0;
+
+		// 0 when all free memory is one block, approaching 1 as it splinters.
+		double fragmentation() const noexcept
+		{
+			return freeBytes == 0 ? 0.0 : 1.0 - double(largestFreeBlock) / double(freeBytes);
+		}
+	};
+
+	// Two-Level Segregated Fit heap over a reserved VirtualRange.
+	//
+	// Free blocks are binned by a first level (power of two) and a second level (linear
+	// subdivision of that power), two bitmaps locate a fitting bin with a couple of bit
+	// scans. Allocate and free are O(1) with a small constant, there are no searches whose
+	// length depends on the heap state, which keeps worst case frame times predictable.
+	//
+	// Physically adjacent free blocks are always merged, which is what lets try_resize
+	// grow a block in place by absorbing its free neighbour. Pages are committed at the
+	// end of the range as the heap grows.
+	//
+	// Not thread-safe.
+	class TlsfAllocator
+	{
+	public:
+
+		// Every payload is aligned to at least this.
+		static constexpr size_t MinAlignment = 16;
+
+		// Pages are committed in chunks of at least this size.
+		static constexpr size_t CommitChunkSize = 256 * 1024;
+
+		[[nodiscard]] static Result<TlsfAllocator> create(size_t reservedBytes) noexcept;
+
+		TlsfAllocator(const TlsfAllocator&)	       = delete;
+		TlsfAllocator& operator=(const TlsfAllocator&) = delete;
+
+		TlsfAllocator(TlsfAllocator&& other) noexcept;
+		TlsfAllocator& operator=(TlsfAllocator&& other) noexcept;
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept;
+
+		[[nodiscard]] void* allocate(size_t size, size_t alignment = MinAlignment) noexcept
+		{
+			Result<void*> alloc = try_allocate(size, alignment);
+			ASSERT_MSG(alloc.has_value(), "TlsfAllocator out of memory!");
+			return alloc.value();
+		}
+
+		void deallocate(void* ptr) noexcept;
+
+		void deallocate(void* ptr, size_t, size_t) noexcept { deallocate(ptr); }
+
+		// Grows or shrinks the block without moving it. Fails with ResizeNotInPlace when
+		// the block that follows is not free or not large enough, the block is unchanged.
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept;
+
+		// Usable bytes of a live block, at least what was requested.
+		size_t usable_size(const void* ptr) const noexcept;
+
+		// Walks the largest non-empty bin, cheap enough to call every frame.
+		TlsfStats stats() const noexcept;
+
+	private:
+
+		static constexpr uint32_t SlIndexCountLog2 = 5;
+		static constexpr uint32_t SlIndexCount	   = 1u << SlIndexCountLog2;
+		static constexpr uint32_t FlIndexShift	   = SlIndexCountLog2 + 4; // log2(MinAlignment)
+		static constexpr uint32_t FlIndexMax	   = 40;		   // Blocks up to 1 TB.
+		static constexpr uint32_t FlIndexCount	   = FlIndexMax - FlIndexShift + 1;
+		static constexpr size_t	  SmallBlockSize   = size_t(1) << FlIndexShift;
+
+		struct BlockHeader;
+
+		TlsfAllocator() = default;
+
+		static void mapping_insert(size_t size, uint32_t& fl, uint32_t& sl) noexcept;
+
+		// Rounds up to the next bin boundary, every block in the bin of the result fits size.
+		static size_t round_up_to_bin(size_t size) noexcept;
+
+		void insert_free_block(BlockHeader* block) noexcept;
+		void remove_free_block(BlockHeader* block) noexcept;
+
+		BlockHeader* find_free_block(size_t size) noexcept;
+		BlockHeader* merge_with_neighbours(BlockHeader* block) noexcept;
+
+		// Cuts the tail of a live block beyond size back into the free lists.
+		void trim_live_block(BlockHeader* block, size_t size) noexcept;
+
+		// Commits at least minBytes more and appends them as a free block.
+		[[nodiscard]] Result<void> grow_heap(size_t minBytes) noexcept;
+
+	private:
+
+		VirtualRange m_range;
+		BlockHeader* m_sentinel = nullptr; // Zero sized live block at the end of the committed pages.
+
+		uint32_t     m_flBitmap = 0;
+		uint32_t     m_slBitmap[FlIndexCount]		     = {};
+		BlockHeader* m_freeLists[FlIndexCount][SlIndexCount] = {};
+
+		size_t m_usedBytes	= 0;
+		size_t m_freeBytes	= 0;
+		size_t m_freeBlockCount = 0;
+		size_t m_liveBlockCount = 0;
+	};
+
+	// Helper functions:
+
+	inline Allocator as_allocator(TlsfAllocator& a) noexcept
+	{
+		static auto deallocFn = [](void* ctx, void* ptr, size_t, size_t) noexcept { static_cast<TlsfAllocator*>(ctx)->deallocate(ptr); };
+		static auto tlsfAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<TlsfAllocator*>(ctx)->try_allocate(size, alignment);
+		};
+		static auto resizeFn = [](void* ctx, void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept {
+			return static_cast<TlsfAllocator*>(ctx)->try_resize(ptr, oldSize, newSize, alignment);
+		};
+
+		return Allocator(&a, tlsfAllocFn, deallocFn, resizeFn);
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
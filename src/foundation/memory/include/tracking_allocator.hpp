@@ -0,0 +1,212 @@
+#pragma once
+
+#include <foundation/core/include/result.hpp>
+
+#include "allocator.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Tagged allocation tracking. On by default in debug builds, define
+// FOUNDATION_MEMORY_TRACKING to 0 or 1 to override. When it is off the tracking
+// wrapper forwards straight to the inner allocator and every query is an empty inline.
+#ifndef FOUNDATION_MEMORY_TRACKING
+#if !defined(NDEBUG)
+#define FOUNDATION_MEMORY_TRACKING 1
+#else
+#define FOUNDATION_MEMORY_TRACKING 0
+#endif
+#endif
+
+namespace opus3d::foundation::memory
+{
+	// Subsystem an allocation is charged to.
+	enum class MemoryTag : uint8_t
+	{
+		General,
+		Containers,
+		Window,
+		Tasks,
+		Fibers,
+		Filesystem,
+		Engine,
+
+		// Free for the application, name them with set_memory_tag_name().
+		User0,
+		User1,
+		User2,
+		User3,
+		User4,
+		User5,
+		User6,
+		User7,
+
+		Count
+	};
+
+	inline constexpr size_t MemoryTagCount = static_cast<size_t>(MemoryTag::Count);
+
+	// Bucket i counts allocations of (16 << (i - 1), 16 << i] bytes, bucket 0 everything
+	// up to 16 bytes and the last bucket everything above.
+	inline constexpr size_t MemorySizeBucketCount = 16;
+
+	struct MemoryTagStats
+	{
+		uint64_t liveBytes	      = 0;
+		uint64_t peakBytes	      = 0; // Highest liveBytes since startup.
+		uint64_t liveAllocations      = 0;
+		uint64_t totalAllocations     = 0;
+		uint64_t frameAllocations     = 0; // Since the last memory_tracking_begin_frame().
+		uint64_t lastFrameAllocations = 0; // During the previous frame.
+		uint64_t sizeHistogram[MemorySizeBucketCount]{};
+	};
+
+	struct MemoryLeak
+	{
+		const void* address = nullptr;
+		size_t	    size    = 0;
+		MemoryTag   tag	    = MemoryTag::General;
+	};
+
+	using MemoryLeakFn = void (*)(void* user, const MemoryLeak& leak) noexcept;
+
+	constexpr size_t memory_size_bucket(size_t size) noexcept
+	{
+		size_t bucket = 0;
+		for(size_t limit = 16; size > limit && bucket + 1 < MemorySizeBucketCount; limit <<= 1)
+		{
+			++bucket;
+		}
+		return bucket;
+	}
+
+	const char* memory_tag_name(MemoryTag tag) noexcept;
+
+	// Only user tags can be renamed, the name must outlive the process.
+	void set_memory_tag_name(MemoryTag tag, const char* name) noexcept;
+
+#if FOUNDATION_MEMORY_TRACKING
+
+	namespace detail
+	{
+		void track_allocate(MemoryTag tag, void* ptr, size_t size) noexcept;
+		void track_deallocate(MemoryTag tag, void* ptr, size_t size) noexcept;
+		void track_resize(MemoryTag tag, void* oldPtr, void* newPtr, size_t oldSize, size_t newSize) noexcept;
+	} // namespace detail
+
+	// Counters are relaxed atomics, a snapshot taken while other threads allocate is
+	// not guaranteed to be consistent across fields.
+	MemoryTagStats memory_tag_stats(MemoryTag tag) noexcept;
+
+	// Rolls the per-frame allocation counters, call once per frame from one thread.
+	void memory_tracking_begin_frame() noexcept;
+
+	// Calls fn for every tracked allocation that is still live, returns how many there were.
+	// fn runs under a registry lock and must not allocate through a TrackingAllocator.
+	size_t for_each_memory_leak(MemoryLeakFn fn, void* user) noexcept;
+
+	// Per-tag table followed by the leak list, meant to be called at shutdown.
+	void write_memory_report(std::FILE* out) noexcept;
+
+#else
+
+	inline MemoryTagStats memory_tag_stats(MemoryTag) noexcept { return {}; }
+	inline void	      memory_tracking_begin_frame() noexcept {}
+	inline size_t	      for_each_memory_leak(MemoryLeakFn, void*) noexcept { return 0; }
+	inline void	      write_memory_report(std::FILE*) noexcept {}
+
+#endif
+
+	// Forwards to an inner allocator and charges every block to a tag.
+	//
+	// Per-tag counters are lock-free. Live blocks are additionally kept in a sharded
+	// registry so leaks can be listed at shutdown, which costs a short spin lock per
+	// allocation and deallocation. Without FOUNDATION_MEMORY_TRACKING as_allocator()
+	// hands out the inner allocator itself, so the wrapper costs nothing.
+	class TrackingAllocator
+	{
+	public:
+
+		TrackingAllocator(Allocator inner, MemoryTag tag) noexcept : m_inner(inner), m_tag(tag) {}
+
+		[[nodiscard]] Result<void*> try_allocate(size_t size, size_t alignment) noexcept
+		{
+			Result<void*> alloc = m_inner.try_allocate(size, alignment);
+#if FOUNDATION_MEMORY_TRACKING
+			if(alloc.has_value())
+			{
+				detail::track_allocate(m_tag, alloc.value(), size);
+			}
+#endif
+			return alloc;
+		}
+
+		[[nodiscard]] Result<void*> try_allocate_zeroed(size_t size, size_t alignment) noexcept
+		{
+			Result<void*> alloc = m_inner.try_allocate_zeroed(size, alignment);
+#if FOUNDATION_MEMORY_TRACKING
+			if(alloc.has_value())
+			{
+				detail::track_allocate(m_tag, alloc.value(), size);
+			}
+#endif
+			return alloc;
+		}
+
+		void deallocate(void* ptr, size_t size, size_t alignment) noexcept
+		{
+#if FOUNDATION_MEMORY_TRACKING
+			detail::track_deallocate(m_tag, ptr, size);
+#endif
+			m_inner.deallocate(ptr, size, alignment);
+		}
+
+		[[nodiscard]] Result<void*> try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept
+		{
+			Result<void*> resized = m_inner.try_resize(ptr, oldSize, newSize, alignment);
+#if FOUNDATION_MEMORY_TRACKING
+			if(resized.has_value())
+			{
+				detail::track_resize(m_tag, ptr, resized.value(), oldSize, newSize);
+			}
+#endif
+			return resized;
+		}
+
+		MemoryTag tag() const noexcept { return m_tag; }
+
+		Allocator& inner() noexcept { return m_inner; }
+
+	private:
+
+		Allocator m_inner;
+		MemoryTag m_tag;
+	};
+
+	// Helper functions:
+
+	inline Allocator as_allocator(TrackingAllocator& a) noexcept
+	{
+#if FOUNDATION_MEMORY_TRACKING
+		static auto trackingAllocFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<TrackingAllocator*>(ctx)->try_allocate(size, alignment);
+		};
+		static auto trackingFreeFn = [](void* ctx, void* ptr, size_t size, size_t alignment) noexcept {
+			static_cast<TrackingAllocator*>(ctx)->deallocate(ptr, size, alignment);
+		};
+		static auto trackingResizeFn = [](void* ctx, void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept {
+			return static_cast<TrackingAllocator*>(ctx)->try_resize(ptr, oldSize, newSize, alignment);
+		};
+
+		static auto trackingZeroedFn = [](void* ctx, size_t size, size_t alignment) noexcept {
+			return static_cast<TrackingAllocator*>(ctx)->try_allocate_zeroed(size, alignment);
+		};
+
+		return Allocator(&a, trackingAllocFn, trackingFreeFn, trackingResizeFn, AllocatorCaps::None, trackingZeroedFn);
+#else
+		return a.inner();
+#endif
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
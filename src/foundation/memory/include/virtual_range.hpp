@@ -2,10 +2,38 @@
 
 #include <foundation/core/include/result.hpp>
 
+#include "numa.hpp"
+#include "pages.hpp"
+
 #include <memory>
 
 namespace opus3d::foundation::memory
 {
+	// How eagerly a range commits and decommits. The default commits and decommits exactly
+	// the pages the logical size needs, so a range that oscillates around a page boundary
+	// makes a syscall every time it crosses it.
+	struct CommitPolicy
+	{
+		// Commits are at least this large, rounded up to the commit granularity.
+		size_t minCommitChunk = 0;
+
+		// Geometric commit-ahead, a commit also grows the committed size by this percentage
+		// of itself. 100 doubles it.
+		uint32_t growthPercent = 0;
+
+		// Committed bytes above the logical size that survive a shrink.
+		size_t decommitSlack = 0;
+	};
+
+	struct CommitStats
+	{
+		uint64_t commits	    = 0;
+		uint64_t decommits	    = 0;
+		uint64_t committedBytes	    = 0;
+		uint64_t decommittedBytes   = 0;
+		uint64_t syscallNanoseconds = 0; // Wall time spent in commit, decommit and protect calls.
+	};
+
 	/**
     	 * @brief Ownership of a contiguous virtual address range with a moving "usable" boundary.
     	 * * If hasGuardPage is true, an extra page is silently reserved to act as a 
@@ -28,7 +56,10 @@ namespace opus3d::foundation::memory
 
 		// Factory method, creates a virtual range with at least maxSize usable space.
 		// Due to memory pages requiring alignment the actual capacity might be larger.
-		[[nodiscard]] static Result<VirtualRange> reserve(size_t maxSize) noexcept;
+		// Large rounds the capacity up to the huge page size and commits in huge pages,
+		// page_backing() tells what the OS actually provided. NUMA placement is best-effort,
+		// the range is usable even when the policy could not be applied.
+		[[nodiscard]] static Result<VirtualRange> reserve(size_t maxSize, MemoryPageSize pageSize = MemoryPageSize::Normal, NumaPolicy numa = {}) noexcept;
 
 		// Shrink by deltaSize bytes
 		// Note: does _not_ do bounds checking.
@@ -51,16 +82,33 @@ namespace opus3d::foundation::memory
 
 		const std::byte* data() const noexcept { return m_base; }
 
+		PageBacking page_backing() const noexcept { return m_backing; }
+
+		// Commits and decommits happen in multiples of this.
+		size_t commit_granularity() const noexcept { return m_commitGranularity; }
+
+		// Committed bytes, at least size(), more when the policy commits ahead or keeps slack.
+		size_t committed_size() const noexcept { return m_committedSize; }
+
+		void		    set_commit_policy(const CommitPolicy& policy) noexcept { m_policy = policy; }
+		const CommitPolicy& commit_policy() const noexcept { return m_policy; }
+
+		const CommitStats& commit_stats() const noexcept { return m_stats; }
+
 	private:
 
 		void reset() noexcept;
 
 	private:
 
-		std::byte* m_base	   = nullptr;
-		size_t	   m_committedSize = 0;
-		size_t	   m_reservedSize  = 0;
-		size_t	   m_logicalSize   = 0;
+		std::byte*   m_base		 = nullptr;
+		size_t	     m_committedSize	 = 0;
+		size_t	     m_reservedSize	 = 0;
+		size_t	     m_logicalSize	 = 0;
+		size_t	     m_commitGranularity = 0;
+		PageBacking  m_backing		 = PageBacking::Normal;
+		CommitPolicy m_policy;
+		CommitStats  m_stats;
 	};
 
 	// Virutal Range + Guard Page
@@ -92,16 +140,25 @@ namespace opus3d::foundation::memory
 
 		const std::byte* data() const noexcept { return m_base; }
 
+		// The guard page sits at the end of the committed pages, so with commit-ahead or
+		// slack an overrun of size() is only caught once it leaves committed_size().
+		void		    set_commit_policy(const CommitPolicy& policy) noexcept { m_policy = policy; }
+		const CommitPolicy& commit_policy() const noexcept { return m_policy; }
+
+		const CommitStats& commit_stats() const noexcept { return m_stats; }
+
 	private:
 
 		void reset() noexcept;
 
 	private:
 
-		std::byte* m_base		= nullptr;
-		size_t	   m_usableReservedSize = 0; // excludes guard page
-		size_t	   m_rwCommittedSize	= 0; // page-aligned RW committed bytes
-		size_t	   m_logicalSize	= 0; // byte-granular
+		std::byte*   m_base		  = nullptr;
+		size_t	     m_usableReservedSize = 0; // excludes guard page
+		size_t	     m_rwCommittedSize	  = 0; // page-aligned RW committed bytes
+		size_t	     m_logicalSize	  = 0; // byte-granular
+		CommitPolicy m_policy;
+		CommitStats  m_stats;
 	};
 
 } // namespace opus3d::foundation::memory
\ No newline at end of file
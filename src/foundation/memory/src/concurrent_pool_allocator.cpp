@@ -0,0 +1,322 @@
+#include <foundation/memory/include/concurrent_pool_allocator.hpp>
+
+#include <foundation/memory/include/alignment.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include "thread_slots.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <new>
+#include <utility>
+
+namespace opus3d::foundation::memory
+{
+	namespace
+	{
+		using detail::current_thread_slot;
+
+		static_assert(ConcurrentPoolAllocator::MaxThreadSlots == detail::MaxThreadSlots);
+
+		constexpr uint64_t make_tagged(uint64_t tag, uint32_t index) noexcept { return (tag << 32) | index; }
+		constexpr uint32_t tagged_index(uint64_t tagged) noexcept { return static_cast<uint32_t>(tagged); }
+		constexpr uint64_t tagged_tag(uint64_t tagged) noexcept { return tagged >> 32; }
+	} // namespace
+
+	Result<ConcurrentPoolAllocator> ConcurrentPoolAllocator::create(size_t blockSize, size_t blockAlignment, size_t maxBlocks) noexcept
+	{
+		ASSERT_MSG(blockSize > 0 && maxBlocks > 0, "ConcurrentPoolAllocator needs a block size and a block count");
+		ASSERT_MSG(maxBlocks < NullIndex, "ConcurrentPoolAllocator addresses blocks with 32-bit indices");
+		ASSERT_MSG(std::has_single_bit(blockAlignment), "ConcurrentPoolAllocator alignment must be a power of two");
+
+		const size_t pageSize = get_system_page_size();
+		ASSERT_MSG(blockAlignment <= pageSize, "ConcurrentPoolAllocator alignment can not exceed the page size");
+
+		const size_t alignment	= std::max(blockAlignment, alignof(FreeBlock));
+		const size_t stride	= align_up(std::max(blockSize, sizeof(FreeBlock)), alignment);
+		const size_t cacheBytes = align_up(sizeof(ThreadCache) * (MaxThreadSlots + 1), pageSize);
+
+		Result<VirtualRange> range = VirtualRange::reserve(cacheBytes + stride * maxBlocks);
+		if(!range.has_value())
+		{
+			return Unexpected(range.error());
+		}
+
+		if(Result<void> grow = range.value().grow(cacheBytes); !grow.has_value())
+		{
+			return Unexpected(grow.error());
+		}
+
+		ConcurrentPoolAllocator pool;
+		pool.m_range	 = std::move(range.value());
+		pool.m_caches	 = reinterpret_cast<ThreadCache*>(pool.m_range.data());
+		pool.m_blocks	 = pool.m_range.data() + cacheBytes;
+		pool.m_stride	 = stride;
+		pool.m_alignment = alignment;
+		pool.m_maxBlocks = (pool.m_range.capacity() - cacheBytes) / stride;
+
+		// The extra slot only holds the counters of threads that did not get a cache.
+		for(uint32_t i = 0; i <= MaxThreadSlots; ++i)
+		{
+			new(&pool.m_caches[i]) ThreadCache();
+		}
+
+		return pool;
+	}
+
+	ConcurrentPoolAllocator::ConcurrentPoolAllocator(ConcurrentPoolAllocator&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	ConcurrentPoolAllocator& ConcurrentPoolAllocator::operator=(ConcurrentPoolAllocator&& other) noexcept
+	{
+		if(this != &other)
+		{
+			// The caches live inside the range and move along with it.
+			m_range	    = std::move(other.m_range);
+			m_caches    = std::exchange(other.m_caches, nullptr);
+			m_blocks    = std::exchange(other.m_blocks, nullptr);
+			m_stride    = other.m_stride;
+			m_alignment = other.m_alignment;
+			m_maxBlocks = std::exchange(other.m_maxBlocks, 0);
+
+			m_globalHead.store(other.m_globalHead.exchange(NullIndex, std::memory_order_relaxed), std::memory_order_relaxed);
+			m_carved.store(other.m_carved.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+			m_committed.store(other.m_committed.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+		return *this;
+	}
+
+	Result<void*> ConcurrentPoolAllocator::try_allocate() noexcept
+	{
+		ASSERT_MSG(m_caches, "Allocating from an uninitialized ConcurrentPoolAllocator!");
+
+		const uint32_t slot = current_thread_slot();
+
+		if(slot == MaxThreadSlots)
+		{
+			// No cache: take a batch, keep one block and give the rest straight back.
+			uint32_t count = 0;
+			uint32_t head  = acquire_batch(count);
+			if(head == NullIndex)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+
+			FreeBlock* block = block_at(head);
+			if(count > 1)
+			{
+				push_batch(block->next, count - 1);
+			}
+
+			m_caches[MaxThreadSlots].allocations.fetch_add(1, std::memory_order_relaxed);
+			return block;
+		}
+
+		ThreadCache& cache = m_caches[slot];
+
+		if(cache.head == NullIndex)
+		{
+			cache.head = acquire_batch(cache.count);
+			if(cache.head == NullIndex)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+		}
+
+		FreeBlock* block = block_at(cache.head);
+		cache.head	 = block->next;
+		--cache.count;
+
+		// Single writer, a plain store is enough and avoids a locked instruction.
+		cache.allocations.store(cache.allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return block;
+	}
+
+	void ConcurrentPoolAllocator::deallocate(void* ptr) noexcept
+	{
+		if(!ptr)
+		{
+			return;
+		}
+
+		DEBUG_ASSERT_MSG(owns(ptr), "Pointer does not belong to this ConcurrentPoolAllocator!");
+		DEBUG_ASSERT_MSG((static_cast<std::byte*>(ptr) - m_blocks) % m_stride == 0, "Pointer is not the start of a block!");
+
+		const uint32_t index = index_of(ptr);
+		FreeBlock*     block = static_cast<FreeBlock*>(ptr);
+
+		const uint32_t slot = current_thread_slot();
+
+		if(slot == MaxThreadSlots)
+		{
+			block->next = NullIndex;
+			push_batch(index, 1);
+			m_caches[MaxThreadSlots].frees.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		ThreadCache& cache = m_caches[slot];
+
+		block->next = cache.head;
+		cache.head  = index;
+		++cache.count;
+
+		cache.frees.store(cache.frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		// Keep one batch around for the next allocations, spill the other.
+		if(cache.count >= 2 * BatchSize)
+		{
+			const uint32_t batchHead = cache.head;
+
+			FreeBlock* tail = block_at(batchHead);
+			for(uint32_t i = 1; i < BatchSize; ++i)
+			{
+				tail = block_at(tail->next);
+			}
+
+			cache.head = tail->next;
+			cache.count -= BatchSize;
+			tail->next = NullIndex;
+
+			push_batch(batchHead, BatchSize);
+		}
+	}
+
+	void ConcurrentPoolAllocator::flush_thread_cache() noexcept
+	{
+		const uint32_t slot = current_thread_slot();
+		if(slot == MaxThreadSlots || m_caches[slot].head == NullIndex)
+		{
+			return;
+		}
+
+		ThreadCache& cache = m_caches[slot];
+		push_batch(std::exchange(cache.head, NullIndex), std::exchange(cache.count, 0));
+	}
+
+	ConcurrentPoolStats ConcurrentPoolAllocator::stats() const noexcept
+	{
+		size_t allocations = 0;
+		size_t frees	   = 0;
+
+		for(uint32_t i = 0; i <= MaxThreadSlots; ++i)
+		{
+			allocations += m_caches[i].allocations.load(std::memory_order_relaxed);
+			frees += m_caches[i].frees.load(std::memory_order_relaxed);
+		}
+
+		return ConcurrentPoolStats{
+			.blockSize	= m_stride,
+			.liveBlocks	= allocations >= frees ? allocations - frees : 0,
+			.carvedBlocks	= m_carved.load(std::memory_order_relaxed),
+			.maxBlocks	= m_maxBlocks,
+			.committedBytes = m_committed.load(std::memory_order_relaxed),
+		};
+	}
+
+	void ConcurrentPoolAllocator::push_batch(uint32_t head, uint32_t count) noexcept
+	{
+		FreeBlock* block  = block_at(head);
+		block->batchCount = count;
+
+		uint64_t oldHead = m_globalHead.load(std::memory_order_relaxed);
+		do
+		{
+			std::atomic_ref<uint32_t>(block->nextBatch).store(tagged_index(oldHead), std::memory_order_relaxed);
+		} while(!m_globalHead.compare_exchange_weak(
+			oldHead, make_tagged(tagged_tag(oldHead) + 1, head), std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	uint32_t ConcurrentPoolAllocator::pop_batch(uint32_t& count) noexcept
+	{
+		uint64_t oldHead = m_globalHead.load(std::memory_order_acquire);
+
+		while(tagged_index(oldHead) != NullIndex)
+		{
+			// The block may be popped and reused by another thread while we read it. Its
+			// memory stays committed, and the tag makes the exchange fail in that case.
+			const uint32_t head = tagged_index(oldHead);
+			const uint32_t next = std::atomic_ref<uint32_t>(block_at(head)->nextBatch).load(std::memory_order_relaxed);
+
+			if(m_globalHead.compare_exchange_weak(
+				   oldHead, make_tagged(tagged_tag(oldHead) + 1, next), std::memory_order_acquire, std::memory_order_acquire))
+			{
+				count = block_at(head)->batchCount;
+				return head;
+			}
+		}
+
+		return NullIndex;
+	}
+
+	uint32_t ConcurrentPoolAllocator::acquire_batch(uint32_t& count) noexcept
+	{
+		if(const uint32_t head = pop_batch(count); head != NullIndex)
+		{
+			return head;
+		}
+		return carve_batch(count);
+	}
+
+	uint32_t ConcurrentPoolAllocator::carve_batch(uint32_t& count) noexcept
+	{
+		lock_growth();
+
+		const size_t carved = m_carved.load(std::memory_order_relaxed);
+		const size_t blocks = std::min<size_t>(BatchSize, m_maxBlocks - carved);
+
+		if(blocks == 0)
+		{
+			unlock_growth();
+
+			// Another thread may have spilled a batch in the meantime.
+			return pop_batch(count);
+		}
+
+		const size_t end       = (carved + blocks) * m_stride;
+		const size_t committed = m_committed.load(std::memory_order_relaxed);
+
+		if(end > committed)
+		{
+			const size_t capacity  = m_maxBlocks * m_stride;
+			const size_t newCommit = std::min(align_up(std::max(end, committed + SlabSize), get_system_page_size()), capacity);
+
+			if(Result<void> grow = m_range.grow(newCommit - committed); !grow.has_value())
+			{
+				unlock_growth();
+				return NullIndex;
+			}
+
+			m_committed.store(newCommit, std::memory_order_relaxed);
+		}
+
+		const uint32_t first = static_cast<uint32_t>(carved);
+		for(uint32_t i = 0; i < blocks; ++i)
+		{
+			block_at(first + i)->next = i + 1 < blocks ? first + i + 1 : NullIndex;
+		}
+
+		m_carved.store(carved + blocks, std::memory_order_relaxed);
+		unlock_growth();
+
+		count = static_cast<uint32_t>(blocks);
+		return first;
+	}
+
+	void ConcurrentPoolAllocator::lock_growth() noexcept
+	{
+		while(m_growing.exchange(true, std::memory_order_acquire))
+		{
+			m_growing.wait(true, std::memory_order_relaxed);
+		}
+	}
+
+	void ConcurrentPoolAllocator::unlock_growth() noexcept
+	{
+		m_growing.store(false, std::memory_order_release);
+		m_growing.notify_one();
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <foundation/memory/include/double_ended_stack_allocator.hpp>
+
+#include <foundation/memory/include/alignment.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include <utility>
+
+namespace opus3d::foundation::memory
+{
+	Result<DoubleEndedStackAllocator> DoubleEndedStackAllocator::create(size_t reservedBytes, size_t retainedCommitBytes) noexcept
+	{
+		if(Result<VirtualRange> range = VirtualRange::reserve(reservedBytes); range.has_value())
+		{
+			DoubleEndedStackAllocator allocator;
+			allocator.m_range	   = std::move(range.value());
+			allocator.m_retainedCommit = retainedCommitBytes;
+			return allocator;
+		}
+		else
+		{
+			return Unexpected(range.error());
+		}
+	}
+
+	DoubleEndedStackAllocator::DoubleEndedStackAllocator(DoubleEndedStackAllocator&& other) noexcept :
+		m_range(std::move(other.m_range)), m_bottom(std::exchange(other.m_bottom, 0)), m_top(std::exchange(other.m_top, 0)),
+		m_topCommitted(std::exchange(other.m_topCommitted, 0)), m_bottomPeak(std::exchange(other.m_bottomPeak, 0)),
+		m_topPeak(std::exchange(other.m_topPeak, 0)), m_retainedCommit(other.m_retainedCommit)
+	{}
+
+	DoubleEndedStackAllocator& DoubleEndedStackAllocator::operator=(DoubleEndedStackAllocator&& other) noexcept
+	{
+		if(this != &other)
+		{
+			m_range		 = std::move(other.m_range);
+			m_bottom	 = std::exchange(other.m_bottom, 0);
+			m_top		 = std::exchange(other.m_top, 0);
+			m_topCommitted	 = std::exchange(other.m_topCommitted, 0);
+			m_bottomPeak	 = std::exchange(other.m_bottomPeak, 0);
+			m_topPeak	 = std::exchange(other.m_topPeak, 0);
+			m_retainedCommit = other.m_retainedCommit;
+		}
+		return *this;
+	}
+
+	void* DoubleEndedStackAllocator::allocate(StackEnd end, size_t size, size_t alignment) noexcept
+	{
+		Result<void*> alloc = try_allocate(end, size, alignment);
+		ASSERT_MSG(alloc.has_value(), "DoubleEndedStackAllocator out of memory!");
+		return alloc.value();
+	}
+
+	Result<void*> DoubleEndedStackAllocator::try_allocate_bottom_commit(size_t begin, size_t size) noexcept
+	{
+		ASSERT_MSG(m_range.data(), "Allocating from an unreserved DoubleEndedStackAllocator!");
+
+		// The bottom may only commit pages the top has not committed.
+		const size_t limit = m_range.capacity() - m_topCommitted;
+		if(begin > limit || size > limit - begin)
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+
+		const size_t end       = begin + size;
+		const size_t committed = m_range.size();
+		const size_t wanted    = std::max(end, committed + CommitChunkSize);
+		const size_t newCommit = std::min(align_up(wanted, get_system_page_size()), limit);
+
+		if(Result<void> grow = m_range.grow(newCommit - committed); !grow.has_value())
+		{
+			return Unexpected(grow.error());
+		}
+
+		m_bottom = end;
+		return m_range.data() + begin;
+	}
+
+	Result<void*> DoubleEndedStackAllocator::try_allocate_top_commit(size_t top) noexcept
+	{
+		ASSERT_MSG(m_range.data(), "Allocating from an unreserved DoubleEndedStackAllocator!");
+
+		// Same for the top, it stops at the pages the bottom has committed.
+		const size_t capacity = m_range.capacity();
+		const size_t limit    = capacity - m_range.size();
+		if(top > limit)
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+
+		const size_t wanted    = std::max(top, m_topCommitted + CommitChunkSize);
+		const size_t newCommit = std::min(align_up(wanted, get_system_page_size()), limit);
+
+		std::byte* commitAddress = m_range.data() + capacity - newCommit;
+		if(Result<void> commit = commit_pages(commitAddress, newCommit - m_topCommitted, MemoryAccess::ReadWrite); !commit.has_value())
+		{
+			return Unexpected(commit.error());
+		}
+
+		m_topCommitted = newCommit;
+		m_top	       = top;
+		return m_range.data() + capacity - top;
+	}
+
+	void DoubleEndedStackAllocator::decommit_bottom() noexcept
+	{
+		const size_t keep = std::min(align_up(std::max(m_bottom, m_retainedCommit), get_system_page_size()), m_range.size());
+
+		if(keep < m_range.size())
+		{
+			// Failing to hand pages back is not fatal, the end simply stays larger.
+			static_cast<void>(m_range.shrink(m_range.size() - keep));
+		}
+	}
+
+	void DoubleEndedStackAllocator::decommit_top() noexcept
+	{
+		const size_t keep = std::min(align_up(std::max(m_top, m_retainedCommit), get_system_page_size()), m_topCommitted);
+
+		if(keep < m_topCommitted)
+		{
+			std::byte* decommitAddress = m_range.data() + m_range.capacity() - m_topCommitted;
+			if(decommit_pages(decommitAddress, m_topCommitted - keep).has_value())
+			{
+				m_topCommitted = keep;
+			}
+		}
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -1,10 +1,20 @@
 #include <foundation/core/include/assert.hpp>
 #include <foundation/memory/include/heap_allocator.hpp>
+#include <foundation/memory/include/alignment.hpp>
 #include <foundation/memory/include/memory_error.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include "sync.hpp"
+#include "thread_slots.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
 
 #ifdef _WIN32
 #include <malloc.h>
-#define OpusMallocAliged _aligned_malloc
+#define OpusMallocAligned _aligned_malloc
 #define OpusMallocFree _aligned_free
 #else
 #include <stdlib.h>
@@ -28,7 +38,255 @@ inline void* opus_posix_aligned_alloc(size_t size, size_t alignment)
 
 namespace opus3d::foundation::memory
 {
-	ErrorCode create_memory_error(MemoryErrorCode errorCode) noexcept { return ErrorCode::create(error_domains::Memory, static_cast<uint32_t>(errorCode)); }
+	namespace
+	{
+		// 16 byte steps up to 128, then four classes per power of two up to MaxSmallSize.
+		constexpr uint32_t SizeClasses[] = {16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+		constexpr size_t   SizeClassCount = std::size(SizeClasses);
+
+		static_assert(SizeClasses[SizeClassCount - 1] == HeapAllocator::MaxSmallSize);
+
+		// Slabs are MaxSmallAlignment aligned, so a block is aligned to the largest power
+		// of two dividing its size, up to that.
+		constexpr size_t size_class_alignment(size_t index) noexcept
+		{
+			return std::min<size_t>(size_t(1) << std::countr_zero(SizeClasses[index]), HeapAllocator::MaxSmallAlignment);
+		}
+
+		constexpr size_t SlabSize	    = 64 * 1024;
+		constexpr uint32_t MagazineCapacity = 64;
+		constexpr uint32_t BatchSize	    = MagazineCapacity / 2;
+
+		bool is_small(size_t size, size_t alignment) noexcept
+		{
+			return size <= HeapAllocator::MaxSmallSize && alignment <= HeapAllocator::MaxSmallAlignment;
+		}
+
+		// Page mappings are page aligned, anything stricter stays on the system heap.
+		bool is_large(size_t size, size_t alignment) noexcept
+		{
+			return size >= HeapAllocator::LargeBlockThreshold && alignment <= get_system_page_size();
+		}
+
+		size_t large_block_bytes(size_t size) noexcept { return align_up(size, get_system_page_size()); }
+
+		// Deterministic for a (size, alignment) pair, so deallocate finds the same class.
+		size_t size_class_index(size_t size, size_t alignment) noexcept
+		{
+			size = std::max(size, alignment);
+
+			size_t index = 0;
+			if(size <= 128)
+			{
+				index = (size + 15) / 16 - 1;
+			}
+			else
+			{
+				const size_t bits = static_cast<size_t>(std::bit_width(size - 1));
+				index		  = 8 + (bits - 8) * 4 + (((size - 1) >> (bits - 3)) & 3);
+			}
+
+			while(size_class_alignment(index) < alignment)
+			{
+				++index;
+			}
+
+			return index;
+		}
+
+		struct FreeNode
+		{
+			FreeNode* next;
+		};
+
+		// Shared by all threads, only touched in batches.
+		struct alignas(64) CentralClass
+		{
+			detail::SpinLock mutex;
+			FreeNode*	 freeList = nullptr;
+			std::byte*	 cursor	  = nullptr; // Uncarved part of the current slab.
+			std::byte*	 end	  = nullptr;
+		};
+
+		// Constant initialized and trivially destructible, so it outlives every thread cache.
+		constinit CentralClass g_central[SizeClassCount] = {};
+
+		struct Magazine
+		{
+			uint32_t count = 0;
+			void*	 blocks[MagazineCapacity];
+		};
+
+		// Moves up to BatchSize blocks from the central cache into the magazine.
+		bool refill(size_t index, Magazine& magazine) noexcept
+		{
+			CentralClass& central = g_central[index];
+			const size_t  size    = SizeClasses[index];
+
+			central.mutex.lock();
+
+			while(magazine.count < BatchSize && central.freeList)
+			{
+				magazine.blocks[magazine.count++] = central.freeList;
+				central.freeList		  = central.freeList->next;
+			}
+
+			while(magazine.count < BatchSize)
+			{
+				if(central.cursor + size > central.end)
+				{
+					// Only the slab tail smaller than one block is lost.
+					std::byte* slab = static_cast<std::byte*>(OpusMallocAligned(SlabSize, HeapAllocator::MaxSmallAlignment));
+					if(!slab)
+					{
+						break;
+					}
+					central.cursor = slab;
+					central.end    = slab + SlabSize;
+				}
+
+				magazine.blocks[magazine.count++] = central.cursor;
+				central.cursor += size;
+			}
+
+			central.mutex.unlock();
+
+			return magazine.count > 0;
+		}
+
+		// Moves the top count blocks of the magazine back to the central cache.
+		void flush(size_t index, Magazine& magazine, uint32_t count) noexcept
+		{
+			if(count == 0)
+			{
+				return;
+			}
+
+			// Chain them up before taking the lock.
+			const uint32_t first = magazine.count - count;
+			for(uint32_t i = first; i + 1 < magazine.count; ++i)
+			{
+				static_cast<FreeNode*>(magazine.blocks[i])->next = static_cast<FreeNode*>(magazine.blocks[i + 1]);
+			}
+
+			FreeNode* head = static_cast<FreeNode*>(magazine.blocks[first]);
+			FreeNode* tail = static_cast<FreeNode*>(magazine.blocks[magazine.count - 1]);
+			magazine.count = first;
+
+			CentralClass& central = g_central[index];
+			central.mutex.lock();
+			tail->next	 = central.freeList;
+			central.freeList = head;
+			central.mutex.unlock();
+		}
+
+		enum class ThreadCacheState : uint8_t
+		{
+			Fresh,	 // No exit hook registered yet.
+			Armed,	 // Magazines are flushed when the thread exits.
+			Retired, // Exit flush done, late frees go straight to the central cache.
+		};
+
+		// Constant initialized and trivially destructible, so the fast paths access it
+		// without any thread_local init guard. The exit flush hangs off ThreadCacheReaper.
+		struct ThreadCache
+		{
+			Magazine	 magazines[SizeClassCount];
+			ThreadCacheState state;
+			uint32_t	 slot; // detail::current_thread_slot(), valid while Armed.
+		};
+
+		constinit thread_local ThreadCache t_cache = {};
+
+		struct ThreadCacheReaper
+		{
+			~ThreadCacheReaper()
+			{
+				for(size_t i = 0; i < SizeClassCount; ++i)
+				{
+					flush(i, t_cache.magazines[i], t_cache.magazines[i].count);
+				}
+				t_cache.state = ThreadCacheState::Retired;
+			}
+		};
+
+		void arm_thread_cache() noexcept
+		{
+			// Taking the slot first makes it outlive the reaper during thread exit.
+			t_cache.slot = detail::current_thread_slot();
+
+			thread_local ThreadCacheReaper reaper;
+			static_cast<void>(reaper);
+			t_cache.state = ThreadCacheState::Armed;
+		}
+
+		Result<void*> allocate_small_slow(size_t index) noexcept
+		{
+			if(t_cache.state == ThreadCacheState::Fresh)
+			{
+				arm_thread_cache();
+			}
+
+			Magazine& magazine = t_cache.magazines[index];
+			if(!refill(index, magazine))
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+
+			void* ptr = magazine.blocks[--magazine.count];
+
+			// Nobody will flush for a retired thread, hand the rest back right away.
+			if(t_cache.state == ThreadCacheState::Retired)
+			{
+				flush(index, magazine, magazine.count);
+			}
+			return ptr;
+		}
+
+		Result<void*> allocate_small(size_t index) noexcept
+		{
+			Magazine& magazine = t_cache.magazines[index];
+			if(magazine.count > 0)
+			{
+				return magazine.blocks[--magazine.count];
+			}
+			return allocate_small_slow(index);
+		}
+
+		void deallocate_small_slow(size_t index, void* ptr) noexcept
+		{
+			if(t_cache.state == ThreadCacheState::Fresh)
+			{
+				arm_thread_cache();
+			}
+
+			Magazine& magazine = t_cache.magazines[index];
+
+			// Keep half the magazine for the next allocations, spill the rest.
+			if(magazine.count == MagazineCapacity)
+			{
+				flush(index, magazine, BatchSize);
+			}
+			magazine.blocks[magazine.count++] = ptr;
+
+			if(t_cache.state == ThreadCacheState::Retired)
+			{
+				flush(index, magazine, magazine.count);
+			}
+		}
+
+		void deallocate_small(size_t index, void* ptr) noexcept
+		{
+			Magazine& magazine = t_cache.magazines[index];
+			if(t_cache.state == ThreadCacheState::Armed && magazine.count < MagazineCapacity)
+			{
+				magazine.blocks[magazine.count++] = ptr;
+				return;
+			}
+			deallocate_small_slow(index, ptr);
+		}
+
+	} // namespace
 
 	Result<void*> HeapAllocator::try_allocate(size_t size, size_t alignment) noexcept
 	{
@@ -46,19 +304,53 @@ namespace opus3d::foundation::memory
 		DEBUG_ASSERT(alignment != 0);
 		DEBUG_ASSERT((alignment & (alignment - 1)) == 0);
 
-		if(void* ptr = OpusMallocAliged(size, alignment); ptr)
+		void* ptr = nullptr;
+
+		if(is_small(size, alignment))
 		{
-			m_allocationCount++;
-			m_totalAllocatedSize += size;
-			return ptr;
+			Result<void*> small = allocate_small(size_class_index(size, alignment));
+			if(!small.has_value())
+			{
+				return small;
+			}
+			ptr = small.value();
+		}
+		else if(is_large(size, alignment))
+		{
+			Result<void*> pages = allocate_pages(large_block_bytes(size), MemoryAccess::ReadWrite);
+			if(!pages.has_value())
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+			ptr = pages.value();
 		}
 		else
 		{
-			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			ptr = OpusMallocAligned(size, alignment);
+			if(!ptr)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+		}
+
+		record(1, size);
+		return ptr;
+	}
+
+	Result<void*> HeapAllocator::try_allocate_zeroed(size_t size, size_t alignment) noexcept
+	{
+		Result<void*> alloc = try_allocate(size, alignment);
+
+		// Anonymous mappings come zero-filled from the OS, only recycled memory needs clearing.
+		if(alloc.has_value() && size > 0 && !is_large(size, std::max(alignment, alignof(void*))))
+		{
+			std::memset(alloc.value(), 0, size);
 		}
+
+		return alloc;
 	}
 
-	void HeapAllocator::deallocate(void* ptr, size_t size, size_t) noexcept
+	void HeapAllocator::deallocate(void* ptr, size_t size, size_t alignment) noexcept
 	{
 		// On POSIX nullptr is fine, on Windows it's undefined behavior.
 		// So for consistency:
@@ -67,9 +359,105 @@ namespace opus3d::foundation::memory
 			return;
 		}
 
-		OpusMallocFree(ptr);
-		m_totalAllocatedSize -= size;
-		m_allocationCount--;
+		alignment = std::max(alignment, alignof(void*));
+
+		if(is_small(size, alignment))
+		{
+			deallocate_small(size_class_index(size, alignment), ptr);
+		}
+		else if(is_large(size, alignment))
+		{
+			static_cast<void>(release_pages(ptr, large_block_bytes(size)));
+		}
+		else
+		{
+			OpusMallocFree(ptr);
+		}
+
+		record(size_t(-1), size_t(0) - size);
+	}
+
+	Result<void*> HeapAllocator::try_resize(void* ptr, size_t oldSize, size_t newSize, size_t alignment) noexcept
+	{
+		ASSERT_MSG(ptr, "Resizing a null block!");
+
+		alignment = std::max(alignment, alignof(void*));
+
+		// deallocate() picks the path from the size, so a block can never change paths.
+		if(is_small(oldSize, alignment) && is_small(newSize, alignment))
+		{
+			if(size_class_index(oldSize, alignment) == size_class_index(newSize, alignment))
+			{
+				record(0, newSize - oldSize);
+				return ptr;
+			}
+		}
+		else if(is_large(oldSize, alignment) && is_large(newSize, alignment))
+		{
+			if(large_block_bytes(oldSize) == large_block_bytes(newSize))
+			{
+				record(0, newSize - oldSize);
+				return ptr;
+			}
+
+			if(Result<void*> remapped = remap_pages(ptr, large_block_bytes(oldSize), large_block_bytes(newSize)); remapped.has_value())
+			{
+				record(0, newSize - oldSize);
+				return remapped.value();
+			}
+		}
+
+		return Unexpected(create_memory_error(MemoryErrorCode::ResizeNotInPlace));
+	}
+
+	size_t HeapAllocator::bytes_allocated() const noexcept
+	{
+		size_t bytes = 0;
+		for(const StatStripe& stripe : m_stats)
+		{
+			bytes += stripe.bytes.load(std::memory_order_relaxed);
+		}
+		return bytes;
+	}
+
+	size_t HeapAllocator::allocation_count() const noexcept
+	{
+		size_t count = 0;
+		for(const StatStripe& stripe : m_stats)
+		{
+			count += stripe.count.load(std::memory_order_relaxed);
+		}
+		return count;
+	}
+
+	void HeapAllocator::flush_thread_cache() noexcept
+	{
+		for(size_t i = 0; i < SizeClassCount; ++i)
+		{
+			flush(i, t_cache.magazines[i], t_cache.magazines[i].count);
+		}
+	}
+
+	void HeapAllocator::record(size_t countDelta, size_t bytesDelta) noexcept
+	{
+		if(t_cache.state == ThreadCacheState::Fresh)
+		{
+			arm_thread_cache();
+		}
+
+		if(t_cache.state == ThreadCacheState::Armed && t_cache.slot < OwnedStatStripeCount)
+		{
+			// Only this thread writes the stripe, no read-modify-write needed.
+			StatStripe& stripe = m_stats[t_cache.slot];
+			stripe.count.store(stripe.count.load(std::memory_order_relaxed) + countDelta, std::memory_order_relaxed);
+			stripe.bytes.store(stripe.bytes.load(std::memory_order_relaxed) + bytesDelta, std::memory_order_relaxed);
+		}
+		else
+		{
+			StatStripe& shared = m_stats[OwnedStatStripeCount];
+			shared.count.fetch_add(countDelta, std::memory_order_relaxed);
+			shared.bytes.fetch_add(bytesDelta, std::memory_order_relaxed);
+		}
 	}
 
 } // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -1,14 +1,104 @@
 #include <foundation/memory/include/linear_allocator.hpp>
 
+#include <foundation/memory/include/alignment.hpp>
+#include <foundation/memory/include/memory_error.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include <utility>
+
 namespace opus3d::foundation::memory
 {
-	Result<LinearAllocator> LinearAllocator::create(size_t reservedBytes) { return LinearAllocator(reservedBytes); }
+	Result<LinearAllocator> LinearAllocator::create(size_t reservedBytes, size_t retainedCommitBytes, NumaPolicy numa) noexcept
+	{
+		if(Result<VirtualRange> range = VirtualRange::reserve(reservedBytes, MemoryPageSize::Normal, numa); range.has_value())
+		{
+			LinearAllocator allocator;
+			allocator.m_range	   = std::move(range.value());
+			allocator.m_retainedCommit = retainedCommitBytes;
+			return allocator;
+		}
+		else
+		{
+			return Unexpected(range.error());
+		}
+	}
+
+	LinearAllocator::LinearAllocator(size_t reserveSize, size_t retainedCommitBytes) noexcept : m_retainedCommit(retainedCommitBytes)
+	{
+		if(Result<VirtualRange> range = VirtualRange::reserve(reserveSize); range.has_value())
+		{
+			m_range = std::move(range.value());
+		}
+		else
+		{
+			panic("LinearAllocator: failed to reserve address range", range.error());
+		}
+	}
+
+	LinearAllocator::LinearAllocator(LinearAllocator&& other) noexcept :
+		m_range(std::move(other.m_range)), m_offset(std::exchange(other.m_offset, 0)), m_peak(std::exchange(other.m_peak, 0)),
+		m_dirty(std::exchange(other.m_dirty, 0)), m_retainedCommit(other.m_retainedCommit)
+	{}
+
+	LinearAllocator& LinearAllocator::operator=(LinearAllocator&& other) noexcept
+	{
+		if(this != &other)
+		{
+			m_range		 = std::move(other.m_range);
+			m_offset	 = std::exchange(other.m_offset, 0);
+			m_peak		 = std::exchange(other.m_peak, 0);
+			m_dirty		 = std::exchange(other.m_dirty, 0);
+			m_retainedCommit = other.m_retainedCommit;
+		}
+		return *this;
+	}
+
+	void* LinearAllocator::allocate(size_t size, size_t alignment) noexcept
+	{
+		Result<void*> alloc = try_allocate(size, alignment);
+		ASSERT_MSG(alloc.has_value(), "LinearAllocator out of memory!");
+		return alloc.value();
+	}
+
+	Result<void*> LinearAllocator::try_allocate_commit(size_t begin, size_t size) noexcept
+	{
+		ASSERT_MSG(m_range.data(), "Allocating from an unreserved LinearAllocator!");
+
+		const size_t capacity = m_range.capacity();
+		if(begin > capacity || size > capacity - begin)
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+
+		// Commit at least a chunk so that a stream of small allocations does not
+		// turn into one commit per page.
+		const size_t end	= begin + size;
+		const size_t committed	= m_range.size();
+		const size_t wanted	= std::max(end, committed + CommitChunkSize);
+		const size_t newCommit	= std::min(align_up(wanted, get_system_page_size()), capacity);
+
+		if(Result<void> grow = m_range.grow(newCommit - committed); !grow.has_value())
+		{
+			return Unexpected(grow.error());
+		}
+
+		m_offset = end;
+		return m_range.data() + begin;
+	}
 
-	LinearAllocator::LinearAllocator(size_t reserveSize) {}
+	void LinearAllocator::decommit_unused() noexcept
+	{
+		// Keep everything up to the retained commit (or the live offset, if that is higher).
+		const size_t keep = std::min(align_up(std::max(m_offset, m_retainedCommit), get_system_page_size()), m_range.capacity());
 
-	void* LinearAllocator::allocate(size_t size, size_t alignment) noexcept { return nullptr; }
+		if(keep < m_range.size())
+		{
+			// Failing to hand pages back is not fatal, the arena simply stays larger.
+			static_cast<void>(m_range.shrink(m_range.size() - keep));
 
-	Result<void*> LinearAllocator::try_allocate(size_t size, size_t alignment) noexcept { return nullptr; }
+			// Decommitted pages come back zeroed when they are committed again.
+			m_dirty = std::min(m_dirty, m_range.committed_size());
+		}
+	}
 
-	void LinearAllocator::reset() noexcept {}
 } // namespace opus3d::foundation::memory
\ No newline at end of file
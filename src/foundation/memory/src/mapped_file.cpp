@@ -0,0 +1,115 @@
+#include <foundation/memory/include/mapped_file.hpp>
+
+#include <foundation/core/include/panic.hpp>
+#include <foundation/memory/include/alignment.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace opus3d::foundation::memory
+{
+	namespace
+	{
+		struct PageSpan
+		{
+			void*  address;
+			size_t size;
+		};
+
+		// Widens [offset, offset + length) of the view to whole pages, length is clamped to the view.
+		PageSpan page_span(const std::byte* data, size_t viewSize, size_t offset, size_t length) noexcept
+		{
+			const size_t pageSize = get_system_page_size();
+			const size_t begin    = std::min(offset, viewSize);
+			const size_t end      = begin + std::min(length, viewSize - begin);
+
+			const size_t pageBegin = begin & ~(pageSize - 1);
+			const size_t pageEnd   = align_up(end, pageSize);
+
+			return PageSpan{.address = const_cast<std::byte*>(data) + pageBegin, .size = pageEnd - pageBegin};
+		}
+	} // namespace
+
+	Result<MappedFile> MappedFile::map(NativeFileHandle file, const MappedFileOptions& options) noexcept
+	{
+		Result<size_t> size = get_file_size(file);
+		if(!size.has_value())
+		{
+			return Unexpected(size.error());
+		}
+
+		MappedFile mapped;
+		if(size.value() == 0)
+		{
+			return mapped;
+		}
+
+		Result<void*> view = map_file(file, size.value(), MemoryAccess::Read, options.prefault);
+		if(!view.has_value())
+		{
+			return Unexpected(view.error());
+		}
+
+		mapped.m_data = static_cast<const std::byte*>(view.value());
+		mapped.m_size = size.value();
+
+		// Hints are best-effort, a kernel that ignores them still gives a working view.
+		if(options.pattern != MemoryAccessPattern::Normal)
+		{
+			static_cast<void>(mapped.advise(options.pattern));
+		}
+		if(options.prefetch)
+		{
+			static_cast<void>(mapped.prefetch());
+		}
+
+		return mapped;
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept : m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)) {}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if(this != &other)
+		{
+			reset();
+
+			m_data = std::exchange(other.m_data, nullptr);
+			m_size = std::exchange(other.m_size, 0);
+		}
+		return *this;
+	}
+
+	Result<void> MappedFile::advise(MemoryAccessPattern pattern, size_t offset, size_t length) noexcept
+	{
+		if(const PageSpan span = page_span(m_data, m_size, offset, length); span.size > 0)
+		{
+			return advise_pages(span.address, span.size, pattern);
+		}
+		return {};
+	}
+
+	Result<void> MappedFile::prefetch(size_t offset, size_t length) noexcept
+	{
+		if(const PageSpan span = page_span(m_data, m_size, offset, length); span.size > 0)
+		{
+			return prefetch_pages(span.address, span.size);
+		}
+		return {};
+	}
+
+	void MappedFile::reset() noexcept
+	{
+		if(m_data)
+		{
+			if(Result<void> unmap = unmap_file(const_cast<std::byte*>(m_data), m_size); !unmap.has_value())
+			{
+				panic("MappedFile::reset", unmap.error());
+			}
+
+			m_data = nullptr;
+			m_size = 0;
+		}
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
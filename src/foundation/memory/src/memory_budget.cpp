@@ -0,0 +1,218 @@
+#include <foundation/core/include/assert.hpp>
+#include <foundation/memory/include/memory_budget.hpp>
+
+#include "sync.hpp"
+
+#include <atomic>
+
+namespace opus3d::foundation::memory
+{
+	namespace
+	{
+		struct alignas(64) BudgetCounters
+		{
+			std::atomic<uint64_t> usedBytes{0};
+			std::atomic<uint64_t> peakBytes{0};
+			std::atomic<uint64_t> framePeakBytes{0};
+			std::atomic<uint64_t> lastFramePeakBytes{0};
+			std::atomic<uint64_t> softLimit{NoMemoryLimit};
+			std::atomic<uint64_t> hardLimit{NoMemoryLimit};
+			std::atomic<uint64_t> softCrossings{0};
+			std::atomic<uint64_t> hardFailures{0};
+		};
+
+		constinit BudgetCounters g_budgets[MemoryTagCount];
+
+		BudgetCounters& budget(MemoryTag tag) noexcept
+		{
+			DEBUG_ASSERT(static_cast<size_t>(tag) < MemoryTagCount);
+			return g_budgets[static_cast<size_t>(tag)];
+		}
+
+		struct PressureCallback
+		{
+			MemoryPressureFn fn   = nullptr;
+			void*		 user = nullptr;
+			uint32_t	 id   = 0; // 0 marks a free slot.
+			MemoryTag	 tag  = MemoryTag::General;
+		};
+
+		// Registration is rare, a spin lock around a small table is enough.
+		struct PressureRegistry
+		{
+			detail::SpinLock mutex;
+			uint32_t	 nextId = 1;
+			PressureCallback slots[MaxMemoryPressureCallbacks]{};
+		};
+
+		constinit PressureRegistry g_pressure;
+
+		// Set while this thread runs pressure callbacks, so what they allocate or free can
+		// not call back into them.
+		thread_local bool t_inPressureCallback = false;
+
+		void notify_pressure(MemoryTag tag, uint64_t excessBytes) noexcept
+		{
+			if(t_inPressureCallback)
+			{
+				return;
+			}
+
+			// Callbacks run outside the lock, they are free to (un)register.
+			PressureCallback pending[MaxMemoryPressureCallbacks];
+			size_t		 count = 0;
+
+			g_pressure.mutex.lock();
+			for(const PressureCallback& callback : g_pressure.slots)
+			{
+				if(callback.id != 0 && callback.tag == tag)
+				{
+					pending[count++] = callback;
+				}
+			}
+			g_pressure.mutex.unlock();
+
+			t_inPressureCallback = true;
+			for(size_t i = 0; i < count; ++i)
+			{
+				pending[i].fn(pending[i].user, tag, excessBytes);
+			}
+			t_inPressureCallback = false;
+		}
+
+		// Charges bytes unless that would cross the hard limit, returns the usage before the charge.
+		bool try_charge(BudgetCounters& b, uint64_t bytes, uint64_t& used) noexcept
+		{
+			const uint64_t hard = b.hardLimit.load(std::memory_order_relaxed);
+
+			used = b.usedBytes.load(std::memory_order_relaxed);
+			do
+			{
+				if(bytes > hard || used > hard - bytes)
+				{
+					return false;
+				}
+			} while(!b.usedBytes.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+
+			return true;
+		}
+	} // namespace
+
+	void set_memory_budget(MemoryTag tag, uint64_t softBytes, uint64_t hardBytes) noexcept
+	{
+		ASSERT_MSG(softBytes <= hardBytes, "Soft memory limit above the hard limit");
+
+		BudgetCounters& b = budget(tag);
+		b.softLimit.store(softBytes, std::memory_order_relaxed);
+		b.hardLimit.store(hardBytes, std::memory_order_relaxed);
+	}
+
+	MemoryBudgetStats memory_budget_stats(MemoryTag tag) noexcept
+	{
+		const BudgetCounters& b = budget(tag);
+
+		MemoryBudgetStats stats;
+		stats.usedBytes		 = b.usedBytes.load(std::memory_order_relaxed);
+		stats.peakBytes		 = b.peakBytes.load(std::memory_order_relaxed);
+		stats.lastFramePeakBytes = b.lastFramePeakBytes.load(std::memory_order_relaxed);
+		stats.softLimit		 = b.softLimit.load(std::memory_order_relaxed);
+		stats.hardLimit		 = b.hardLimit.load(std::memory_order_relaxed);
+		stats.softCrossings	 = b.softCrossings.load(std::memory_order_relaxed);
+		stats.hardFailures	 = b.hardFailures.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	void memory_budget_begin_frame() noexcept
+	{
+		for(size_t i = 0; i < MemoryTagCount; ++i)
+		{
+			BudgetCounters& b    = g_budgets[i];
+			const uint64_t	used = b.usedBytes.load(std::memory_order_relaxed);
+
+			b.lastFramePeakBytes.store(b.framePeakBytes.exchange(used, std::memory_order_relaxed), std::memory_order_relaxed);
+
+			// Callbacks only fire on the crossing itself, keep asking while the tag stays over.
+			if(const uint64_t soft = b.softLimit.load(std::memory_order_relaxed); used > soft)
+			{
+				notify_pressure(static_cast<MemoryTag>(i), used - soft);
+			}
+		}
+	}
+
+	Result<void> charge_memory_budget(MemoryTag tag, size_t bytes) noexcept
+	{
+		BudgetCounters& b    = budget(tag);
+		uint64_t	used = 0;
+
+		if(!try_charge(b, bytes, used))
+		{
+			// Give the subsystem one chance to make room before failing the charge.
+			const uint64_t soft = b.softLimit.load(std::memory_order_relaxed);
+			notify_pressure(tag, used + bytes > soft ? used + bytes - soft : 0);
+
+			if(!try_charge(b, bytes, used))
+			{
+				b.hardFailures.fetch_add(1, std::memory_order_relaxed);
+				return Unexpected(create_memory_error(MemoryErrorCode::BudgetExceeded));
+			}
+		}
+
+		const uint64_t newUsed = used + bytes;
+		detail::atomic_max(b.peakBytes, newUsed);
+		detail::atomic_max(b.framePeakBytes, newUsed);
+
+		if(const uint64_t soft = b.softLimit.load(std::memory_order_relaxed); used <= soft && newUsed > soft)
+		{
+			b.softCrossings.fetch_add(1, std::memory_order_relaxed);
+			notify_pressure(tag, newUsed - soft);
+		}
+
+		return {};
+	}
+
+	void release_memory_budget(MemoryTag tag, size_t bytes) noexcept
+	{
+		[[maybe_unused]] const uint64_t used = budget(tag).usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+		DEBUG_ASSERT(used >= bytes);
+	}
+
+	Result<uint32_t> register_memory_pressure_callback(MemoryTag tag, MemoryPressureFn fn, void* user) noexcept
+	{
+		ASSERT(fn);
+
+		uint32_t id = 0;
+
+		g_pressure.mutex.lock();
+		for(PressureCallback& slot : g_pressure.slots)
+		{
+			if(slot.id == 0)
+			{
+				id   = g_pressure.nextId++;
+				slot = PressureCallback{.fn = fn, .user = user, .id = id, .tag = tag};
+				break;
+			}
+		}
+		g_pressure.mutex.unlock();
+
+		if(id == 0)
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+		return id;
+	}
+
+	void unregister_memory_pressure_callback(uint32_t handle) noexcept
+	{
+		g_pressure.mutex.lock();
+		for(PressureCallback& slot : g_pressure.slots)
+		{
+			if(slot.id == handle && handle != 0)
+			{
+				slot = PressureCallback{};
+				break;
+			}
+		}
+		g_pressure.mutex.unlock();
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
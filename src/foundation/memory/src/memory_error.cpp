@@ -1,5 +1,6 @@
 #include <foundation/memory/include/memory_error.hpp>
 
+#include <algorithm>
 #include <memory>
 #include <string_view>
 
@@ -33,6 +34,22 @@ namespace opus3d::foundation::error_domains
 			{
 				return paste_error_string(strBuffer, "Allocator lacks resize fptr!");
 			}
+			case memory::MemoryErrorCode::UnsupportedRequest:
+			{
+				return paste_error_string(strBuffer, "Allocator can not serve this size or alignment!");
+			}
+			case memory::MemoryErrorCode::ResizeNotInPlace:
+			{
+				return paste_error_string(strBuffer, "Block can not be resized in place!");
+			}
+			case memory::MemoryErrorCode::PlatformUnsupported:
+			{
+				return paste_error_string(strBuffer, "Not supported on this platform!");
+			}
+			case memory::MemoryErrorCode::BudgetExceeded:
+			{
+				return paste_error_string(strBuffer, "Memory budget exceeded!");
+			}
 			default:
 			{
 				return paste_error_string(strBuffer, "Unknown Error!");
@@ -40,4 +57,9 @@ namespace opus3d::foundation::error_domains
 		}
 	}
 
-} // namespace opus3d::foundation::error_domains
\ No newline at end of file
+} // namespace opus3d::foundation::error_domains
+
+namespace opus3d::foundation::memory
+{
+	ErrorCode create_memory_error(MemoryErrorCode errorCode) noexcept { return ErrorCode::create(error_domains::Memory, static_cast<uint32_t>(errorCode)); }
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,198 @@
+#ifdef __linux__
+
+#include <foundation/memory/include/numa.hpp>
+
+#include "sys_file_linux.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace opus3d::foundation::memory
+{
+	static Unexpected<ErrorCode> errno_error() { return Unexpected(ErrorCode::create(error_domains::System, static_cast<uint32_t>(errno))); }
+
+	// Calls fn(first, last) for every range of a sysfs list such as "0-3,8,10-11".
+	template <typename Fn>
+	static void for_each_list_range(const char* list, Fn&& fn) noexcept
+	{
+		const char* p = list;
+		while(*p >= '0' && *p <= '9')
+		{
+			char*	      end   = nullptr;
+			const unsigned first = static_cast<unsigned>(std::strtoul(p, &end, 10));
+			unsigned       last  = first;
+
+			if(*end == '-')
+			{
+				last = static_cast<unsigned>(std::strtoul(end + 1, &end, 10));
+			}
+
+			fn(first, last);
+
+			p = *end == ',' ? end + 1 : end;
+		}
+	}
+
+	static NumaTopology read_numa_topology() noexcept
+	{
+		NumaTopology topology;
+		topology.cpuCount = static_cast<uint32_t>(std::max(::sysconf(_SC_NPROCESSORS_CONF), 1L));
+
+		char buffer[4096];
+		if(!detail::read_sys_file("/sys/devices/system/node/online", buffer, sizeof(buffer)))
+		{
+			return topology;
+		}
+
+		uint32_t nodeCount = 1;
+		for_each_list_range(buffer, [&](unsigned, unsigned last) { nodeCount = std::max(nodeCount, last + 1); });
+		topology.nodeCount = std::min(nodeCount, MaxNumaNodes);
+
+		if(detail::read_sys_file("/sys/devices/system/node/has_memory", buffer, sizeof(buffer)))
+		{
+			uint64_t mask = 0;
+			for_each_list_range(buffer, [&](unsigned first, unsigned last) {
+				for(unsigned node = first; node <= last && node < MaxNumaNodes; ++node)
+				{
+					mask |= uint64_t(1) << node;
+				}
+			});
+			topology.memoryNodeMask = mask ? mask : 1;
+		}
+
+		for(uint32_t node = 0; node < topology.nodeCount; ++node)
+		{
+			char path[64];
+			std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+			if(!detail::read_sys_file(path, buffer, sizeof(buffer)))
+			{
+				continue;
+			}
+
+			for_each_list_range(buffer, [&](unsigned first, unsigned last) {
+				for(unsigned cpu = first; cpu <= last && cpu < MaxNumaCpus; ++cpu)
+				{
+					topology.cpuToNode[cpu] = static_cast<uint8_t>(node);
+				}
+			});
+		}
+
+		return topology;
+	}
+
+	const NumaTopology& numa_topology() noexcept
+	{
+		static const NumaTopology cached = read_numa_topology();
+		return cached;
+	}
+
+	uint32_t current_numa_node() noexcept
+	{
+		if(!numa_topology().is_numa())
+		{
+			return 0;
+		}
+
+		unsigned cpu  = 0;
+		unsigned node = 0;
+		if(::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+		{
+			return 0;
+		}
+		return node;
+	}
+
+	// Translates a policy into an mbind/set_mempolicy mode and node mask. Returns false when
+	// the policy means "leave the default alone".
+	static bool to_linux_policy(const NumaPolicy& policy, int& mode, unsigned long& mask) noexcept
+	{
+		const NumaTopology& topology = numa_topology();
+
+		if(!topology.is_numa())
+		{
+			return false;
+		}
+
+		switch(policy.placement)
+		{
+			case NumaPlacement::PreferNode:
+			{
+				// A node without memory can not hold the pages, leave placement to the kernel.
+				if(!topology.node_has_memory(policy.node))
+				{
+					return false;
+				}
+				mode = MPOL_PREFERRED;
+				mask = 1ul << policy.node;
+				return true;
+			}
+			case NumaPlacement::Interleave:
+			{
+				mode = MPOL_INTERLEAVE;
+				mask = static_cast<unsigned long>(topology.memoryNodeMask);
+				return true;
+			}
+			default:
+			{
+				return false;
+			}
+		}
+	}
+
+	// The kernel reads maxnode - 1 bits from the mask.
+	static constexpr unsigned long MaskBits = sizeof(unsigned long) * 8 + 1;
+
+	Result<void> apply_numa_policy(void* address, size_t size, const NumaPolicy& policy) noexcept
+	{
+		int	      mode = 0;
+		unsigned long mask = 0;
+		if(!to_linux_policy(policy, mode, mask))
+		{
+			return {};
+		}
+
+		if(::syscall(SYS_mbind, address, size, mode, &mask, MaskBits, 0) != 0)
+		{
+			return errno_error();
+		}
+
+		return {};
+	}
+
+	Result<void> set_thread_numa_policy(const NumaPolicy& policy) noexcept
+	{
+		if(!numa_topology().is_numa())
+		{
+			return {};
+		}
+
+		int	      mode = 0;
+		unsigned long mask = 0;
+
+		long result = 0;
+		if(to_linux_policy(policy, mode, mask))
+		{
+			result = ::syscall(SYS_set_mempolicy, mode, &mask, MaskBits);
+		}
+		else
+		{
+			result = ::syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+		}
+
+		if(result != 0)
+		{
+			return errno_error();
+		}
+
+		return {};
+	}
+
+} // namespace opus3d::foundation::memory
+
+#endif
\ No newline at end of file
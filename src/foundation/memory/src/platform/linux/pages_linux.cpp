@@ -1,16 +1,31 @@
 #ifdef __linux__
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // mremap
+#endif
+
 #include <foundation/memory/include/pages.hpp>
 
+#include "sys_file_linux.hpp"
+
+#include <algorithm>
+#include <bit>
 #include <cerrno>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <iterator>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <cassert>
 #include <cstddef>
 
-namespace opus3d::foundation
+namespace opus3d::foundation::memory
 {
 	static Unexpected<ErrorCode> errno_error() { return Unexpected(ErrorCode::create(error_domains::System, static_cast<uint32_t>(errno))); }
 
@@ -49,7 +64,99 @@ namespace opus3d::foundation
 #endif
 	}
 
-	size_t get_system_page_size()
+	static size_t read_sys_size(const char* path) noexcept
+	{
+		char buffer[32];
+		return detail::read_sys_file(path, buffer, sizeof(buffer)) ? std::strtoull(buffer, nullptr, 10) : 0;
+	}
+
+	static TransparentHugePageMode read_thp_mode() noexcept
+	{
+		// The active mode is the bracketed one, e.g. "always [madvise] never".
+		char buffer[64];
+		if(detail::read_sys_file("/sys/kernel/mm/transparent_hugepage/enabled", buffer, sizeof(buffer)) == 0)
+		{
+			return TransparentHugePageMode::Unsupported;
+		}
+
+		if(std::strstr(buffer, "[always]"))
+		{
+			return TransparentHugePageMode::Always;
+		}
+		if(std::strstr(buffer, "[madvise]"))
+		{
+			return TransparentHugePageMode::Madvise;
+		}
+		return TransparentHugePageMode::Never;
+	}
+
+	// Without THP the PMD size still is the natural huge page size, 2 MB on x86-64 and
+	// on arm64 with 4 KB pages.
+	static size_t pmd_page_size() noexcept
+	{
+		const size_t pmdSize = read_sys_size("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+		return pmdSize ? pmdSize : size_t(2) * 1024 * 1024;
+	}
+
+	// The configuration that decides how Large reservations are attempted, read once.
+	struct LargePageConfig
+	{
+		TransparentHugePageMode transparentMode;
+		size_t			hugePageSize;
+		bool			hasHugeTlbPool; // hugetlbfs knows hugePageSize at all.
+	};
+
+	static const LargePageConfig& large_page_config() noexcept
+	{
+		static const LargePageConfig cached = [] {
+			const LargePageInfo info = query_large_page_info();
+			const size_t	    size = pmd_page_size();
+
+			const HugePagePool* pools = info.pools;
+			return LargePageConfig{
+				.transparentMode = info.transparentMode,
+				.hugePageSize	 = size,
+				.hasHugeTlbPool	 = std::any_of(pools, pools + info.poolCount, [&](const HugePagePool& p) { return p.pageSize == size; }),
+			};
+		}();
+		return cached;
+	}
+
+	static bool transparent_huge_pages_enabled(TransparentHugePageMode mode) noexcept
+	{
+		return mode == TransparentHugePageMode::Madvise || mode == TransparentHugePageMode::Always;
+	}
+
+	// mmap only guarantees page alignment, over-reserve and trim to get a huge page aligned range.
+	static void* reserve_aligned(size_t size, size_t alignment) noexcept
+	{
+		const size_t pageSize	 = get_system_page_size();
+		const size_t paddedSize = size + alignment - pageSize;
+
+		void* padded = ::mmap(nullptr, paddedSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(padded == MAP_FAILED)
+		{
+			return MAP_FAILED;
+		}
+
+		const uintptr_t begin	= reinterpret_cast<uintptr_t>(padded);
+		const uintptr_t aligned = (begin + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		const size_t	head	= aligned - begin;
+		const size_t	tail	= paddedSize - head - size;
+
+		if(head)
+		{
+			(void)::munmap(padded, head);
+		}
+		if(tail)
+		{
+			(void)::munmap(reinterpret_cast<void*>(aligned + size), tail);
+		}
+
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	size_t get_system_page_size() noexcept
 	{
 		// If the page size is not retrievable no allocators will work
 		// and the whole application will crash spectacularly.
@@ -63,18 +170,104 @@ namespace opus3d::foundation
 		return cached;
 	}
 
-	Result<std::optional<size_t>> get_system_large_page_size()
+	Result<std::optional<size_t>> get_system_large_page_size() noexcept
 	{
-		// Under the "consumer distro / no privileges" policy, we do not promise a fixed hugepage size.
-		// THP is kernel-controlled and can vary; MAP_HUGETLB requires configuration/privileges.
+		const LargePageConfig& config = large_page_config();
+
+		if(transparent_huge_pages_enabled(config.transparentMode) || config.hasHugeTlbPool)
+		{
+			return std::optional<size_t>{config.hugePageSize};
+		}
+
 		return std::optional<size_t>{std::nullopt};
 	}
 
-	Result<void*> reserve_pages(size_t size, MemoryPageSize pageSize)
+	LargePageInfo query_large_page_info() noexcept
+	{
+		LargePageInfo info;
+
+		info.transparentMode = read_thp_mode();
+		if(info.transparentMode != TransparentHugePageMode::Unsupported)
+		{
+			info.transparentPageSize = pmd_page_size();
+		}
+
+		// One directory per configured hugetlbfs size, named "hugepages-<size>kB".
+		if(DIR* dir = ::opendir("/sys/kernel/mm/hugepages"); dir)
+		{
+			while(const dirent* entry = ::readdir(dir))
+			{
+				unsigned long long sizeKb = 0;
+				if(info.poolCount == std::size(info.pools) || std::sscanf(entry->d_name, "hugepages-%llukB", &sizeKb) != 1)
+				{
+					continue;
+				}
+
+				char path[320];
+				std::snprintf(path, sizeof(path), "/sys/kernel/mm/hugepages/%s/free_hugepages", entry->d_name);
+
+				const HugePagePool pool{.pageSize = static_cast<size_t>(sizeKb) * 1024, .freePages = read_sys_size(path)};
+
+				// Directory order is arbitrary, keep the pools sorted by page size.
+				uint32_t slot = info.poolCount++;
+				for(; slot > 0 && info.pools[slot - 1].pageSize > pool.pageSize; --slot)
+				{
+					info.pools[slot] = info.pools[slot - 1];
+				}
+				info.pools[slot] = pool;
+			}
+			::closedir(dir);
+		}
+
+		return info;
+	}
+
+	Result<void*> reserve_pages(size_t size, MemoryPageSize pageSize) noexcept
+	{
+		PageBacking obtained;
+		return reserve_pages(size, pageSize, obtained);
+	}
+
+	Result<void*> reserve_pages(size_t size, MemoryPageSize pageSize, PageBacking& obtained) noexcept
 	{
 		assert(size > 0);
 		assert(size % get_system_page_size() == 0);
 
+		if(pageSize == MemoryPageSize::Large)
+		{
+			const LargePageConfig& config = large_page_config();
+
+			// Explicit huge pages are charged to the pool at mmap time, so this fails cleanly
+			// instead of faulting later when the pool is too small.
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+			if(config.hasHugeTlbPool && size % config.hugePageSize == 0)
+			{
+				const int hugeFlags = MAP_HUGETLB | (std::countr_zero(config.hugePageSize) << MAP_HUGE_SHIFT);
+
+				if(void* result = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | hugeFlags, -1, 0); result != MAP_FAILED)
+				{
+					obtained = PageBacking::HugeTlb;
+					return result;
+				}
+			}
+#endif
+
+			if(transparent_huge_pages_enabled(config.transparentMode))
+			{
+				void* result = reserve_aligned(size, config.hugePageSize);
+
+				if(result == MAP_FAILED)
+				{
+					return errno_error();
+				}
+
+				linux_try_enable_thp(result, size);
+
+				obtained = PageBacking::TransparentHuge;
+				return result;
+			}
+		}
+
 		void* result = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 
 		if(result == MAP_FAILED)
@@ -82,15 +275,11 @@ namespace opus3d::foundation
 			return errno_error();
 		}
 
-		if(pageSize == MemoryPageSize::Large)
-		{
-			linux_try_enable_thp(result, size);
-		}
-
+		obtained = PageBacking::Normal;
 		return result;
 	}
 
-	Result<void> release_pages(void* address, size_t size)
+	Result<void> release_pages(void* address, size_t size) noexcept
 	{
 		assert(address != nullptr);
 		assert(size > 0);
@@ -103,7 +292,7 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	Result<void> set_committed_page_access(void* address, size_t size, MemoryAccess access)
+	Result<void> set_committed_page_access(void* address, size_t size, MemoryAccess access) noexcept
 	{
 		assert(address != nullptr);
 		assert(size > 0);
@@ -118,7 +307,7 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	Result<void> set_committed_page_noaccess(void* address, size_t size, GuardMode /*mode*/)
+	Result<void> set_committed_page_noaccess(void* address, size_t size, GuardMode /*mode*/) noexcept
 	{
 		// Linux "guard" is equivalent to PROT_NONE.
 		assert(address != nullptr);
@@ -133,13 +322,13 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	Result<void> commit_pages(void* address, size_t size, MemoryAccess access)
+	Result<void> commit_pages(void* address, size_t size, MemoryAccess access) noexcept
 	{
 		// Linux doesn't have an explicit "commit"; mprotect to a non-NONE protection makes it usable.
 		return set_committed_page_access(address, size, access);
 	}
 
-	Result<void> decommit_pages(void* address, size_t size)
+	Result<void> decommit_pages(void* address, size_t size) noexcept
 	{
 		assert(address != nullptr);
 		assert(size > 0);
@@ -159,35 +348,123 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	Result<void*> allocate_pages(size_t size, MemoryAccess access)
+	Result<void> discard_pages(void* address, size_t size) noexcept
 	{
-		auto reserved = reserve_pages(size, MemoryPageSize::Normal);
-		if(!reserved)
-			return Unexpected(reserved.error());
+		assert(address != nullptr);
+		assert(size > 0);
+		assert(size % get_system_page_size() == 0);
 
-		auto committed = commit_pages(reserved.value(), size, access);
-		if(!committed)
+		// Private anonymous pages are zero-filled again on the next touch.
+		if(::madvise(address, size, MADV_DONTNEED) != 0)
 		{
-			// Avoid leaks if commit fails
-			(void)release_pages(reserved.value(), size);
-			return Unexpected(committed.error());
+			return errno_error();
 		}
 
-		return reserved.value();
+		return {};
 	}
 
-	Result<void*> map_file(NativeFileHandle openFileHandle, size_t fileSize, MemoryAccess access)
+	Result<void*> allocate_pages(size_t size, MemoryAccess access) noexcept
 	{
-		assert(openFileHandle.valid());
+		assert(size > 0);
+		assert(size % get_system_page_size() == 0);
+
+		// Reserve and commit in one go, there is nothing to gain from two syscalls here.
+		void* result = ::mmap(nullptr, size, to_posix_protection(access), MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if(result == MAP_FAILED)
+		{
+			return errno_error();
+		}
+
+		return result;
+	}
+
+	Result<void*> remap_pages(void* address, size_t oldSize, size_t newSize) noexcept
+	{
+		assert(address != nullptr);
+		assert(oldSize > 0 && newSize > 0);
+		assert(oldSize % get_system_page_size() == 0 && newSize % get_system_page_size() == 0);
+
+		// The kernel moves the page table entries, the contents are never copied.
+		void* result = ::mremap(address, oldSize, newSize, MREMAP_MAYMOVE);
+
+		if(result == MAP_FAILED)
+		{
+			return errno_error();
+		}
+
+		return result;
+	}
+
+	Result<void> advise_pages(void* address, size_t size, MemoryAccessPattern pattern) noexcept
+	{
+		assert(address != nullptr);
+		assert(reinterpret_cast<uintptr_t>(address) % get_system_page_size() == 0);
+
+		int advice = MADV_NORMAL;
+		if(pattern == MemoryAccessPattern::Sequential)
+		{
+			advice = MADV_SEQUENTIAL;
+		}
+		else if(pattern == MemoryAccessPattern::Random)
+		{
+			advice = MADV_RANDOM;
+		}
+
+		if(::madvise(address, size, advice) != 0)
+		{
+			return errno_error();
+		}
+
+		return {};
+	}
+
+	Result<void> prefetch_pages(void* address, size_t size) noexcept
+	{
+		assert(address != nullptr);
+		assert(reinterpret_cast<uintptr_t>(address) % get_system_page_size() == 0);
+
+		// Schedules read-ahead for file backed pages and returns immediately.
+		if(::madvise(address, size, MADV_WILLNEED) != 0)
+		{
+			return errno_error();
+		}
+
+		return {};
+	}
+
+	Result<size_t> get_file_size(NativeFileHandle openFileHandle) noexcept
+	{
+		assert(openFileHandle != NativeFileHandleInvalid);
+
+		struct stat info;
+		if(::fstat(openFileHandle, &info) != 0)
+		{
+			return errno_error();
+		}
+
+		return static_cast<size_t>(info.st_size);
+	}
+
+	Result<void*> map_file(NativeFileHandle openFileHandle, size_t fileSize, MemoryAccess access, FilePrefault prefault) noexcept
+	{
+		assert(openFileHandle != NativeFileHandleInvalid);
 		assert(fileSize > 0);
 
-		// Expect NativeFileHandle to carry a POSIX fd.
-		const int fd = static_cast<int>(openFileHandle.handle);
+		// NativeFileHandle is a POSIX fd on Linux.
+		const int fd = openFileHandle;
 
 		const int prot = to_posix_protection(access);
 
-		// MAP_PRIVATE is safest default (copy-on-write). If you want shared writes, add a separate API.
-		void* view = ::mmap(nullptr, fileSize, prot, MAP_PRIVATE, fd, 0);
+		// Private so that write access can never modify the file, read-only views share the
+		// page cache either way.
+		int flags = MAP_PRIVATE;
+		if(prefault == FilePrefault::Populate)
+		{
+			flags |= MAP_POPULATE;
+		}
+
+		void* view = ::mmap(nullptr, fileSize, prot, flags, fd, 0);
 
 		if(view == MAP_FAILED)
 		{
@@ -197,8 +474,8 @@ namespace opus3d::foundation
 		return view;
 	}
 
-	Result<void> unmap_file(void* address, size_t size) { return release_pages(address, size); }
+	Result<void> unmap_file(void* address, size_t size) noexcept { return release_pages(address, size); }
 
-} // namespace opus3d::foundation
+} // namespace opus3d::foundation::memory
 
 #endif
\ No newline at end of file
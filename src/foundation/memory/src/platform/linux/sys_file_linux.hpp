@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace opus3d::foundation::memory::detail
+{
+	// Reads a small sysfs or procfs file into buffer and terminates it. Returns the number
+	// of bytes read, 0 if the file does not exist or is empty.
+	inline size_t read_sys_file(const char* path, char* buffer, size_t bufferSize) noexcept
+	{
+		const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+		if(fd < 0)
+		{
+			buffer[0] = '\0';
+			return 0;
+		}
+
+		const ssize_t bytes = ::read(fd, buffer, bufferSize - 1);
+		::close(fd);
+
+		const size_t length = bytes > 0 ? static_cast<size_t>(bytes) : 0;
+		buffer[length]	    = '\0';
+		return length;
+	}
+} // namespace opus3d::foundation::memory::detail
\ No newline at end of file
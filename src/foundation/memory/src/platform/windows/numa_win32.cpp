@@ -0,0 +1,75 @@
+#ifdef _WIN32
+
+#include <foundation/memory/include/numa.hpp>
+
+#include <Windows.h>
+
+#include <algorithm>
+
+namespace opus3d::foundation::memory
+{
+	static NumaTopology read_numa_topology() noexcept
+	{
+		NumaTopology topology;
+
+		// Only processor group 0 is mapped, which covers every machine with up to 64 logical CPUs.
+		topology.cpuCount = std::min<uint32_t>(::GetActiveProcessorCount(0), MaxNumaCpus);
+
+		ULONG highestNode = 0;
+		if(!::GetNumaHighestNodeNumber(&highestNode) || highestNode == 0)
+		{
+			return topology;
+		}
+
+		topology.nodeCount	= std::min<uint32_t>(highestNode + 1, MaxNumaNodes);
+		topology.memoryNodeMask = 0;
+
+		for(uint32_t node = 0; node < topology.nodeCount; ++node)
+		{
+			ULONGLONG available = 0;
+			if(::GetNumaAvailableMemoryNodeEx(static_cast<USHORT>(node), &available) && available > 0)
+			{
+				topology.memoryNodeMask |= uint64_t(1) << node;
+			}
+		}
+		topology.memoryNodeMask = topology.memoryNodeMask ? topology.memoryNodeMask : 1;
+
+		for(uint32_t cpu = 0; cpu < topology.cpuCount; ++cpu)
+		{
+			PROCESSOR_NUMBER processor{.Group = 0, .Number = static_cast<BYTE>(cpu), .Reserved = 0};
+
+			USHORT node = 0;
+			if(::GetNumaProcessorNodeEx(&processor, &node))
+			{
+				topology.cpuToNode[cpu] = static_cast<uint8_t>(node);
+			}
+		}
+
+		return topology;
+	}
+
+	const NumaTopology& numa_topology() noexcept
+	{
+		static const NumaTopology cached = read_numa_topology();
+		return cached;
+	}
+
+	uint32_t current_numa_node() noexcept
+	{
+		PROCESSOR_NUMBER processor{};
+		::GetCurrentProcessorNumberEx(&processor);
+
+		USHORT node = 0;
+		return ::GetNumaProcessorNodeEx(&processor, &node) ? node : 0;
+	}
+
+	// Windows only places memory at allocation time (VirtualAllocExNuma) and has no per
+	// thread policy, both calls degrade to first-touch placement.
+
+	Result<void> apply_numa_policy(void*, size_t, const NumaPolicy&) noexcept { return {}; }
+
+	Result<void> set_thread_numa_policy(const NumaPolicy&) noexcept { return {}; }
+
+} // namespace opus3d::foundation::memory
+
+#endif
\ No newline at end of file
@@ -1,12 +1,13 @@
 #ifdef _WIN32
 
+#include <foundation/memory/include/memory_error.hpp>
 #include <foundation/memory/include/pages.hpp>
 
 #include <Windows.h>
 
 #include <cassert>
 
-namespace opus3d::foundation
+namespace opus3d::foundation::memory
 {
 	static Unexpected<ErrorCode> last_error(const ErrorDomain& domain = error_domains::System)
 	{
@@ -87,20 +88,41 @@ namespace opus3d::foundation
 		return std::optional<size_t>(std::nullopt);
 	}
 
+	LargePageInfo query_large_page_info() noexcept
+	{
+		LargePageInfo info;
+
+		// Windows large pages are always explicit, there is no transparent mode.
+		if(const size_t pageSize = GetLargePageMinimum(); pageSize > 0)
+		{
+			info.pools[0]  = HugePagePool{.pageSize = pageSize, .freePages = 0};
+			info.poolCount = 1;
+		}
+
+		return info;
+	}
+
 	Result<void*> reserve_pages(size_t size, MemoryPageSize pageSize) noexcept
+	{
+		PageBacking obtained;
+		return reserve_pages(size, pageSize, obtained);
+	}
+
+	Result<void*> reserve_pages(size_t size, MemoryPageSize /*pageSize*/, PageBacking& obtained) noexcept
 	{
 		assert(size > 0);
 		assert(size % get_system_page_size() == 0);
 
-		const DWORD flags = MEM_RESERVE | ((pageSize == MemoryPageSize::Large) ? MEM_LARGE_PAGES : 0);
-
-		void* result = VirtualAlloc(nullptr, size, flags, PAGE_NOACCESS);
+		// MEM_LARGE_PAGES needs MEM_COMMIT and SeLockMemoryPrivilege, neither fits a
+		// reserve-then-commit range, so Large reservations use normal pages here.
+		void* result = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
 
 		if(result == nullptr)
 		{
 			return last_error();
 		}
 
+		obtained = PageBacking::Normal;
 		return result;
 	}
 
@@ -131,6 +153,20 @@ namespace opus3d::foundation
 		return {};
 	}
 
+	Result<void> discard_pages(void* address, size_t size) noexcept
+	{
+		assert(address);
+		assert(size);
+
+		// MEM_RESET keeps the pages committed but lets the OS drop them instead of paging out.
+		if(VirtualAlloc(address, size, MEM_RESET, PAGE_NOACCESS) == nullptr)
+		{
+			return last_error();
+		}
+
+		return {};
+	}
+
 	Result<void*> allocate_pages(size_t size, MemoryAccess access) noexcept
 	{
 		if(Result reserved = reserve_pages(size); reserved.has_value())
@@ -151,6 +187,12 @@ namespace opus3d::foundation
 		}
 	}
 
+	Result<void*> remap_pages(void*, size_t, size_t) noexcept
+	{
+		// Windows has no equivalent of mremap, callers fall back to allocate + copy.
+		return Unexpected(create_memory_error(MemoryErrorCode::PlatformUnsupported));
+	}
+
 	Result<void> release_pages(void* address, size_t size) noexcept
 	{
 
@@ -195,25 +237,62 @@ namespace opus3d::foundation
 		return {};
 	}
 
-	Result<void*> map_file(NativeFileHandle openFileHandle, size_t fileSize, MemoryAccess access) noexcept
+	Result<void> advise_pages(void* address, size_t size, MemoryAccessPattern /*pattern*/) noexcept
 	{
-		assert(openFileHandle.valid());
+		// Windows takes access pattern hints per file handle (FILE_FLAG_SEQUENTIAL_SCAN etc.),
+		// not per mapping, so there is nothing to do here.
+		assert(address != nullptr);
+		assert(size > 0);
+
+		return {};
+	}
+
+	Result<void> prefetch_pages(void* address, size_t size) noexcept
+	{
+		assert(address != nullptr);
+		assert(size > 0);
+
+		WIN32_MEMORY_RANGE_ENTRY range{.VirtualAddress = address, .NumberOfBytes = size};
+		if(!::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0))
+		{
+			return last_error();
+		}
+
+		return {};
+	}
+
+	Result<size_t> get_file_size(NativeFileHandle openFileHandle) noexcept
+	{
+		assert(openFileHandle != NativeFileHandleInvalid);
+
+		LARGE_INTEGER size{};
+		if(!::GetFileSizeEx(static_cast<HANDLE>(openFileHandle), &size))
+		{
+			return last_error();
+		}
+
+		return static_cast<size_t>(size.QuadPart);
+	}
+
+	Result<void*> map_file(NativeFileHandle openFileHandle, size_t fileSize, MemoryAccess access, FilePrefault prefault) noexcept
+	{
+		assert(openFileHandle != NativeFileHandleInvalid);
 		assert(fileSize > 0);
 
-		HANDLE file = static_cast<HANDLE>(openFileHandle.handle);
+		HANDLE file = static_cast<HANDLE>(openFileHandle);
+
+		// Write access is copy-on-write, matching MAP_PRIVATE on Linux.
+		const bool  writable   = has_flag(access, MemoryAccess::Write);
+		const DWORD protection = writable ? PAGE_WRITECOPY : to_win32_page_protection(access);
+		const DWORD viewAccess = writable ? FILE_MAP_COPY : to_win32_map_access(access);
 
-		HANDLE mapping = ::CreateFileMappingW(file,
-						      nullptr,
-						      to_win32_page_protection(access),
-						      static_cast<DWORD>(fileSize >> 32),
-						      static_cast<DWORD>(fileSize & 0xFFFFFFFF),
-						      nullptr);
+		HANDLE mapping = ::CreateFileMappingW(file, nullptr, protection, static_cast<DWORD>(fileSize >> 32), static_cast<DWORD>(fileSize & 0xFFFFFFFF), nullptr);
 		if(!mapping)
 		{
 			return last_error();
 		}
 
-		void* view = MapViewOfFile(mapping, to_win32_map_access(access), 0, 0, fileSize);
+		void* view = MapViewOfFile(mapping, viewAccess, 0, 0, fileSize);
 
 		const DWORD mapError = view ? ERROR_SUCCESS : ::GetLastError();
 
@@ -225,6 +304,12 @@ namespace opus3d::foundation
 			return Unexpected(ErrorCode::create(error_domains::System, mapError));
 		}
 
+		// There is no MAP_POPULATE, prefetching the whole view is the closest match.
+		if(prefault == FilePrefault::Populate)
+		{
+			static_cast<void>(prefetch_pages(view, fileSize));
+		}
+
 		return view;
 	}
 
@@ -240,6 +325,6 @@ namespace opus3d::foundation
 		return {};
 	}
 
-} // namespace opus3d::foundation
+} // namespace opus3d::foundation::memory
 
 #endif
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include <foundation/memory/include/pool_allocator.hpp>
+
+#include <foundation/memory/include/alignment.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include <bit>
+#include <utility>
+
+namespace opus3d::foundation::memory
+{
+	Result<PoolAllocator> PoolAllocator::create(size_t blockSize, size_t blockAlignment, size_t maxBlocks, NumaPolicy numa) noexcept
+	{
+		ASSERT_MSG(blockSize > 0 && maxBlocks > 0, "PoolAllocator needs a block size and a block count");
+		ASSERT_MSG(std::has_single_bit(blockAlignment), "PoolAllocator alignment must be a power of two");
+		ASSERT_MSG(blockAlignment <= get_system_page_size(), "PoolAllocator alignment can not exceed the page size");
+
+		// Free blocks store the free list link inside themselves.
+		const size_t alignment = std::max(blockAlignment, alignof(FreeBlock));
+		const size_t stride    = align_up(std::max(blockSize, sizeof(FreeBlock)), alignment);
+
+		if(Result<VirtualRange> range = VirtualRange::reserve(stride * maxBlocks, MemoryPageSize::Normal, numa); range.has_value())
+		{
+			PoolAllocator pool;
+			pool.m_range	 = std::move(range.value());
+			pool.m_stride	 = stride;
+			pool.m_alignment = alignment;
+			return pool;
+		}
+		else
+		{
+			return Unexpected(range.error());
+		}
+	}
+
+	PoolAllocator::PoolAllocator(PoolAllocator&& other) noexcept :
+		m_range(std::move(other.m_range)), m_freeList(std::exchange(other.m_freeList, nullptr)), m_carved(std::exchange(other.m_carved, 0)),
+		m_stride(other.m_stride), m_alignment(other.m_alignment), m_liveBlocks(std::exchange(other.m_liveBlocks, 0)),
+		m_peakLiveBlocks(std::exchange(other.m_peakLiveBlocks, 0))
+	{}
+
+	PoolAllocator& PoolAllocator::operator=(PoolAllocator&& other) noexcept
+	{
+		if(this != &other)
+		{
+			m_range		 = std::move(other.m_range);
+			m_freeList	 = std::exchange(other.m_freeList, nullptr);
+			m_carved	 = std::exchange(other.m_carved, 0);
+			m_stride	 = other.m_stride;
+			m_alignment	 = other.m_alignment;
+			m_liveBlocks	 = std::exchange(other.m_liveBlocks, 0);
+			m_peakLiveBlocks = std::exchange(other.m_peakLiveBlocks, 0);
+		}
+		return *this;
+	}
+
+	void PoolAllocator::release_all(bool decommit) noexcept
+	{
+		m_freeList	 = nullptr;
+		m_carved	 = 0;
+		m_liveBlocks	 = 0;
+		m_peakLiveBlocks = 0;
+
+		if(decommit && m_range.size() > 0)
+		{
+			// Failing to hand pages back is not fatal, the pool simply stays committed.
+			static_cast<void>(m_range.shrink(m_range.size()));
+		}
+	}
+
+	PoolAllocatorStats PoolAllocator::stats() const noexcept
+	{
+		return PoolAllocatorStats{
+			.blockSize	= m_stride,
+			.liveBlocks	= m_liveBlocks,
+			.peakLiveBlocks = m_peakLiveBlocks,
+			.carvedBlocks	= m_carved / m_stride,
+			.maxBlocks	= max_blocks(),
+			.committedBytes = m_range.size(),
+		};
+	}
+
+	Result<void*> PoolAllocator::try_allocate_slab() noexcept
+	{
+		ASSERT_MSG(m_range.data(), "Allocating from an unreserved PoolAllocator!");
+
+		const size_t committed = m_range.size();
+		const size_t capacity  = m_range.capacity();
+
+		if(m_carved + m_stride > capacity)
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+
+		const size_t wanted    = std::max(m_carved + m_stride, committed + SlabSize);
+		const size_t newCommit = std::min(align_up(wanted, get_system_page_size()), capacity);
+
+		if(Result<void> grow = m_range.grow(newCommit - committed); !grow.has_value())
+		{
+			return Unexpected(grow.error());
+		}
+
+		std::byte* block = m_range.data() + m_carved;
+		m_carved += m_stride;
+		return on_allocated(block);
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,67 @@
+#include <foundation/memory/include/scratch_arena.hpp>
+
+namespace opus3d::foundation::memory
+{
+	namespace
+	{
+		struct ThreadScratch
+		{
+			LinearAllocator arenas[2] = {LinearAllocator(ScratchArenaReserveSize, ScratchArenaRetainedCommit),
+						     LinearAllocator(ScratchArenaReserveSize, ScratchArenaRetainedCommit)};
+		};
+
+		// Overrides installed by bind_thread_scratch_arenas(), empty means "use the thread's own".
+		thread_local ScratchArenaSet t_bound;
+
+		// The thread's own arenas once they exist.
+		thread_local ThreadScratch* t_own = nullptr;
+
+		ScratchArenaSet thread_arenas() noexcept
+		{
+			if(t_bound.arenas[0])
+			{
+				return t_bound;
+			}
+
+			// Reserved on first use so threads that never need scratch memory pay nothing.
+			if(!t_own)
+			{
+				thread_local ThreadScratch scratch;
+				t_own = &scratch;
+			}
+			return ScratchArenaSet{{&t_own->arenas[0], &t_own->arenas[1]}};
+		}
+	} // namespace
+
+	LinearAllocator& thread_scratch_arena(const LinearAllocator* conflict) noexcept
+	{
+		const ScratchArenaSet set = thread_arenas();
+
+		if(set.arenas[0] != conflict)
+		{
+			return *set.arenas[0];
+		}
+
+		ASSERT_MSG(set.arenas[1], "Scratch arena set has only one arena!");
+		return *set.arenas[1];
+	}
+
+	ScratchArenaSet bind_thread_scratch_arenas(ScratchArenaSet arenas) noexcept
+	{
+		DEBUG_ASSERT_MSG(arenas.arenas[0] || !arenas.arenas[1], "Bind the first arena before the second!");
+
+		const ScratchArenaSet previous = t_bound;
+		t_bound			       = arenas;
+		return previous;
+	}
+
+	bool is_thread_scratch_arena(const LinearAllocator* arena) noexcept
+	{
+		// Never reserves the arenas, a thread without them owns none.
+		if(t_bound.arenas[0])
+		{
+			return arena == t_bound.arenas[0] || arena == t_bound.arenas[1];
+		}
+		return t_own && (arena == &t_own->arenas[0] || arena == &t_own->arenas[1]);
+	}
+} // namespace opus3d::foundation::memory
\ No newline at end of file
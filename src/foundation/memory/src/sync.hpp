@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace opus3d::foundation::memory::detail
+{
+	// Lock for short critical sections on paths that must not allocate. Contended waiters
+	// sleep in atomic wait instead of spinning. Constant initialized, usable in constinit
+	// globals that outlive every thread.
+	struct SpinLock
+	{
+		std::atomic<bool> locked{false};
+
+		void lock() noexcept
+		{
+			while(locked.exchange(true, std::memory_order_acquire))
+			{
+				locked.wait(true, std::memory_order_relaxed);
+			}
+		}
+
+		void unlock() noexcept
+		{
+			locked.store(false, std::memory_order_release);
+			locked.notify_one();
+		}
+	};
+
+	// Raises target to value if it is lower, for relaxed peak counters.
+	inline void atomic_max(std::atomic<uint64_t>& target, uint64_t value) noexcept
+	{
+		uint64_t current = target.load(std::memory_order_relaxed);
+		while(value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed))
+		{
+		}
+	}
+} // namespace opus3d::foundation::memory::detail
\ No newline at end of file
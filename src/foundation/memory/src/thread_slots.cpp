@@ -0,0 +1,53 @@
+#include "thread_slots.hpp"
+
+#include <atomic>
+#include <bit>
+
+namespace opus3d::foundation::memory::detail
+{
+	namespace
+	{
+		static_assert(MaxThreadSlots <= 64);
+
+		// Bit i is set while some thread owns slot i.
+		std::atomic<uint64_t> g_usedThreadSlots{0};
+
+		struct ThreadSlot
+		{
+			uint32_t index = MaxThreadSlots;
+
+			ThreadSlot() noexcept
+			{
+				uint64_t used = g_usedThreadSlots.load(std::memory_order_relaxed);
+				while(~used != 0)
+				{
+					const uint32_t free = static_cast<uint32_t>(std::countr_one(used));
+					if(free >= MaxThreadSlots)
+					{
+						break;
+					}
+
+					if(g_usedThreadSlots.compare_exchange_weak(used, used | (uint64_t(1) << free), std::memory_order_acquire))
+					{
+						index = free;
+						break;
+					}
+				}
+			}
+
+			~ThreadSlot()
+			{
+				if(index < MaxThreadSlots)
+				{
+					g_usedThreadSlots.fetch_and(~(uint64_t(1) << index), std::memory_order_release);
+				}
+			}
+		};
+	} // namespace
+
+	uint32_t current_thread_slot() noexcept
+	{
+		thread_local ThreadSlot slot;
+		return slot.index;
+	}
+} // namespace opus3d::foundation::memory::detail
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace opus3d::foundation::memory::detail
+{
+	// Threads that hold a slot own index [0, MaxThreadSlots) exclusively until they exit,
+	// at which point the slot is handed to the next thread that asks. Allocators use it
+	// to give each thread private, single-writer state without any per-allocator TLS.
+	inline constexpr uint32_t MaxThreadSlots = 64;
+
+	// Returns MaxThreadSlots when every slot is taken.
+	uint32_t current_thread_slot() noexcept;
+} // namespace opus3d::foundation::memory::detail
\ No newline at end of file
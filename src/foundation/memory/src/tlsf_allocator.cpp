@@ -0,0 +1,460 @@
+#include <foundation/memory/include/tlsf_allocator.hpp>
+
+#include <foundation/memory/include/alignment.hpp>
+#include <foundation/memory/include/memory_error.hpp>
+#include <foundation/memory/include/pages.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <utility>
+
+namespace opus3d::foundation::memory
+{
+	namespace
+	{
+		// Bytes in front of the payload of a live block.
+		constexpr size_t HeaderSize = 16;
+
+		// A free block must hold its list links.
+		constexpr size_t MinPayloadSize = 16;
+		constexpr size_t MinBlockSize	= HeaderSize + MinPayloadSize;
+	} // namespace
+
+	// Header in front of every block. The free list links overlap the payload, so a
+	// live block only pays for prevPhysical and the size.
+	struct TlsfAllocator::BlockHeader
+	{
+		static constexpr size_t FreeBit	    = 1;
+		static constexpr size_t PrevFreeBit = 2;
+
+		BlockHeader* prevPhysical; // Only valid while the previous block is free.
+		size_t	     sizeAndFlags;
+		BlockHeader* nextFree;
+		BlockHeader* prevFree;
+
+		size_t size() const noexcept { return sizeAndFlags & ~(FreeBit | PrevFreeBit); }
+		void   set_size(size_t size) noexcept { sizeAndFlags = size | (sizeAndFlags & (FreeBit | PrevFreeBit)); }
+
+		bool is_free() const noexcept { return sizeAndFlags & FreeBit; }
+		bool is_prev_free() const noexcept { return sizeAndFlags & PrevFreeBit; }
+
+		void set_free(bool free) noexcept { sizeAndFlags = free ? sizeAndFlags | FreeBit : sizeAndFlags & ~FreeBit; }
+		void set_prev_free(bool free) noexcept { sizeAndFlags = free ? sizeAndFlags | PrevFreeBit : sizeAndFlags & ~PrevFreeBit; }
+
+		std::byte*   payload() noexcept { return reinterpret_cast<std::byte*>(this) + HeaderSize; }
+		BlockHeader* next_physical() noexcept { return reinterpret_cast<BlockHeader*>(payload() + size()); }
+
+		static BlockHeader* from_payload(const void* ptr) noexcept
+		{
+			return reinterpret_cast<BlockHeader*>(static_cast<std::byte*>(const_cast<void*>(ptr)) - HeaderSize);
+		}
+
+		// Marks the block free and tells its physical successor about it.
+		void mark_free() noexcept
+		{
+			set_free(true);
+			BlockHeader* next  = next_physical();
+			next->prevPhysical = this;
+			next->set_prev_free(true);
+		}
+
+		void mark_used() noexcept
+		{
+			set_free(false);
+			next_physical()->set_prev_free(false);
+		}
+	};
+
+	static size_t adjust_request_size(size_t size) noexcept
+	{
+		return align_up(std::max(size, MinPayloadSize), TlsfAllocator::MinAlignment);
+	}
+
+	// The first level is the power of two of the size, the second level splits that power
+	// into SlIndexCount linear bins. Sizes below SmallBlockSize all live in first level 0.
+	void TlsfAllocator::mapping_insert(size_t size, uint32_t& fl, uint32_t& sl) noexcept
+	{
+		if(size < SmallBlockSize)
+		{
+			fl = 0;
+			sl = static_cast<uint32_t>(size / (SmallBlockSize / SlIndexCount));
+		}
+		else
+		{
+			const uint32_t msb = static_cast<uint32_t>(std::bit_width(size)) - 1;
+			sl		   = static_cast<uint32_t>(size >> (msb - SlIndexCountLog2)) ^ SlIndexCount;
+			fl		   = msb - (FlIndexShift - 1);
+		}
+	}
+
+	size_t TlsfAllocator::round_up_to_bin(size_t size) noexcept
+	{
+		if(size >= SmallBlockSize)
+		{
+			size += (size_t(1) << (std::bit_width(size) - 1 - SlIndexCountLog2)) - 1;
+		}
+		return size;
+	}
+
+	Result<TlsfAllocator> TlsfAllocator::create(size_t reservedBytes) noexcept
+	{
+		static_assert(offsetof(BlockHeader, nextFree) == HeaderSize);
+		static_assert(sizeof(BlockHeader) == MinBlockSize);
+
+		if(Result<VirtualRange> range = VirtualRange::reserve(reservedBytes); range.has_value())
+		{
+			TlsfAllocator tlsf;
+			tlsf.m_range = std::move(range.value());
+			return tlsf;
+		}
+		else
+		{
+			return Unexpected(range.error());
+		}
+	}
+
+	TlsfAllocator::TlsfAllocator(TlsfAllocator&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	TlsfAllocator& TlsfAllocator::operator=(TlsfAllocator&& other) noexcept
+	{
+		if(this != &other)
+		{
+			// Blocks point into the range, not at the allocator, so the lists move as-is.
+			m_range		 = std::move(other.m_range);
+			m_sentinel	 = std::exchange(other.m_sentinel, nullptr);
+			m_flBitmap	 = std::exchange(other.m_flBitmap, 0);
+			m_usedBytes	 = std::exchange(other.m_usedBytes, 0);
+			m_freeBytes	 = std::exchange(other.m_freeBytes, 0);
+			m_freeBlockCount = std::exchange(other.m_freeBlockCount, 0);
+			m_liveBlockCount = std::exchange(other.m_liveBlockCount, 0);
+
+			std::memcpy(m_slBitmap, other.m_slBitmap, sizeof(m_slBitmap));
+			std::memcpy(m_freeLists, other.m_freeLists, sizeof(m_freeLists));
+			std::memset(other.m_slBitmap, 0, sizeof(other.m_slBitmap));
+			std::memset(other.m_freeLists, 0, sizeof(other.m_freeLists));
+		}
+		return *this;
+	}
+
+	Result<void*> TlsfAllocator::try_allocate(size_t size, size_t alignment) noexcept
+	{
+		DEBUG_ASSERT(std::has_single_bit(alignment));
+
+		if(size > m_range.capacity())
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+
+		const size_t payloadSize = adjust_request_size(size);
+
+		// Over-aligned requests search for enough slack to cut a free block off the front.
+		const size_t searchSize = alignment > MinAlignment ? payloadSize + alignment + MinBlockSize : payloadSize;
+
+		BlockHeader* block = find_free_block(searchSize);
+		if(!block)
+		{
+			// The search only looks at bins whose every block fits, the new block has to
+			// reach the rounded size or it lands in a bin below and is never found.
+			if(Result<void> grow = grow_heap(round_up_to_bin(searchSize) + HeaderSize); !grow.has_value())
+			{
+				return Unexpected(grow.error());
+			}
+
+			block = find_free_block(searchSize);
+			if(!block)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+			}
+		}
+
+		remove_free_block(block);
+
+		if(alignment > MinAlignment)
+		{
+			const uintptr_t payload = reinterpret_cast<uintptr_t>(block->payload());
+			uintptr_t	aligned = align_up(payload, alignment);
+
+			// The cut off front must be able to stand as a free block on its own.
+			if(aligned != payload && aligned - payload < MinBlockSize)
+			{
+				aligned = align_up(payload + MinBlockSize, alignment);
+			}
+
+			if(const size_t gap = aligned - payload; gap != 0)
+			{
+				BlockHeader* front = block;
+				block		   = BlockHeader::from_payload(reinterpret_cast<void*>(aligned));
+
+				block->sizeAndFlags = 0;
+				block->set_size(front->size() - gap);
+				front->set_size(gap - HeaderSize);
+
+				front->mark_free();
+				insert_free_block(front);
+			}
+		}
+
+		block->mark_used();
+		trim_live_block(block, payloadSize);
+
+		m_usedBytes += block->size();
+		++m_liveBlockCount;
+
+		return block->payload();
+	}
+
+	void TlsfAllocator::deallocate(void* ptr) noexcept
+	{
+		if(!ptr)
+		{
+			return;
+		}
+
+		BlockHeader* block = BlockHeader::from_payload(ptr);
+		DEBUG_ASSERT_MSG(!block->is_free(), "Double free in TlsfAllocator!");
+
+		m_usedBytes -= block->size();
+		--m_liveBlockCount;
+
+		block->mark_free();
+		insert_free_block(merge_with_neighbours(block));
+	}
+
+	Result<void*> TlsfAllocator::try_resize(void* ptr, size_t, size_t newSize, size_t) noexcept
+	{
+		ASSERT_MSG(ptr, "Resizing a null block!");
+
+		// The pointer does not move, so its alignment is already satisfied.
+		BlockHeader* block	 = BlockHeader::from_payload(ptr);
+		const size_t payloadSize = adjust_request_size(newSize);
+		const size_t oldSize	 = block->size();
+
+		if(payloadSize > oldSize)
+		{
+			BlockHeader* next      = block->next_physical();
+			const size_t available = next->is_free() ? oldSize + HeaderSize + next->size() : oldSize;
+
+			// The last block, or the one before the trailing free block, can grow into
+			// freshly committed pages.
+			if(available < payloadSize && (next == m_sentinel || (next->is_free() && next->next_physical() == m_sentinel)))
+			{
+				static_cast<void>(grow_heap(payloadSize - available));
+				next = block->next_physical();
+			}
+
+			if(!next->is_free() || oldSize + HeaderSize + next->size() < payloadSize)
+			{
+				return Unexpected(create_memory_error(MemoryErrorCode::ResizeNotInPlace));
+			}
+
+			remove_free_block(next);
+			block->set_size(oldSize + HeaderSize + next->size());
+			block->mark_used();
+		}
+
+		trim_live_block(block, payloadSize);
+
+		m_usedBytes += block->size();
+		m_usedBytes -= oldSize;
+
+		return ptr;
+	}
+
+	size_t TlsfAllocator::usable_size(const void* ptr) const noexcept
+	{
+		return BlockHeader::from_payload(ptr)->size();
+	}
+
+	TlsfStats TlsfAllocator::stats() const noexcept
+	{
+		TlsfStats stats{
+			.usedBytes	= m_usedBytes,
+			.freeBytes	= m_freeBytes,
+			.freeBlockCount = m_freeBlockCount,
+			.liveBlockCount = m_liveBlockCount,
+			.committedBytes = m_range.size(),
+			.capacity	= m_range.capacity(),
+		};
+
+		// The largest block lives in the highest non-empty bin.
+		if(m_flBitmap != 0)
+		{
+			const uint32_t fl = static_cast<uint32_t>(std::bit_width(m_flBitmap)) - 1;
+			const uint32_t sl = static_cast<uint32_t>(std::bit_width(m_slBitmap[fl])) - 1;
+
+			for(const BlockHeader* block = m_freeLists[fl][sl]; block; block = block->nextFree)
+			{
+				stats.largestFreeBlock = std::max(stats.largestFreeBlock, block->size());
+			}
+		}
+
+		return stats;
+	}
+
+	void TlsfAllocator::insert_free_block(BlockHeader* block) noexcept
+	{
+		uint32_t fl = 0;
+		uint32_t sl = 0;
+		mapping_insert(block->size(), fl, sl);
+
+		BlockHeader* head = m_freeLists[fl][sl];
+		block->nextFree	  = head;
+		block->prevFree	  = nullptr;
+		if(head)
+		{
+			head->prevFree = block;
+		}
+
+		m_freeLists[fl][sl] = block;
+		m_flBitmap |= 1u << fl;
+		m_slBitmap[fl] |= 1u << sl;
+
+		m_freeBytes += block->size();
+		++m_freeBlockCount;
+	}
+
+	void TlsfAllocator::remove_free_block(BlockHeader* block) noexcept
+	{
+		uint32_t fl = 0;
+		uint32_t sl = 0;
+		mapping_insert(block->size(), fl, sl);
+
+		if(block->nextFree)
+		{
+			block->nextFree->prevFree = block->prevFree;
+		}
+
+		if(block->prevFree)
+		{
+			block->prevFree->nextFree = block->nextFree;
+		}
+		else
+		{
+			m_freeLists[fl][sl] = block->nextFree;
+
+			if(!block->nextFree)
+			{
+				m_slBitmap[fl] &= ~(1u << sl);
+				if(m_slBitmap[fl] == 0)
+				{
+					m_flBitmap &= ~(1u << fl);
+				}
+			}
+		}
+
+		m_freeBytes -= block->size();
+		--m_freeBlockCount;
+	}
+
+	TlsfAllocator::BlockHeader* TlsfAllocator::find_free_block(size_t size) noexcept
+	{
+		uint32_t fl = 0;
+		uint32_t sl = 0;
+		mapping_insert(round_up_to_bin(size), fl, sl);
+
+		if(fl >= FlIndexCount)
+		{
+			return nullptr;
+		}
+
+		uint32_t slMap = m_slBitmap[fl] & (~0u << sl);
+		if(slMap == 0)
+		{
+			// Nothing in this first level, take the smallest bin of a larger one.
+			const uint32_t flMap = fl + 1 < 32 ? m_flBitmap & (~0u << (fl + 1)) : 0;
+			if(flMap == 0)
+			{
+				return nullptr;
+			}
+
+			fl    = static_cast<uint32_t>(std::countr_zero(flMap));
+			slMap = m_slBitmap[fl];
+		}
+
+		return m_freeLists[fl][std::countr_zero(slMap)];
+	}
+
+	TlsfAllocator::BlockHeader* TlsfAllocator::merge_with_neighbours(BlockHeader* block) noexcept
+	{
+		if(block->is_prev_free())
+		{
+			BlockHeader* prev = block->prevPhysical;
+			remove_free_block(prev);
+			prev->set_size(prev->size() + HeaderSize + block->size());
+			block = prev;
+		}
+
+		// The sentinel is never free, so this always stops at the end of the heap.
+		if(BlockHeader* next = block->next_physical(); next->is_free())
+		{
+			remove_free_block(next);
+			block->set_size(block->size() + HeaderSize + next->size());
+		}
+
+		block->next_physical()->prevPhysical = block;
+		return block;
+	}
+
+	void TlsfAllocator::trim_live_block(BlockHeader* block, size_t size) noexcept
+	{
+		if(block->size() < size + MinBlockSize)
+		{
+			return;
+		}
+
+		BlockHeader* rest  = reinterpret_cast<BlockHeader*>(block->payload() + size);
+		rest->sizeAndFlags = 0;
+		rest->set_size(block->size() - size - HeaderSize);
+		block->set_size(size);
+
+		rest->mark_free();
+		insert_free_block(merge_with_neighbours(rest));
+	}
+
+	Result<void> TlsfAllocator::grow_heap(size_t minBytes) noexcept
+	{
+		ASSERT_MSG(m_range.data(), "Allocating from an unreserved TlsfAllocator!");
+
+		const size_t committed = m_range.size();
+		const size_t capacity  = m_range.capacity();
+
+		// The first commit also pays for the leading block header and the sentinel.
+		const size_t wanted    = committed + std::max(minBytes + (m_sentinel ? 0 : 2 * HeaderSize), CommitChunkSize);
+		const size_t newCommit = std::min(align_up(wanted, get_system_page_size()), capacity);
+
+		if(newCommit < committed + MinBlockSize + (m_sentinel ? 0 : HeaderSize))
+		{
+			return Unexpected(create_memory_error(MemoryErrorCode::OutOfMemory));
+		}
+
+		if(Result<void> grow = m_range.grow(newCommit - committed); !grow.has_value())
+		{
+			return grow;
+		}
+
+		// The old sentinel becomes the header of the new block.
+		BlockHeader* block = m_sentinel;
+		if(!block)
+		{
+			block		    = reinterpret_cast<BlockHeader*>(m_range.data());
+			block->prevPhysical = nullptr;
+			block->sizeAndFlags = 0;
+		}
+
+		std::byte* end = m_range.data() + newCommit;
+		block->set_size(static_cast<size_t>(end - HeaderSize - block->payload()));
+
+		m_sentinel		 = reinterpret_cast<BlockHeader*>(end - HeaderSize);
+		m_sentinel->sizeAndFlags = 0;
+
+		block->mark_free();
+		insert_free_block(merge_with_neighbours(block));
+
+		return {};
+	}
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include <foundation/core/include/assert.hpp>
+#include <foundation/memory/include/pages.hpp>
+#include <foundation/memory/include/tracking_allocator.hpp>
+
+#include "sync.hpp"
+
+#include <atomic>
+#include <cinttypes>
+#include <iterator>
+
+namespace opus3d::foundation::memory
+{
+	namespace
+	{
+		constexpr const char* BuiltinTagNames[] = {"General", "Containers", "Window", "Tasks", "Fibers", "Filesystem", "Engine"};
+		constexpr size_t      FirstUserTag	= static_cast<size_t>(MemoryTag::User0);
+		constexpr size_t      UserTagCount	= MemoryTagCount - FirstUserTag;
+
+		static_assert(std::size(BuiltinTagNames) == FirstUserTag);
+
+		constinit std::atomic<const char*> g_userTagNames[UserTagCount]{};
+	} // namespace
+
+	const char* memory_tag_name(MemoryTag tag) noexcept
+	{
+		const size_t index = static_cast<size_t>(tag);
+		ASSERT(index < MemoryTagCount);
+
+		if(index < FirstUserTag)
+		{
+			return BuiltinTagNames[index];
+		}
+
+		constexpr const char* DefaultUserNames[] = {"User0", "User1", "User2", "User3", "User4", "User5", "User6", "User7"};
+		static_assert(std::size(DefaultUserNames) == UserTagCount);
+
+		const char* name = g_userTagNames[index - FirstUserTag].load(std::memory_order_acquire);
+		return name ? name : DefaultUserNames[index - FirstUserTag];
+	}
+
+	void set_memory_tag_name(MemoryTag tag, const char* name) noexcept
+	{
+		const size_t index = static_cast<size_t>(tag);
+		ASSERT_MSG(index >= FirstUserTag && index < MemoryTagCount, "Only user memory tags can be renamed");
+
+		g_userTagNames[index - FirstUserTag].store(name, std::memory_order_release);
+	}
+
+#if FOUNDATION_MEMORY_TRACKING
+
+	namespace
+	{
+		struct alignas(64) TagCounters
+		{
+			std::atomic<uint64_t> liveBytes{0};
+			std::atomic<uint64_t> peakBytes{0};
+			std::atomic<uint64_t> liveAllocations{0};
+			std::atomic<uint64_t> totalAllocations{0};
+			std::atomic<uint64_t> frameAllocations{0};
+			std::atomic<uint64_t> lastFrameAllocations{0};
+			std::atomic<uint64_t> sizeHistogram[MemorySizeBucketCount]{};
+
+			void add_live_bytes(uint64_t bytes) noexcept
+			{
+				detail::atomic_max(peakBytes, liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+			}
+		};
+
+		constinit TagCounters g_tags[MemoryTagCount];
+
+		TagCounters& counters(MemoryTag tag) noexcept
+		{
+			DEBUG_ASSERT(static_cast<size_t>(tag) < MemoryTagCount);
+			return g_tags[static_cast<size_t>(tag)];
+		}
+
+		// Live block registry, only needed to list leaks. Nodes come straight from the page
+		// allocator so the registry never recurses into an allocator it might be tracking,
+		// and it is never torn down so blocks freed during static destruction are fine.
+		struct LiveBlock
+		{
+			const void* address;
+			size_t	    size;
+			LiveBlock*  next;
+			MemoryTag   tag;
+		};
+
+		constexpr size_t ShardCount	    = 16;
+		constexpr size_t BucketsPerShard    = 4096;
+		constexpr size_t ShardReserveBytes  = 64 * 1024 * 1024;
+		constexpr size_t ShardCommitBytes   = 64 * 1024;
+
+		struct alignas(64) RegistryShard
+		{
+			detail::SpinLock mutex;
+			LiveBlock*	 freeList      = nullptr;
+			std::byte*	 base	       = nullptr;
+			size_t		 carved	       = 0;
+			size_t		 committed     = 0;
+			bool		 reserveFailed = false;
+			LiveBlock*	 buckets[BucketsPerShard]{};
+
+			LiveBlock* allocate_node() noexcept
+			{
+				if(LiveBlock* node = freeList; node)
+				{
+					freeList = node->next;
+					return node;
+				}
+
+				if(!base && !reserveFailed)
+				{
+					Result<void*> reserved = reserve_pages(ShardReserveBytes);
+					reserveFailed	       = !reserved.has_value();
+					base		       = reserveFailed ? nullptr : static_cast<std::byte*>(reserved.value());
+				}
+
+				if(!base)
+				{
+					return nullptr;
+				}
+
+				if(carved + sizeof(LiveBlock) > committed)
+				{
+					if(committed + ShardCommitBytes > ShardReserveBytes ||
+					   !commit_pages(base + committed, ShardCommitBytes, MemoryAccess::ReadWrite).has_value())
+					{
+						return nullptr;
+					}
+					committed += ShardCommitBytes;
+				}
+
+				LiveBlock* node = reinterpret_cast<LiveBlock*>(base + carved);
+				carved += sizeof(LiveBlock);
+				return node;
+			}
+		};
+
+		constinit RegistryShard g_shards[ShardCount];
+
+		// Blocks that could not be registered, they still count in the tag totals.
+		constinit std::atomic<uint64_t> g_untrackedBlocks{0};
+
+		size_t block_hash(const void* address) noexcept
+		{
+			const uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address)) * 0x9E3779B97F4A7C15ull;
+			return static_cast<size_t>(h >> 32);
+		}
+
+		void register_block(MemoryTag tag, const void* address, size_t size) noexcept
+		{
+			const size_t   hash  = block_hash(address);
+			RegistryShard& shard = g_shards[hash % ShardCount];
+
+			shard.mutex.lock();
+			if(LiveBlock* node = shard.allocate_node(); node)
+			{
+				LiveBlock*& head = shard.buckets[(hash / ShardCount) % BucketsPerShard];
+
+				*node = LiveBlock{.address = address, .size = size, .next = head, .tag = tag};
+				head  = node;
+			}
+			else
+			{
+				g_untrackedBlocks.fetch_add(1, std::memory_order_relaxed);
+			}
+			shard.mutex.unlock();
+		}
+
+		// Blocks that never made it into the registry are simply not found.
+		void unregister_block(const void* address) noexcept
+		{
+			const size_t   hash  = block_hash(address);
+			RegistryShard& shard = g_shards[hash % ShardCount];
+
+			shard.mutex.lock();
+			for(LiveBlock** link = &shard.buckets[(hash / ShardCount) % BucketsPerShard]; *link; link = &(*link)->next)
+			{
+				if(LiveBlock* node = *link; node->address == address)
+				{
+					*link	       = node->next;
+					node->next     = shard.freeList;
+					shard.freeList = node;
+					break;
+				}
+			}
+			shard.mutex.unlock();
+		}
+	} // namespace
+
+	namespace detail
+	{
+		void track_allocate(MemoryTag tag, void* ptr, size_t size) noexcept
+		{
+			TagCounters& c = counters(tag);
+
+			c.add_live_bytes(size);
+			c.liveAllocations.fetch_add(1, std::memory_order_relaxed);
+			c.totalAllocations.fetch_add(1, std::memory_order_relaxed);
+			c.frameAllocations.fetch_add(1, std::memory_order_relaxed);
+			c.sizeHistogram[memory_size_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+
+			register_block(tag, ptr, size);
+		}
+
+		void track_deallocate(MemoryTag tag, void* ptr, size_t size) noexcept
+		{
+			if(!ptr)
+			{
+				return;
+			}
+
+			TagCounters& c = counters(tag);
+
+			c.liveBytes.fetch_sub(size, std::memory_order_relaxed);
+			c.liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+
+			unregister_block(ptr);
+		}
+
+		void track_resize(MemoryTag tag, void* oldPtr, void* newPtr, size_t oldSize, size_t newSize) noexcept
+		{
+			TagCounters& c = counters(tag);
+
+			if(newSize >= oldSize)
+			{
+				c.add_live_bytes(newSize - oldSize);
+			}
+			else
+			{
+				c.liveBytes.fetch_sub(oldSize - newSize, std::memory_order_relaxed);
+			}
+
+			unregister_block(oldPtr);
+			register_block(tag, newPtr, newSize);
+		}
+	} // namespace detail
+
+	MemoryTagStats memory_tag_stats(MemoryTag tag) noexcept
+	{
+		const TagCounters& c = counters(tag);
+
+		MemoryTagStats stats;
+		stats.liveBytes		   = c.liveBytes.load(std::memory_order_relaxed);
+		stats.peakBytes		   = c.peakBytes.load(std::memory_order_relaxed);
+		stats.liveAllocations	   = c.liveAllocations.load(std::memory_order_relaxed);
+		stats.totalAllocations	   = c.totalAllocations.load(std::memory_order_relaxed);
+		stats.frameAllocations	   = c.frameAllocations.load(std::memory_order_relaxed);
+		stats.lastFrameAllocations = c.lastFrameAllocations.load(std::memory_order_relaxed);
+
+		for(size_t i = 0; i < MemorySizeBucketCount; ++i)
+		{
+			stats.sizeHistogram[i] = c.sizeHistogram[i].load(std::memory_order_relaxed);
+		}
+
+		return stats;
+	}
+
+	void memory_tracking_begin_frame() noexcept
+	{
+		for(TagCounters& c : g_tags)
+		{
+			c.lastFrameAllocations.store(c.frameAllocations.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+	}
+
+	size_t for_each_memory_leak(MemoryLeakFn fn, void* user) noexcept
+	{
+		size_t count = 0;
+
+		for(RegistryShard& shard : g_shards)
+		{
+			shard.mutex.lock();
+			for(LiveBlock* head : shard.buckets)
+			{
+				for(LiveBlock* node = head; node; node = node->next)
+				{
+					if(fn)
+					{
+						fn(user, MemoryLeak{.address = node->address, .size = node->size, .tag = node->tag});
+					}
+					++count;
+				}
+			}
+			shard.mutex.unlock();
+		}
+
+		return count;
+	}
+
+	void write_memory_report(std::FILE* out) noexcept
+	{
+		if(!out)
+		{
+			return;
+		}
+
+		std::fputs("Memory report:\n", out);
+		std::fprintf(out, "  %-12s %14s %14s %12s %12s %12s\n", "Tag", "Live bytes", "Peak bytes", "Live allocs", "Total allocs", "Last frame");
+
+		for(size_t i = 0; i < MemoryTagCount; ++i)
+		{
+			const MemoryTag	     tag   = static_cast<MemoryTag>(i);
+			const MemoryTagStats stats = memory_tag_stats(tag);
+
+			if(stats.totalAllocations == 0)
+			{
+				continue;
+			}
+
+			std::fprintf(out,
+				     "  %-12s %14" PRIu64 " %14" PRIu64 " %12" PRIu64 " %12" PRIu64 " %12" PRIu64 "\n",
+				     memory_tag_name(tag),
+				     stats.liveBytes,
+				     stats.peakBytes,
+				     stats.liveAllocations,
+				     stats.totalAllocations,
+				     stats.lastFrameAllocations);
+		}
+
+		// Long leak lists are cut short, the per-tag table above still has the totals.
+		struct LeakPrinter
+		{
+			std::FILE* out;
+			size_t	   printed;
+		};
+
+		constexpr size_t MaxPrintedLeaks = 64;
+
+		std::fputs("Live blocks:\n", out);
+
+		LeakPrinter  printer{out, 0};
+		const size_t leaks = for_each_memory_leak(
+			[](void* user, const MemoryLeak& leak) noexcept {
+				LeakPrinter* p = static_cast<LeakPrinter*>(user);
+				if(p->printed++ < MaxPrintedLeaks)
+				{
+					std::fprintf(p->out, "  %p %zu bytes [%s]\n", leak.address, leak.size, memory_tag_name(leak.tag));
+				}
+			},
+			&printer);
+
+		if(leaks > MaxPrintedLeaks)
+		{
+			std::fprintf(out, "  ... and %zu more\n", leaks - MaxPrintedLeaks);
+		}
+
+		std::fprintf(out, "Leaked blocks: %zu\n", leaks);
+
+		if(const uint64_t untracked = g_untrackedBlocks.load(std::memory_order_relaxed); untracked != 0)
+		{
+			std::fprintf(out, "Blocks missing from the leak list: %" PRIu64 "\n", untracked);
+		}
+	}
+
+#endif
+
+} // namespace opus3d::foundation::memory
\ No newline at end of file
@@ -6,16 +6,63 @@
 #include <foundation/core/include/assert.hpp>
 
 #include <algorithm>
+#include <chrono>
+#include <utility>
 
-namespace opus3d::foundation
+namespace opus3d::foundation::memory
 {
+	namespace
+	{
+		// Committed size after a grow that needs at least required bytes committed.
+		size_t grow_commit_target(const CommitPolicy& policy, size_t committed, size_t required, size_t granularity, size_t capacity) noexcept
+		{
+			size_t target = std::max(required, committed + policy.minCommitChunk);
+
+			if(policy.growthPercent != 0)
+			{
+				target = std::max(target, committed + committed / 100 * policy.growthPercent);
+			}
+
+			return std::min(align_up(target, granularity), capacity);
+		}
+
+		// Committed size after a shrink to logical bytes, never above what is committed.
+		size_t shrink_commit_target(const CommitPolicy& policy, size_t committed, size_t logical, size_t granularity) noexcept
+		{
+			const size_t keep = logical + std::min(policy.decommitSlack, committed - logical);
+			return std::min(align_up(keep, granularity), committed);
+		}
+
+		// Adds the lifetime of the scope to the stats' syscall time.
+		class SyscallTimer
+		{
+		public:
+
+			explicit SyscallTimer(CommitStats& stats) noexcept : m_stats(stats), m_start(std::chrono::steady_clock::now()) {}
+
+			~SyscallTimer() noexcept
+			{
+				const auto elapsed = std::chrono::steady_clock::now() - m_start;
+				m_stats.syscallNanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+			}
+
+		private:
+
+			CommitStats&			      m_stats;
+			std::chrono::steady_clock::time_point m_start;
+		};
+	} // namespace
+
 	VirtualRange::VirtualRange(VirtualRange&& other) noexcept :
-		m_base(other.m_base), m_committedSize(other.m_committedSize), m_logicalSize(other.m_logicalSize), m_reservedSize(other.m_reservedSize)
+		m_base(other.m_base), m_committedSize(other.m_committedSize), m_reservedSize(other.m_reservedSize), m_logicalSize(other.m_logicalSize),
+		m_commitGranularity(other.m_commitGranularity), m_backing(other.m_backing), m_policy(other.m_policy), m_stats(std::exchange(other.m_stats, {}))
 	{
-		other.m_base	      = nullptr;
-		other.m_committedSize = 0;
-		other.m_logicalSize   = 0;
-		other.m_reservedSize  = 0;
+		other.m_base		  = nullptr;
+		other.m_committedSize	  = 0;
+		other.m_logicalSize	  = 0;
+		other.m_reservedSize	  = 0;
+		other.m_commitGranularity = 0;
+		other.m_backing		  = PageBacking::Normal;
 	}
 
 	VirtualRange::~VirtualRange() noexcept { reset(); }
@@ -30,21 +77,43 @@ namespace opus3d::foundation
 			m_committedSize = std::exchange(other.m_committedSize, 0);
 			m_logicalSize	= std::exchange(other.m_logicalSize, 0);
 			m_reservedSize	= std::exchange(other.m_reservedSize, 0);
+
+			m_commitGranularity = std::exchange(other.m_commitGranularity, 0);
+			m_backing	    = std::exchange(other.m_backing, PageBacking::Normal);
+
+			m_policy = other.m_policy;
+			m_stats	 = std::exchange(other.m_stats, {});
 		}
 
 		return *this;
 	}
 
-	Result<VirtualRange> VirtualRange::reserve(size_t maxSize) noexcept
+	Result<VirtualRange> VirtualRange::reserve(size_t maxSize, MemoryPageSize pageSize, NumaPolicy numa) noexcept
 	{
-		// Align up to the closest page system boundary value.
-		const size_t pageAlignedMaxSize = align_up(maxSize, get_system_page_size());
+		// Align up to the closest page boundary, huge pages need the whole range in huge pages.
+		size_t granularity = get_system_page_size();
+
+		if(pageSize == MemoryPageSize::Large)
+		{
+			if(Result<std::optional<size_t>> large = get_system_large_page_size(); large.has_value() && large.value().has_value())
+			{
+				granularity = std::max(granularity, *large.value());
+			}
+		}
+
+		const size_t alignedMaxSize = align_up(maxSize, granularity);
 
-		if(Result reserve = reserve_pages(pageAlignedMaxSize, MemoryPageSize::Normal); reserve.has_value())
+		PageBacking backing = PageBacking::Normal;
+		if(Result<void*> reserve = reserve_pages(alignedMaxSize, pageSize, backing); reserve.has_value())
 		{
+			// Nothing has been touched yet, so every page lands where the policy says.
+			static_cast<void>(apply_numa_policy(reserve.value(), alignedMaxSize, numa));
+
 			VirtualRange range;
-			range.m_base	     = static_cast<std::byte*>(reserve.value());
-			range.m_reservedSize = pageAlignedMaxSize;
+			range.m_base		  = static_cast<std::byte*>(reserve.value());
+			range.m_reservedSize	  = alignedMaxSize;
+			range.m_backing		  = backing;
+			range.m_commitGranularity = backing == PageBacking::Normal ? get_system_page_size() : granularity;
 			return range;
 		}
 		else
@@ -62,24 +131,27 @@ namespace opus3d::foundation
 		// Assert that we do not try to grow beyond capacity.
 		ASSERT(deltaSize <= m_reservedSize - m_logicalSize);
 
-		const size_t pageSize	      = get_system_page_size();
 		const size_t oldCommittedSize = m_committedSize;
-		const size_t newCommittedSize = align_up(newLogicalSize, pageSize);
 
-		if(newCommittedSize > oldCommittedSize)
+		if(newLogicalSize > oldCommittedSize)
 		{
-			void*	     commitAddr	   = m_base + oldCommittedSize;
-			const size_t bytesToCommit = newCommittedSize - oldCommittedSize;
+			const size_t newCommittedSize = grow_commit_target(m_policy, oldCommittedSize, newLogicalSize, m_commitGranularity, m_reservedSize);
+			void*	     commitAddr	      = m_base + oldCommittedSize;
+			const size_t bytesToCommit    = newCommittedSize - oldCommittedSize;
 
+			SyscallTimer timer(m_stats);
 			if(Result<void> commit = commit_pages(commitAddr, bytesToCommit, MemoryAccess::ReadWrite); !commit.has_value())
 			{
 				// Return any OS error.
 				return commit;
 			}
+
+			m_committedSize = newCommittedSize;
+			++m_stats.commits;
+			m_stats.committedBytes += bytesToCommit;
 		}
 
-		m_committedSize = newCommittedSize;
-		m_logicalSize	= newLogicalSize;
+		m_logicalSize = newLogicalSize;
 
 		// Success.
 		return {};
@@ -92,24 +164,27 @@ namespace opus3d::foundation
 		// Assert that we do not try to shrink beyond zero pages.
 		ASSERT(deltaSize <= m_logicalSize);
 
-		const size_t pageSize	      = get_system_page_size();
 		const size_t newLogicalSize   = m_logicalSize - deltaSize;
 		const size_t oldCommittedSize = m_committedSize;
-		const size_t newCommittedSize = align_up(newLogicalSize, pageSize);
+		const size_t newCommittedSize = shrink_commit_target(m_policy, oldCommittedSize, newLogicalSize, m_commitGranularity);
 
 		if(newCommittedSize < oldCommittedSize)
 		{
 			const size_t bytesToDecommit = oldCommittedSize - newCommittedSize;
 			void*	     decommitAddr    = m_base + newCommittedSize;
 
+			SyscallTimer timer(m_stats);
 			if(Result<void> decommit = decommit_pages(decommitAddr, bytesToDecommit); !decommit.has_value())
 			{
 				return decommit;
 			}
+
+			m_committedSize = newCommittedSize;
+			++m_stats.decommits;
+			m_stats.decommittedBytes += bytesToDecommit;
 		}
 
-		m_committedSize = newCommittedSize;
-		m_logicalSize	= newLogicalSize;
+		m_logicalSize = newLogicalSize;
 
 		return {};
 	}
@@ -123,10 +198,12 @@ namespace opus3d::foundation
 				panic("VirtualRange::reset", release.error());
 			}
 
-			m_base		= nullptr;
-			m_committedSize = 0;
-			m_logicalSize	= 0;
-			m_reservedSize	= 0;
+			m_base		    = nullptr;
+			m_committedSize	    = 0;
+			m_logicalSize	    = 0;
+			m_reservedSize	    = 0;
+			m_commitGranularity = 0;
+			m_backing	    = PageBacking::Normal;
 		}
 	}
 
@@ -142,6 +219,9 @@ namespace opus3d::foundation
 			m_usableReservedSize = std::exchange(other.m_usableReservedSize, 0);
 			m_rwCommittedSize    = std::exchange(other.m_rwCommittedSize, 0);
 			m_logicalSize	     = std::exchange(other.m_logicalSize, 0);
+
+			m_policy = other.m_policy;
+			m_stats	 = std::exchange(other.m_stats, {});
 		}
 
 		return *this;
@@ -196,10 +276,13 @@ namespace opus3d::foundation
 
 		const size_t oldRwCommitted = m_rwCommittedSize;
 		const size_t pageSize	    = get_system_page_size();
-		const size_t newRwCommitted = align_up(newLogicalSize, pageSize);
 
-		if(newRwCommitted > oldRwCommitted)
+		if(newLogicalSize > oldRwCommitted)
 		{
+			const size_t newRwCommitted = grow_commit_target(m_policy, oldRwCommitted, newLogicalSize, pageSize, m_usableReservedSize);
+
+			SyscallTimer timer(m_stats);
+
 			std::byte* oldGuard = m_base + oldRwCommitted;
 			std::byte* newGuard = m_base + newRwCommitted;
 
@@ -227,6 +310,8 @@ namespace opus3d::foundation
 
 			// Finalize state
 			m_rwCommittedSize = newRwCommitted;
+			++m_stats.commits;
+			m_stats.committedBytes += commitSize;
 		}
 
 		m_logicalSize = newLogicalSize;
@@ -241,10 +326,12 @@ namespace opus3d::foundation
 		const size_t pageSize	    = get_system_page_size();
 		const size_t newLogical	    = m_logicalSize - deltaSize;
 		const size_t oldRwCommitted = m_rwCommittedSize;
-		const size_t newRwCommitted = align_up(newLogical, pageSize);
+		const size_t newRwCommitted = shrink_commit_target(m_policy, oldRwCommitted, newLogical, pageSize);
 
 		if(newRwCommitted < oldRwCommitted)
 		{
+			SyscallTimer timer(m_stats);
+
 			std::byte* newGuard = m_base + newRwCommitted;
 
 			// Step A: Protect the new guard page.
@@ -262,6 +349,8 @@ namespace opus3d::foundation
 			}
 
 			m_rwCommittedSize = newRwCommitted;
+			++m_stats.decommits;
+			m_stats.decommittedBytes += bytesToDecommit;
 		}
 
 		m_logicalSize = newLogical;
@@ -287,4 +376,4 @@ namespace opus3d::foundation
 		}
 	}
 
-} // namespace opus3d::foundation
\ No newline at end of file
+} // namespace opus3d::foundation::memory
\ No newline at end of file
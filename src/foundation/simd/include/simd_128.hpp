@@ -170,46 +170,46 @@ namespace opus3d::foundation::simd
 
 		template <int Imm>
 		static inline simd128 shuffle(simd128 a, simd128 b) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, Imm>
 		{
 			static_assert(Imm >= 0 && Imm <= 255);
-			return {traits::shuffle<Imm>(a.v, b.v)};
+			return {traits::template shuffle<Imm>(a.v, b.v)};
 		}
 
 		static inline simd128 splat_x(simd128 v) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, _MM_SHUFFLE(0, 0, 0, 0)>
 		{
-			return {traits::shuffle<_MM_SHUFFLE(0, 0, 0, 0)>(v.v, v.v)};
+			return {traits::template shuffle<_MM_SHUFFLE(0, 0, 0, 0)>(v.v, v.v)};
 		}
 
 		static inline simd128 splat_y(simd128 v) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, _MM_SHUFFLE(1, 1, 1, 1)>
 		{
-			return {traits::shuffle<_MM_SHUFFLE(1, 1, 1, 1)>(v.v, v.v)};
+			return {traits::template shuffle<_MM_SHUFFLE(1, 1, 1, 1)>(v.v, v.v)};
 		}
 
 		static inline simd128 splat_z(simd128 v) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, _MM_SHUFFLE(2, 2, 2, 2)>
 		{
-			return {traits::shuffle<_MM_SHUFFLE(2, 2, 2, 2)>(v.v, v.v)};
+			return {traits::template shuffle<_MM_SHUFFLE(2, 2, 2, 2)>(v.v, v.v)};
 		}
 
 		static inline simd128 splat_w(simd128 v) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, _MM_SHUFFLE(3, 3, 3, 3)>
 		{
-			return {traits::shuffle<_MM_SHUFFLE(3, 3, 3, 3)>(v.v, v.v)};
+			return {traits::template shuffle<_MM_SHUFFLE(3, 3, 3, 3)>(v.v, v.v)};
 		}
 
 		static inline simd128 swap_xy(simd128 v) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, _MM_SHUFFLE(3, 2, 0, 1)>
 		{
-			return {traits::shuffle<_MM_SHUFFLE(3, 2, 0, 1)>(v.v, v.v)};
+			return {traits::template shuffle<_MM_SHUFFLE(3, 2, 0, 1)>(v.v, v.v)};
 		}
 
 		static inline simd128 reverse(simd128 v) noexcept
-			requires detail::concepts::supports_shuffle<T>
+			requires detail::concepts::supports_shuffle<T, _MM_SHUFFLE(3, 2, 1, 0)>
 		{
-			return {traits::shuffle<_MM_SHUFFLE(3, 2, 1, 0)>(v.v, v.v)};
+			return {traits::template shuffle<_MM_SHUFFLE(3, 2, 1, 0)>(v.v, v.v)};
 		}
 
 		// movemask (bit operation)
@@ -40,7 +40,7 @@ namespace opus3d::foundation::simd::detail::concepts
 
 	template <typename T, int Imm>
 	concept supports_shuffle = requires(dispatch_reg_t<T> a) {
-		{ detail::simd_dispatch<T>::shuffle<Imm>(a, a) } -> std::same_as<dispatch_reg_t<T>>;
+		{ detail::simd_dispatch<T>::template shuffle<Imm>(a, a) } -> std::same_as<dispatch_reg_t<T>>;
 	};
 
 	template <typename T>
@@ -16,7 +16,58 @@
 #include <arm_neon.h>
 #endif
 
+#if FOUNDATION_SIMD_X64 && defined(__AVX2__)
+#define FOUNDATION_SIMD_AVX2 1
+#endif
+
+// Lets a function use AVX2 in a build that does not target it. Everything it calls is
+// flattened into it, so templates instantiated there get AVX2 as well. Only call it once
+// cpu_has_avx2() said yes.
+#if FOUNDATION_SIMD_X64 && (defined(__GNUC__) || defined(__clang__))
+#define FOUNDATION_SIMD_TARGET_AVX2 __attribute__((target("avx2"), flatten))
+#elif FOUNDATION_SIMD_X64 && defined(_MSC_VER)
+#include <intrin.h>
+#define FOUNDATION_SIMD_TARGET_AVX2 [[msvc::flatten]]
+#else
+#define FOUNDATION_SIMD_TARGET_AVX2
+#endif
+
 #include <cmath>
 #include <concepts>
 #include <cstdint>
 #include <type_traits>
+
+namespace opus3d::foundation::simd
+{
+	// Hints that ptr is about to be read, the line is pulled into every cache level.
+	inline void prefetch(const void* ptr) noexcept
+	{
+#if FOUNDATION_SIMD_X64
+		_mm_prefetch(static_cast<const char*>(ptr), _MM_HINT_T0);
+#elif defined(_MSC_VER)
+		__prefetch(ptr);
+#else
+		__builtin_prefetch(ptr, 0, 3);
+#endif
+	}
+
+	// True if AVX2 code may run here, the CPU has it and the OS saves the YMM registers.
+	inline bool cpu_has_avx2() noexcept
+	{
+#if FOUNDATION_SIMD_AVX2
+		return true;
+#elif FOUNDATION_SIMD_X64 && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 1);
+		const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5));
+#elif FOUNDATION_SIMD_X64
+		// Checks the OS support too. The init makes it safe before static constructors ran.
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	}
+} // namespace opus3d::foundation::simd
@@ -0,0 +1,85 @@
+#include "../tests/test_framework.hpp"
+
+#include <engine/memory/include/frame_arena_ring.hpp>
+
+#include <cstddef>
+#include <cstring>
+
+namespace opus3d::tests
+{
+	// Verifies that frame allocations land in the current slot, that the ring wraps around and
+	// resets the slot it reuses, and that every finished frame reports its peak.
+	BEGIN_TEST(Engine, Memory, FrameArenaRing)
+	{
+		using namespace engine;
+		using namespace foundation::memory;
+
+		constexpr uint32_t FramesInFlight = 3;
+
+		FrameArenaRing ring;
+		ASSERT_FALSE(ring.initialized());
+		ASSERT_TRUE(ring.initialize(FramesInFlight, 1024 * 1024).has_value());
+		ASSERT_TRUE(ring.initialized());
+		ASSERT_EQ(ring.frames_in_flight(), FramesInFlight);
+		ASSERT_EQ(ring.frame_index(), 0);
+
+		// The first call opens frame 0 in the first slot, there is nothing to close yet.
+		LinearAllocator* firstSlot = &ring.current_arena();
+		ring.begin_frame();
+		ASSERT_TRUE(&ring.current_arena() == firstSlot);
+		ASSERT_EQ(ring.frame_index(), 0);
+		ASSERT_EQ(ring.last_frame_stats().peakBytes, 0);
+
+		LinearAllocator* slots[FramesInFlight] = {};
+		std::byte*	 firsts[FramesInFlight] = {};
+
+		// Frame i allocates (i + 1) * 4 KB from its own slot.
+		for(uint32_t frame = 0; frame < FramesInFlight; ++frame)
+		{
+			slots[frame] = &ring.current_arena();
+			for(uint32_t i = 0; i < frame; ++i)
+			{
+				ASSERT_TRUE(slots[frame] != slots[i]);
+			}
+
+			const size_t bytes = (frame + 1) * 4096;
+			firsts[frame]	   = static_cast<std::byte*>(ring.allocator().allocate(bytes, 16));
+			ASSERT_TRUE(firsts[frame] != nullptr);
+			ASSERT_TRUE(firsts[frame] >= slots[frame]->base() && firsts[frame] < slots[frame]->base() + slots[frame]->capacity());
+			ASSERT_EQ(slots[frame]->used(), bytes);
+			std::memset(firsts[frame], 0xCD, bytes);
+
+			ring.begin_frame();
+
+			ASSERT_EQ(ring.frame_index(), frame + 1);
+			ASSERT_EQ(ring.last_frame_stats().frameIndex, frame);
+			ASSERT_EQ(ring.last_frame_stats().peakBytes, bytes);
+			ASSERT_TRUE(ring.last_frame_stats().committedBytes >= bytes);
+
+			// The finished frame is still in flight, its allocations are untouched.
+			ASSERT_EQ(slots[frame]->used(), bytes);
+		}
+
+		// Back at the first slot, which was reset for the new frame.
+		ASSERT_TRUE(&ring.current_arena() == slots[0]);
+		ASSERT_EQ(ring.current_arena().used(), 0);
+		ASSERT_EQ(ring.current_arena().peak_used(), 0);
+		ASSERT_TRUE(ring.allocator().allocate(64, 16) == firsts[0]);
+		ASSERT_EQ(ring.max_frame_peak(), FramesInFlight * 4096);
+
+		// Peak, not what is live at the frame boundary.
+		LinearAllocator& arena	= ring.current_arena();
+		const size_t	 marker = arena.marker();
+		static_cast<void>(arena.allocate(32 * 1024, 16));
+		arena.reset_to(marker);
+
+		ring.begin_frame();
+		ASSERT_EQ(ring.last_frame_stats().peakBytes, 64 + 32 * 1024);
+		ASSERT_TRUE(&ring.current_arena() == slots[1]);
+		ASSERT_EQ(slots[1]->used(), 0);
+		ASSERT_EQ(ring.max_frame_peak(), 64 + 32 * 1024);
+
+		ring.shutdown();
+		ASSERT_FALSE(ring.initialized());
+	}
+} // namespace opus3d::tests
\ No newline at end of file
@@ -1,15 +1,25 @@
 #include "../tests/test_framework.hpp"
 
+#include <foundation/containers/include/flat_hash_map.hpp>
 #include <foundation/containers/include/vector_dynamic.hpp>
 #include <foundation/containers/include/vector_static.hpp>
 
 #include <foundation/memory/include/heap_allocator.hpp>
+#include <foundation/memory/include/linear_allocator.hpp>
+#include <foundation/memory/include/pool_allocator.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace opus3d::tests
 {
 	// General all purpose allocator
 	// These tests exist for container functionality not allocator <=> container interactions.
-	foundation::HeapAllocator globalHeapAllocator;
+	foundation::memory::HeapAllocator globalHeapAllocator;
 
 	BEGIN_TEST(Foundation, Containers, VectorStatic)
 	{
@@ -43,6 +53,7 @@ namespace opus3d::tests
 	BEGIN_TEST(Foundation, Containers, VectorDynamic)
 	{
 		using namespace foundation;
+		using namespace foundation::memory;
 
 		VectorDynamic<int> numbers(as_allocator(globalHeapAllocator));
 
@@ -71,4 +82,385 @@ namespace opus3d::tests
 		}
 	}
 
+	// Verifies containers work with an allocator type instead of the type-erased Allocator.
+	BEGIN_TEST(Foundation, Containers, StaticAllocator)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		static_assert(ResizableAllocatorType<LinearAllocator>);
+		static_assert(ResizableAllocatorType<HeapAllocator>);
+		static_assert(AllocatorType<PoolAllocator> && !ResizableAllocatorType<PoolAllocator>);
+
+		LinearAllocator arena(16 * 1024 * 1024);
+
+		// The vector is the arena's last block, so every growth extends it in place.
+		VectorDynamic<uint32_t, LinearAllocator&> values(arena);
+		values.push_back(0);
+		const uint32_t* first = values.data();
+		for(uint32_t i = 1; i < 100000; ++i)
+		{
+			values.push_back(i);
+		}
+		ASSERT_TRUE(values.data() == first);
+		ASSERT_EQ(values[99999], 99999u);
+		ASSERT_EQ(arena.used(), values.capacity() * sizeof(uint32_t));
+
+		HeapAllocator heap;
+
+		FlatHashMap<uint32_t, uint32_t, Hash<uint32_t>, HeapAllocator&> map(heap);
+		for(uint32_t key = 0; key < 1000; ++key)
+		{
+			ASSERT_TRUE(map.insert(key, key * 3).has_value());
+		}
+		for(uint32_t key = 0; key < 1000; key += 2)
+		{
+			ASSERT_TRUE(map.erase(key));
+		}
+		for(uint32_t key = 0; key < 1000; ++key)
+		{
+			Result<uint32_t*> found = map.find(key);
+			ASSERT_TRUE(found.has_value());
+			ASSERT_TRUE(key % 2 == 0 ? found.value() == nullptr : *found.value() == key * 3);
+		}
+	}
+
+	// Verifies arena-backed containers skip their frees and abandon their contents in O(1).
+	BEGIN_TEST(Foundation, Containers, ArenaAbandon)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		HeapAllocator	heap;
+		LinearAllocator arena(16 * 1024 * 1024);
+
+		ASSERT_TRUE(has_flag(as_allocator(arena).caps(), AllocatorCaps::NoopFree));
+		ASSERT_FALSE(has_flag(as_allocator(heap).caps(), AllocatorCaps::NoopFree));
+		ASSERT_TRUE(allocator_caps(arena) == AllocatorCaps::NoopFree);
+
+		FlatHashMap<uint32_t, uint32_t> map(as_allocator(arena));
+		for(uint32_t key = 0; key < 10000; ++key)
+		{
+			ASSERT_TRUE(map.insert(key, key).has_value());
+		}
+
+		const size_t used = arena.used();
+		map.abandon();
+		ASSERT_EQ(arena.used(), used);
+		ASSERT_TRUE(map.find(1).value() == nullptr);
+
+		// An abandoned map is empty and usable again.
+		ASSERT_TRUE(map.insert(7, 70).has_value());
+		ASSERT_EQ(*map.find(7).value(), 70u);
+
+		VectorDynamic<uint64_t> values(as_allocator(heap));
+		values.resize(1000);
+		values.abandon();
+		ASSERT_EQ(values.size(), 0u);
+		ASSERT_EQ(values.capacity(), 0u);
+		values.push_back(1);
+		ASSERT_EQ(values[0], 1u);
+	}
+
+	// Verifies that erase/insert churn at a constant size purges tombstones instead of growing.
+	BEGIN_TEST(Foundation, Containers, FlatHashMapTombstonePurge)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		constexpr uint32_t Live	  = 32;
+		constexpr uint32_t Rounds = 20000;
+
+		auto key = [](uint32_t i) { return i * 2654435761u ^ (i >> 3); };
+
+		LinearAllocator arena = std::move(LinearAllocator::create(1024 * 1024).value());
+
+		FlatHashMap<uint32_t, uint32_t>	   ints(as_allocator(arena), Live);
+		FlatHashMap<uint32_t, std::string> strings(as_allocator(arena), Live);
+		for(uint32_t i = 0; i < Live; ++i)
+		{
+			static_cast<void>(ints.insert(key(i), i));
+			static_cast<void>(strings.insert(key(i), std::string(40, char('a' + i % 26))));
+		}
+
+		// Every table lives in the arena, any growth would show up as used bytes.
+		const size_t used = arena.used();
+
+		for(uint32_t i = 0; i < Rounds; ++i)
+		{
+			ASSERT_TRUE(ints.erase(key(i)));
+			ASSERT_TRUE(strings.erase(key(i)));
+			static_cast<void>(ints.insert(key(i + Live), i + Live));
+			static_cast<void>(strings.insert(key(i + Live), std::string(40, char('a' + (i + Live) % 26))));
+		}
+		ASSERT_EQ(arena.used(), used);
+
+		for(uint32_t i = Rounds; i < Rounds + Live; ++i)
+		{
+			ASSERT_EQ(*ints.find(key(i)).value(), i);
+			ASSERT_EQ(strings.find(key(i)).value()->front(), char('a' + i % 26));
+		}
+		ASSERT_TRUE(ints.find(key(Rounds - 1)).value() == nullptr);
+
+		// Growing still works after a purge.
+		for(uint32_t i = 0; i < 1000; ++i)
+		{
+			static_cast<void>(ints.insert(key(Rounds + Live + i), i));
+		}
+		ASSERT_EQ(*ints.find(key(Rounds)).value(), Rounds);
+		ASSERT_EQ(*ints.find(key(Rounds + Live + 999)).value(), uint32_t(999));
+	}
+
+	// Verifies that find_many resolves hits and misses like find, across several batches.
+	BEGIN_TEST(Foundation, Containers, FlatHashMapFindMany)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		LinearAllocator arena = std::move(LinearAllocator::create(256 * 1024).value());
+
+		FlatHashMap<uint32_t, uint32_t> map(as_allocator(arena));
+
+		std::vector<uint32_t>  keys;
+		std::vector<uint32_t*> results(100, nullptr);
+
+		// Empty map, every result is a miss.
+		keys.assign(results.size(), 7);
+		map.find_many(keys, results);
+		for(uint32_t* value : results)
+		{
+			ASSERT_TRUE(value == nullptr);
+		}
+
+		for(uint32_t i = 0; i < 500; i += 2)
+		{
+			static_cast<void>(map.insert(i, i * 3));
+		}
+
+		// Odd keys are missing, the count is not a multiple of the batch size.
+		keys.clear();
+		for(uint32_t i = 0; i < results.size(); ++i)
+		{
+			keys.push_back(i * 5);
+		}
+		map.find_many(keys, results);
+		for(size_t i = 0; i < keys.size(); ++i)
+		{
+			ASSERT_TRUE(results[i] == map.find(keys[i]).value());
+			ASSERT_TRUE(keys[i] % 2 == 1 ? results[i] == nullptr : *results[i] == keys[i] * 3);
+		}
+	}
+
+	// Verifies that 16 and 32 byte probing find the same entries, including in a 16 slot table
+	// where 32 byte loads read the mirrored tail, and that a live map keeps its width when the
+	// default changes until it grows.
+	BEGIN_TEST(Foundation, Containers, FlatHashMapProbeWidths)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		const size_t defaultWidth = flat_hash_map_probe_width();
+		const size_t otherWidth	  = simd::cpu_has_avx2() ? 32 : 16;
+
+		LinearAllocator arena = std::move(LinearAllocator::create(8 * 1024 * 1024).value());
+
+		auto key = [](uint32_t i) { return i * 2654435761u; };
+
+		// Misses compare every candidate key of the 16 slot table once, at either width.
+		size_t smallCompares[2] = {};
+		for(size_t width : {size_t(16), otherWidth})
+		{
+			set_flat_hash_map_probe_width(width);
+
+			FlatHashMap<uint32_t, uint32_t> small(as_allocator(arena), 8);
+			FlatHashMap<uint32_t, uint32_t> large(as_allocator(arena), 4096);
+
+			// The default changes under the live maps, they keep the width they were made with.
+			set_flat_hash_map_probe_width(width == 16 ? otherWidth : 16);
+
+			for(uint32_t round = 0; round < 400; ++round)
+			{
+				// The small map keeps 10 entries in 16 slots while its keys churn.
+				static_cast<void>(small.insert(key(round), round));
+				if(round >= 10)
+				{
+					ASSERT_TRUE(small.erase(key(round - 10)));
+				}
+
+				for(uint32_t i = round * 8; i < round * 8 + 8; ++i)
+				{
+					static_cast<void>(large.insert(key(i), i));
+				}
+				ASSERT_TRUE(large.erase(key(round * 4)));
+
+				for(uint32_t i = round >= 9 ? round - 9 : 0; i <= round; ++i)
+				{
+					ASSERT_EQ(*small.find(key(i)).value(), i);
+				}
+				ASSERT_TRUE(small.find(key(round + 1)).value() == nullptr);
+			}
+
+			for(uint32_t i = 0; i < 400 * 8; ++i)
+			{
+				uint32_t* value = large.find(key(i)).value();
+				ASSERT_TRUE(i % 4 == 0 && i < 400 * 4 ? value == nullptr : *value == i);
+
+				smallCompares[width / 32] += small.probe_length(key(1000 + i)).keyCompares;
+			}
+		}
+		ASSERT_EQ(smallCompares[0], smallCompares[otherWidth / 32]);
+
+		set_flat_hash_map_probe_width(defaultWidth);
+	}
+
+	// Verifies that the default hasher spreads sequential integers over h2 and h1, and that
+	// strings hash by content whatever type holds them.
+	BEGIN_TEST(Foundation, Containers, DefaultHashMixes)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		// 128 sequential IDs, std::hash would give each its own h2 and all the same h1.
+		bool   h2Seen[128] = {};
+		size_t distinctH2  = 0;
+		for(uint32_t id = 0; id < 128; ++id)
+		{
+			const size_t h2 = Hash<uint32_t>{}(id) & 0x7F;
+			distinctH2 += !h2Seen[h2];
+			h2Seen[h2]  = true;
+		}
+		ASSERT_TRUE(distinctH2 > 64);
+
+		LinearAllocator arena = std::move(LinearAllocator::create(1024 * 1024).value());
+
+		FlatHashMap<uint32_t, uint32_t> ids(as_allocator(arena), 12000);
+		for(uint32_t id = 0; id < 12000; ++id)
+		{
+			static_cast<void>(ids.insert(id, id));
+		}
+
+		size_t groups = 0;
+		for(uint32_t id = 0; id < 12000; ++id)
+		{
+			groups += ids.probe_length(id).groups;
+		}
+		ASSERT_TRUE(groups < 12000 * 2);
+
+		// Every length up to two blocks, each hash distinct and equal across string types.
+		const std::string text = "the quick brown fox jumps over the lazy dog";
+		std::vector<size_t> hashes;
+		for(size_t length = 0; length <= 40; ++length)
+		{
+			const std::string prefix = text.substr(0, length);
+			ASSERT_EQ(Hash<std::string>{}(prefix), Hash<std::string_view>{}(std::string_view(text).substr(0, length)));
+			hashes.push_back(Hash<std::string>{}(prefix));
+		}
+		std::sort(hashes.begin(), hashes.end());
+		ASSERT_TRUE(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+	}
+
+	namespace
+	{
+		// Counts hashes, one per probe sequence.
+		size_t g_stringHashCalls = 0;
+
+		struct CountingStringHash
+		{
+			using is_transparent = void;
+
+			size_t operator()(std::string_view text) const noexcept
+			{
+				++g_stringHashCalls;
+				return foundation::hash_bytes(text.data(), text.size());
+			}
+		};
+	} // namespace
+
+	// Verifies try_emplace, find_or_insert and lookups by string_view, each with a single probe.
+	BEGIN_TEST(Foundation, Containers, FlatHashMapEmplaceAndTransparentFind)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		HeapAllocator heap;
+
+		FlatHashMap<std::string, std::string, CountingStringHash, HeapAllocator&> names(heap);
+
+		const std::string key = "entity/42";
+
+		g_stringHashCalls = 0;
+
+		Result<decltype(names)::InsertResult> first = names.try_emplace(key, size_t(3), 'x');
+		ASSERT_TRUE(first.has_value() && first.value().inserted);
+		ASSERT_TRUE(first.value().value == "xxx");
+		ASSERT_EQ(g_stringHashCalls, size_t(1));
+
+		// Present already: nothing is constructed and the argument keeps its contents.
+		std::string other = "other";
+		g_stringHashCalls = 0;
+		Result<decltype(names)::InsertResult> second = names.try_emplace(key, std::move(other));
+		ASSERT_TRUE(second.has_value() && !second.value().inserted);
+		ASSERT_TRUE(second.value().value == "xxx" && other == "other");
+		ASSERT_EQ(g_stringHashCalls, size_t(1));
+
+		// find_or_insert hands out a reference to fill in or update.
+		names.find_or_insert("entity/7").value().value += "seven";
+		names.find_or_insert("entity/7").value().value += "!";
+		ASSERT_TRUE(*names.find(std::string("entity/7")).value() == "seven!");
+
+		// Lookups by view or literal, no std::string is constructed.
+		const std::string_view view = "entity/42";
+		g_stringHashCalls	    = 0;
+		ASSERT_TRUE(*names.find(view).value() == "xxx");
+		ASSERT_TRUE(names.find("entity/43").value() == nullptr);
+		ASSERT_TRUE(names.erase(view));
+		ASSERT_TRUE(!names.erase(view));
+		ASSERT_EQ(g_stringHashCalls, size_t(4));
+		ASSERT_TRUE(names.find(key).value() == nullptr);
+
+		// The default hasher is transparent for strings as well.
+		FlatHashMap<std::string, uint32_t> ids(as_allocator(heap));
+		ASSERT_TRUE(ids.insert("player", 1).has_value());
+		ASSERT_EQ(*ids.find(std::string_view("player")).value(), 1u);
+		ASSERT_EQ(ids.find_or_insert("enemy").value().value, 0u);
+
+		// Fill a table up to the insert that grows it.
+		FlatHashMap<uint32_t, uint32_t> counts(as_allocator(heap));
+		uint32_t			full = 0;
+		for(uint32_t* first = nullptr; full < 1000; ++full)
+		{
+			ASSERT_TRUE(counts.insert(full, full).has_value());
+			if(first && counts.find(0).value() != first)
+			{
+				break;
+			}
+			first = counts.find(0).value();
+		}
+
+		ASSERT_TRUE(full < 1000);
+
+		FlatHashMap<uint32_t, uint32_t> atLimit(as_allocator(heap));
+		for(uint32_t i = 0; i < full; ++i)
+		{
+			static_cast<void>(atLimit.insert(i, i));
+		}
+
+		// Hits at the load limit neither grow nor purge, references stay valid.
+		uint32_t* zero = atLimit.find(0).value();
+		for(uint32_t i = 0; i < full; ++i)
+		{
+			ASSERT_TRUE(!atLimit.find_or_insert(i).value().inserted);
+			ASSERT_TRUE(!atLimit.try_emplace(i, 7u).value().inserted);
+		}
+		ASSERT_TRUE(&atLimit.find_or_insert(0).value().value == zero);
+
+		// The next new key grows the table and still lands where find looks.
+		ASSERT_TRUE(atLimit.try_emplace(full, 7u).value().inserted);
+		ASSERT_EQ(*atLimit.find(full).value(), 7u);
+		for(uint32_t i = 0; i < full; ++i)
+		{
+			ASSERT_EQ(*atLimit.find(i).value(), i);
+		}
+	}
+
 } // namespace opus3d::tests
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "../tests/test_framework.hpp"
 
 #include <foundation/fibers/include/fiber.hpp>
+#include <foundation/fibers/include/fiber_stack_pool.hpp>
 
+#include <cstring>
 #include <memory>
+#include <vector>
 
 namespace opus3d::tests
 {
@@ -287,4 +290,90 @@ namespace opus3d::tests
 		ASSERT_EQ(count, 10000);
 	}
 
+	// Verifies that pooled stacks run fibers and are recycled most recently released first.
+	BEGIN_TEST(Foundation, Fibers, StackPoolReuse)
+	{
+		using namespace opus3d::foundation;
+
+		Result<FiberStackPool> create = FiberStackPool::create(63 * 1024, 8);
+		ASSERT_TRUE(create.has_value());
+		FiberStackPool pool = std::move(create.value());
+
+		ASSERT_EQ(pool.stack_size(), 64 * 1024);
+
+		FiberStack a = pool.acquire();
+		FiberStack b = pool.acquire();
+		ASSERT_TRUE(a.base != b.base);
+
+		int counter = 0;
+		{
+			Fiber fiber(b.base, b.size, [&](auto& self) {
+				char big[32 * 1024];
+				memset(big, 0xAB, sizeof(big));
+				counter++;
+				self.yield();
+				counter++;
+			});
+
+			fiber.resume();
+			fiber.resume();
+			ASSERT_TRUE(fiber.done());
+		}
+		ASSERT_EQ(counter, 2);
+
+		pool.release(a);
+		pool.release(b);
+
+		// LIFO: b was released last, so it comes back first.
+		FiberStack c = pool.acquire();
+		ASSERT_TRUE(c.base == b.base);
+
+		std::vector<FiberStack> stacks{c};
+		for(size_t i = 1; i < pool.max_stacks(); ++i)
+		{
+			Result<FiberStack> stack = pool.try_acquire();
+			ASSERT_TRUE(stack.has_value());
+			stacks.push_back(stack.value());
+		}
+		ASSERT_FALSE(pool.try_acquire().has_value());
+
+		const FiberStackPoolStats stats = pool.stats();
+		ASSERT_EQ(stats.liveStacks, 8);
+		ASSERT_EQ(stats.carvedStacks, 8);
+
+		for(FiberStack stack : stacks)
+		{
+			pool.release(stack);
+		}
+	}
+
+	// Verifies that discarded stacks stay usable.
+	BEGIN_TEST(Foundation, Fibers, StackPoolDiscard)
+	{
+		using namespace opus3d::foundation;
+
+		Result<FiberStackPool> create = FiberStackPool::create(64 * 1024, 2, FiberStackPool::IdlePolicy::DiscardOnRelease);
+		ASSERT_TRUE(create.has_value());
+		FiberStackPool pool = std::move(create.value());
+
+		for(int round = 0; round < 3; ++round)
+		{
+			FiberStack stack = pool.acquire();
+			int	   value = 0;
+
+			Fiber fiber(stack.base, stack.size, [&](auto&) {
+				char big[48 * 1024];
+				memset(big, round, sizeof(big));
+				value = big[100] + 1;
+			});
+			fiber.resume();
+
+			ASSERT_EQ(value, round + 1);
+			pool.release(stack);
+		}
+
+		pool.trim();
+		ASSERT_EQ(pool.stats().carvedStacks, 1);
+	}
+
 } // namespace opus3d::tests
\ No newline at end of file
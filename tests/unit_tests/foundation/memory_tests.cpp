@@ -0,0 +1,903 @@
+#include "../tests/test_framework.hpp"
+
+#include <foundation/containers/include/flat_hash_map.hpp>
+#include <foundation/containers/include/vector_dynamic.hpp>
+
+#include <foundation/memory/include/concurrent_pool_allocator.hpp>
+#include <foundation/memory/include/double_ended_stack_allocator.hpp>
+#include <foundation/memory/include/heap_allocator.hpp>
+#include <foundation/memory/include/linear_allocator.hpp>
+#include <foundation/memory/include/mapped_file.hpp>
+#include <foundation/memory/include/memory_budget.hpp>
+#include <foundation/memory/include/pages.hpp>
+#include <foundation/memory/include/pool_allocator.hpp>
+#include <foundation/memory/include/scratch_arena.hpp>
+#include <foundation/memory/include/tlsf_allocator.hpp>
+#include <foundation/memory/include/tracking_allocator.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace opus3d::tests
+{
+	// Verifies that the linear allocator bumps, aligns, and only commits what it needs.
+	BEGIN_TEST(Foundation, Memory, LinearAllocatorBump)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		Result<LinearAllocator> create = LinearAllocator::create(16 * 1024 * 1024);
+		ASSERT_TRUE(create.has_value());
+
+		LinearAllocator& arena = create.value();
+
+		// Nothing is committed before the first allocation.
+		ASSERT_EQ(arena.committed(), 0);
+		ASSERT_TRUE(arena.capacity() >= 16 * 1024 * 1024);
+
+		void* a = arena.allocate(3, 1);
+		void* b = arena.allocate(16, 16);
+		ASSERT_TRUE(a != nullptr);
+		ASSERT_TRUE(b != nullptr);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % 16, 0);
+		ASSERT_TRUE(static_cast<std::byte*>(b) >= static_cast<std::byte*>(a) + 3);
+
+		// Committed memory is page granular and far below the reservation.
+		ASSERT_TRUE(arena.committed() > 0);
+		ASSERT_TRUE(arena.committed() < arena.capacity());
+		ASSERT_EQ(arena.committed() % get_system_page_size(), 0);
+
+		// The memory must be writable.
+		std::memset(b, 0xAB, 16);
+
+		// Shrinking the last block in place gives the bytes back but keeps the peak.
+		void* large = arena.allocate(1024 * 1024, 16);
+		ASSERT_TRUE(arena.try_resize(large, 1024 * 1024, 16, 16).value() == large);
+		ASSERT_EQ(arena.used(), static_cast<size_t>(static_cast<std::byte*>(large) - arena.base()) + 16);
+		ASSERT_TRUE(arena.peak_used() >= 1024 * 1024);
+	}
+
+	// Verifies markers, peak tracking and decommit above the retained commit.
+	BEGIN_TEST(Foundation, Memory, LinearAllocatorResetAndDecommit)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		const size_t pageSize = get_system_page_size();
+
+		LinearAllocator arena(64 * 1024 * 1024, 0);
+
+		static_cast<void>(arena.allocate(128));
+		const size_t marker = arena.marker();
+
+		// Touch a few megabytes worth of pages.
+		void* big = arena.allocate(4 * 1024 * 1024, pageSize);
+		std::memset(big, 1, 4 * 1024 * 1024);
+
+		ASSERT_TRUE(arena.committed() >= 4 * 1024 * 1024);
+		const size_t peak = arena.used();
+
+		arena.reset_to(marker);
+		ASSERT_EQ(arena.used(), marker);
+		ASSERT_EQ(arena.peak_used(), peak);
+
+		// Retained commit is 0, so only the page holding the live bytes survives.
+		ASSERT_EQ(arena.committed(), pageSize);
+
+		arena.reset();
+		ASSERT_EQ(arena.used(), 0);
+		ASSERT_EQ(arena.committed(), 0);
+
+		// Memory must be usable again after being decommitted.
+		int* v = static_cast<int*>(arena.allocate(sizeof(int), alignof(int)));
+		*v     = 42;
+		ASSERT_EQ(*v, 42);
+	}
+
+	// Verifies that running out of reserved space fails gracefully.
+	BEGIN_TEST(Foundation, Memory, LinearAllocatorOutOfMemory)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		LinearAllocator arena(64 * 1024);
+
+		Result<void*> tooBig = arena.try_allocate(arena.capacity() + 1, 1);
+		ASSERT_FALSE(tooBig.has_value());
+
+		Result<void*> fits = arena.try_allocate(arena.capacity(), 1);
+		ASSERT_TRUE(fits.has_value());
+
+		Allocator allocator = as_allocator(arena);
+		Result<void*> none  = allocator.try_allocate(1, 1);
+		ASSERT_FALSE(none.has_value());
+	}
+
+	// Verifies that scratch scopes nest and rewind the thread arena on exit.
+	BEGIN_TEST(Foundation, Memory, ScratchScopeNesting)
+	{
+		using namespace foundation::memory;
+
+		LinearAllocator& arena = thread_scratch_arena();
+		const size_t	 start = arena.marker();
+
+		{
+			ScratchScope outer;
+			int*	     a = outer.allocate_array<int>(64);
+			a[0]	       = 1;
+
+			const size_t afterOuter = arena.marker();
+
+			{
+				ScratchScope inner;
+				static_cast<void>(inner.allocate(1024));
+				ASSERT_TRUE(arena.marker() > afterOuter);
+			}
+
+			// Inner scope released only its own allocations.
+			ASSERT_EQ(arena.marker(), afterOuter);
+			ASSERT_EQ(a[0], 1);
+		}
+
+		ASSERT_EQ(arena.marker(), start);
+	}
+
+	// Verifies that a conflicting arena makes the scope pick the other thread arena.
+	BEGIN_TEST(Foundation, Memory, ScratchScopeConflict)
+	{
+		using namespace foundation::memory;
+
+		ScratchScope first;
+		ScratchScope second(&first.arena());
+
+		ASSERT_TRUE(&first.arena() != &second.arena());
+
+		// Different threads never share scratch arenas. Asking before the thread has any
+		// reserves nothing.
+		LinearAllocator* otherThreadArena = nullptr;
+		bool		 otherThreadOwns  = true;
+		std::thread([&] {
+			otherThreadOwns	 = is_thread_scratch_arena(&first.arena());
+			otherThreadArena = &thread_scratch_arena();
+			otherThreadOwns	 = otherThreadOwns || is_thread_scratch_arena(&first.arena());
+		}).join();
+		ASSERT_TRUE(otherThreadArena != &first.arena());
+		ASSERT_TRUE(is_thread_scratch_arena(&first.arena()));
+		ASSERT_FALSE(otherThreadOwns);
+	}
+
+	// Verifies both ends allocate towards each other and rewind independently.
+	BEGIN_TEST(Foundation, Memory, DoubleEndedStackRewind)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		const size_t pageSize = get_system_page_size();
+
+		Result<DoubleEndedStackAllocator> create = DoubleEndedStackAllocator::create(1024 * 1024, 0);
+		ASSERT_TRUE(create.has_value());
+		DoubleEndedStackAllocator& stack = create.value();
+
+		std::byte* persistent = static_cast<std::byte*>(stack.allocate(StackEnd::Bottom, 100, 16));
+		std::memset(persistent, 0x11, 100);
+		const size_t bottomMarker = stack.marker(StackEnd::Bottom);
+
+		// Top allocations come from the end of the range, aligned downwards.
+		std::byte* temp = static_cast<std::byte*>(stack.allocate(StackEnd::Top, 3, 64));
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(temp) % 64, 0);
+		ASSERT_TRUE(temp + 3 <= stack.base() + stack.capacity());
+		ASSERT_TRUE(temp > persistent);
+
+		Allocator scratch = as_allocator(stack, StackEnd::Top);
+		Result<void*> decode = scratch.try_allocate(256 * 1024, pageSize);
+		ASSERT_TRUE(decode.has_value());
+		std::memset(decode.value(), 0x22, 256 * 1024);
+		ASSERT_TRUE(stack.committed(StackEnd::Top) >= 256 * 1024);
+
+		// Dropping the temporaries leaves the bottom alone and hands the top pages back.
+		stack.reset(StackEnd::Top);
+		ASSERT_EQ(stack.used(StackEnd::Top), 0);
+		ASSERT_EQ(stack.committed(StackEnd::Top), 0);
+		ASSERT_EQ(stack.marker(StackEnd::Bottom), bottomMarker);
+		ASSERT_TRUE(persistent[99] == std::byte{0x11});
+
+		// The ends meet at the pages the other end has committed.
+		const size_t bottomCommitted = stack.committed(StackEnd::Bottom);
+		ASSERT_TRUE(stack.try_allocate_top(stack.capacity() - bottomCommitted, pageSize).has_value());
+		ASSERT_FALSE(stack.try_allocate_bottom(bottomCommitted, 1).has_value());
+		ASSERT_FALSE(stack.try_allocate_top(pageSize, 1).has_value());
+
+		stack.reset();
+		ASSERT_TRUE(stack.peak_used(StackEnd::Top) >= stack.capacity() - bottomCommitted);
+		ASSERT_EQ(stack.available(), stack.capacity());
+	}
+
+	// Verifies block reuse through the free list and the occupancy stats.
+	BEGIN_TEST(Foundation, Memory, PoolAllocatorReuse)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		Result<PoolAllocator> create = PoolAllocator::create(24, 16, 1024);
+		ASSERT_TRUE(create.has_value());
+
+		PoolAllocator& pool = create.value();
+		ASSERT_EQ(pool.block_size(), 32);
+		ASSERT_EQ(pool.stats().committedBytes, 0);
+
+		void* a = pool.allocate();
+		void* b = pool.allocate();
+		ASSERT_TRUE(a != b);
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % 16, 0);
+		ASSERT_EQ(pool.live_blocks(), 2);
+
+		// The most recently freed block is handed out first.
+		pool.deallocate(a);
+		ASSERT_EQ(pool.allocate(), a);
+
+		pool.release_all(true);
+		ASSERT_EQ(pool.live_blocks(), 0);
+		ASSERT_EQ(pool.stats().peakLiveBlocks, 0);
+		ASSERT_EQ(pool.stats().committedBytes, 0);
+
+		std::memset(pool.allocate(), 0xCD, 32);
+	}
+
+	// Verifies exhaustion and the type-erased Allocator adapter.
+	BEGIN_TEST(Foundation, Memory, PoolAllocatorExhaustion)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		PoolAllocator pool = std::move(PoolAllocator::create(sizeof(uint64_t), alignof(uint64_t), 4).value());
+
+		const size_t maxBlocks = pool.max_blocks();
+		for(size_t i = 0; i < maxBlocks; ++i)
+		{
+			ASSERT_TRUE(pool.try_allocate().has_value());
+		}
+		ASSERT_FALSE(pool.try_allocate().has_value());
+		ASSERT_EQ(pool.stats().carvedBlocks, maxBlocks);
+
+		pool.release_all();
+
+		Allocator allocator = as_allocator(pool);
+		ASSERT_FALSE(allocator.try_allocate(64, 8).has_value());
+
+		uint64_t* v = allocator.make<uint64_t>(7ull);
+		ASSERT_EQ(*v, 7ull);
+		allocator.destroy(v);
+		ASSERT_EQ(pool.live_blocks(), 0);
+	}
+
+	// Verifies that blocks allocated on one thread can be freed on another without loss.
+	BEGIN_TEST(Foundation, Memory, ConcurrentPoolCrossThreadFree)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		constexpr size_t ThreadCount = 4;
+		constexpr size_t PerThread   = 1000;
+
+		ConcurrentPoolAllocator pool = std::move(ConcurrentPoolAllocator::create(sizeof(uint64_t), alignof(uint64_t), ThreadCount * PerThread).value());
+
+		uint64_t* blocks[ThreadCount][PerThread] = {};
+
+		std::thread producers[ThreadCount];
+		for(size_t t = 0; t < ThreadCount; ++t)
+		{
+			producers[t] = std::thread([&, t] {
+				for(size_t i = 0; i < PerThread; ++i)
+				{
+					blocks[t][i]  = static_cast<uint64_t*>(pool.allocate());
+					*blocks[t][i] = t * PerThread + i;
+				}
+			});
+		}
+		for(std::thread& t : producers)
+		{
+			t.join();
+		}
+
+		// Every block is distinct and kept its value.
+		for(size_t t = 0; t < ThreadCount; ++t)
+		{
+			for(size_t i = 0; i < PerThread; ++i)
+			{
+				ASSERT_EQ(*blocks[t][i], t * PerThread + i);
+			}
+		}
+		ASSERT_EQ(pool.stats().liveBlocks, ThreadCount * PerThread);
+
+		// Free each thread's blocks on its neighbour.
+		std::thread consumers[ThreadCount];
+		for(size_t t = 0; t < ThreadCount; ++t)
+		{
+			consumers[t] = std::thread([&, t] {
+				for(uint64_t* block : blocks[(t + 1) % ThreadCount])
+				{
+					pool.deallocate(block);
+				}
+			});
+		}
+		for(std::thread& t : consumers)
+		{
+			t.join();
+		}
+
+		ASSERT_EQ(pool.stats().liveBlocks, 0);
+
+		// Freed blocks are handed out again instead of carving new ones.
+		const size_t carved = pool.stats().carvedBlocks;
+		pool.deallocate(pool.allocate());
+		ASSERT_EQ(pool.stats().carvedBlocks, carved);
+	}
+
+	// Verifies alignment and that freeing everything coalesces back into one block.
+	BEGIN_TEST(Foundation, Memory, TlsfAllocateFree)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		TlsfAllocator tlsf  = std::move(TlsfAllocator::create(64 * 1024 * 1024).value());
+		TlsfAllocator fresh = std::move(TlsfAllocator::create(64 * 1024 * 1024).value());
+
+		void* blocks[64] = {};
+		for(size_t i = 0; i < 64; ++i)
+		{
+			const size_t alignment = size_t(1) << (i % 8);
+			blocks[i]	       = tlsf.allocate(i * 37 + 1, alignment);
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(blocks[i]) % alignment, 0);
+			std::memset(blocks[i], int(i), i * 37 + 1);
+		}
+
+		// Free every other block, the heap is now splintered.
+		for(size_t i = 0; i < 64; i += 2)
+		{
+			tlsf.deallocate(blocks[i]);
+		}
+		ASSERT_TRUE(tlsf.stats().fragmentation() > 0.0);
+
+		for(size_t i = 1; i < 64; i += 2)
+		{
+			tlsf.deallocate(blocks[i]);
+		}
+
+		const TlsfStats stats = tlsf.stats();
+		ASSERT_EQ(stats.liveBlockCount, 0);
+		ASSERT_EQ(stats.usedBytes, 0);
+		ASSERT_EQ(stats.freeBlockCount, 1);
+		ASSERT_EQ(stats.fragmentation(), 0.0);
+
+		// Blocks past one commit chunk, on a fresh heap and behind the free tail of this one.
+		for(TlsfAllocator* heap : {&tlsf, &fresh})
+		{
+			for(size_t size : {size_t(300000), size_t(600000), size_t(1000000), size_t(2000000)})
+			{
+				Result<void*> large = heap->try_allocate(size, 64);
+				ASSERT_TRUE(large.has_value());
+				ASSERT_EQ(reinterpret_cast<uintptr_t>(large.value()) % 64, 0);
+				std::memset(large.value(), 0xEE, size);
+				heap->deallocate(large.value());
+			}
+		}
+	}
+
+	// Verifies that resize grows into a free neighbour and shrinks without moving.
+	BEGIN_TEST(Foundation, Memory, TlsfResizeInPlace)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		TlsfAllocator tlsf = std::move(TlsfAllocator::create(64 * 1024 * 1024).value());
+
+		void* a = tlsf.allocate(256);
+		void* b = tlsf.allocate(256);
+		void* c = tlsf.allocate(256);
+
+		// b's neighbour is live, so it can not grow.
+		ASSERT_FALSE(tlsf.try_resize(b, 256, 512, 16).has_value());
+
+		tlsf.deallocate(c);
+		Result<void*> grown = tlsf.try_resize(b, 256, 512, 16);
+		ASSERT_TRUE(grown.has_value());
+		ASSERT_EQ(grown.value(), b);
+		ASSERT_TRUE(tlsf.usable_size(b) >= 512);
+
+		Result<void*> shrunk = tlsf.try_resize(a, 256, 32, 16);
+		ASSERT_TRUE(shrunk.has_value());
+		ASSERT_EQ(shrunk.value(), a);
+		ASSERT_TRUE(tlsf.usable_size(a) < 256);
+
+		// A vector with nothing live behind it keeps growing in place.
+		TlsfAllocator	       heap	 = std::move(TlsfAllocator::create(64 * 1024 * 1024).value());
+		Allocator	       allocator = as_allocator(heap);
+		VectorDynamic<uint32_t> values(allocator);
+		values.reserve(16);
+		const uint32_t* first = values.data();
+		for(uint32_t i = 0; i < 100000; ++i)
+		{
+			values.push_back(i);
+		}
+		ASSERT_EQ(values.data(), first);
+		ASSERT_EQ(values[99999], 99999u);
+	}
+
+	// Verifies size class alignment, magazine reuse and exact stats across threads.
+	BEGIN_TEST(Foundation, Memory, HeapAllocatorThreadCache)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		HeapAllocator heap;
+
+		// A freed small block is the next one handed out for its size class.
+		void* block = heap.allocate(40, 8);
+		heap.deallocate(block, 40, 8);
+		ASSERT_EQ(heap.allocate(40, 8), block);
+		heap.deallocate(block, 40, 8);
+
+		constexpr size_t ThreadCount = 4;
+		constexpr size_t PerThread   = 2000;
+
+		struct Block
+		{
+			void*  ptr;
+			size_t size;
+			size_t alignment;
+		};
+
+		std::vector<Block> blocks[ThreadCount];
+		bool		   aligned[ThreadCount] = {};
+
+		std::thread threads[ThreadCount];
+		for(size_t t = 0; t < ThreadCount; ++t)
+		{
+			threads[t] = std::thread([&, t] {
+				aligned[t] = true;
+				for(size_t i = 0; i < PerThread; ++i)
+				{
+					const size_t size      = (i * 97) % 1500 + 1;
+					const size_t alignment = size_t(1) << (i % 8);
+					void*	     ptr       = heap.allocate(size, alignment);
+					aligned[t]	       = aligned[t] && reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+					std::memset(ptr, int(t), size);
+					blocks[t].push_back({ptr, size, alignment});
+				}
+			});
+		}
+		for(std::thread& t : threads)
+		{
+			t.join();
+		}
+
+		size_t expectedBytes = 0;
+		for(size_t t = 0; t < ThreadCount; ++t)
+		{
+			ASSERT_TRUE(aligned[t]);
+			for(const Block& b : blocks[t])
+			{
+				expectedBytes += b.size;
+			}
+		}
+		ASSERT_EQ(heap.allocation_count(), ThreadCount * PerThread);
+		ASSERT_EQ(heap.bytes_allocated(), expectedBytes);
+
+		// Free everything from threads that did not allocate it.
+		for(size_t t = 0; t < ThreadCount; ++t)
+		{
+			threads[t] = std::thread([&, t] {
+				for(const Block& b : blocks[(t + 1) % ThreadCount])
+				{
+					heap.deallocate(b.ptr, b.size, b.alignment);
+				}
+			});
+		}
+		for(std::thread& t : threads)
+		{
+			t.join();
+		}
+
+		ASSERT_EQ(heap.allocation_count(), 0);
+		ASSERT_EQ(heap.bytes_allocated(), 0);
+	}
+
+	// Verifies that large blocks are remapped on resize and keep their contents.
+	BEGIN_TEST(Foundation, Memory, HeapAllocatorLargeResize)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		HeapAllocator heap;
+
+		constexpr size_t OldSize = 1024 * 1024;
+		constexpr size_t NewSize = 16 * 1024 * 1024;
+
+		uint32_t* block = static_cast<uint32_t*>(heap.allocate(OldSize, alignof(uint32_t)));
+		for(uint32_t i = 0; i < OldSize / sizeof(uint32_t); ++i)
+		{
+			block[i] = i;
+		}
+
+		// Small and large blocks never turn into each other.
+		ASSERT_FALSE(heap.try_resize(block, OldSize, 512, alignof(uint32_t)).has_value());
+
+		Result<void*> grown = heap.try_resize(block, OldSize, NewSize, alignof(uint32_t));
+#ifdef __linux__
+		ASSERT_TRUE(grown.has_value());
+		block = static_cast<uint32_t*>(grown.value());
+		ASSERT_EQ(heap.bytes_allocated(), NewSize);
+
+		for(uint32_t i = 0; i < OldSize / sizeof(uint32_t); ++i)
+		{
+			ASSERT_EQ(block[i], i);
+		}
+		block[NewSize / sizeof(uint32_t) - 1] = 42;
+
+		heap.deallocate(block, NewSize, alignof(uint32_t));
+#else
+		ASSERT_FALSE(grown.has_value());
+		heap.deallocate(block, OldSize, alignof(uint32_t));
+#endif
+		ASSERT_EQ(heap.bytes_allocated(), 0);
+
+		// Containers pick the path up through Allocator::try_resize.
+		VectorDynamic<uint64_t> values(as_allocator(heap));
+		for(uint64_t i = 0; i < 1000000; ++i)
+		{
+			values.push_back(i);
+		}
+		ASSERT_EQ(values[999999], 999999u);
+		ASSERT_EQ(values[123456], 123456u);
+	}
+
+	// Verifies per-tag counters, frame rollover and the leak list.
+	BEGIN_TEST(Foundation, Memory, TrackingAllocatorTags)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		HeapAllocator	  heap;
+		TrackingAllocator tasks(as_allocator(heap), MemoryTag::Tasks);
+		TrackingAllocator user(as_allocator(heap), MemoryTag::User3);
+		Allocator	  tasksAlloc = as_allocator(tasks);
+		Allocator	  userAlloc  = as_allocator(user);
+
+		set_memory_tag_name(MemoryTag::User3, "Physics");
+		ASSERT_EQ(std::string_view(memory_tag_name(MemoryTag::User3)), std::string_view("Physics"));
+
+		[[maybe_unused]] const MemoryTagStats before = memory_tag_stats(MemoryTag::Tasks);
+		const size_t leaks = for_each_memory_leak(nullptr, nullptr);
+
+		void* a = tasksAlloc.allocate(100, 8);
+		void* b = tasksAlloc.allocate(4096, 8);
+		void* c = userAlloc.allocate(24, 8);
+
+		memory_tracking_begin_frame();
+		void* d = tasksAlloc.allocate(8, 8);
+
+#if FOUNDATION_MEMORY_TRACKING
+		MemoryTagStats stats = memory_tag_stats(MemoryTag::Tasks);
+		ASSERT_EQ(stats.liveBytes - before.liveBytes, 100u + 4096u + 8u);
+		ASSERT_EQ(stats.liveAllocations - before.liveAllocations, 3u);
+		ASSERT_EQ(stats.frameAllocations, 1u);
+		ASSERT_EQ(stats.sizeHistogram[memory_size_bucket(4096)] - before.sizeHistogram[memory_size_bucket(4096)], 1u);
+		ASSERT_EQ(for_each_memory_leak(nullptr, nullptr), leaks + 4);
+#endif
+
+		tasksAlloc.deallocate(a, 100, 8);
+		tasksAlloc.deallocate(b, 4096, 8);
+		tasksAlloc.deallocate(d, 8, 8);
+
+#if FOUNDATION_MEMORY_TRACKING
+		stats = memory_tag_stats(MemoryTag::Tasks);
+		ASSERT_EQ(stats.liveBytes, before.liveBytes);
+		ASSERT_TRUE(stats.peakBytes >= before.liveBytes + 100 + 4096 + 8);
+
+		// Only the user block is still live, and it is reported under its tag.
+		struct Found
+		{
+			const void* address;
+			bool	    found;
+		} found{c, false};
+
+		for_each_memory_leak(
+			[](void* ctx, const MemoryLeak& leak) noexcept {
+				Found* f = static_cast<Found*>(ctx);
+				f->found |= leak.address == f->address && leak.size == 24 && leak.tag == MemoryTag::User3;
+			},
+			&found);
+		ASSERT_TRUE(found.found);
+#endif
+
+		userAlloc.deallocate(c, 24, 8);
+		ASSERT_EQ(for_each_memory_leak(nullptr, nullptr), leaks);
+	}
+
+	// Verifies that Large reservations commit in huge pages whenever the OS provided them.
+	BEGIN_TEST(Foundation, Memory, VirtualRangeLargePages)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		Result<VirtualRange> reserved = VirtualRange::reserve(3 * 1024 * 1024 + 5, MemoryPageSize::Large);
+		ASSERT_TRUE(reserved.has_value());
+		VirtualRange range = std::move(reserved.value());
+
+		Result<std::optional<size_t>> large = get_system_large_page_size();
+		ASSERT_TRUE(large.has_value());
+
+		if(range.page_backing() == PageBacking::Normal)
+		{
+			ASSERT_EQ(range.commit_granularity(), get_system_page_size());
+		}
+		else
+		{
+			ASSERT_TRUE(large.value().has_value());
+			ASSERT_EQ(range.commit_granularity(), *large.value());
+			ASSERT_EQ(reinterpret_cast<uintptr_t>(range.data()) % *large.value(), 0u);
+			ASSERT_EQ(range.capacity() % *large.value(), 0u);
+		}
+
+		ASSERT_TRUE(range.grow(100).has_value());
+		std::memset(range.data(), 0xAB, range.commit_granularity());
+		ASSERT_TRUE(range.grow(range.capacity() - range.size()).has_value());
+		range.data()[range.capacity() - 1] = std::byte{1};
+		ASSERT_TRUE(range.shrink(range.size() - 1).has_value());
+		ASSERT_TRUE(range.data()[0] == std::byte{0xAB});
+	}
+
+	// Verifies commit-ahead and decommit slack turn an oscillating range into a few syscalls.
+	BEGIN_TEST(Foundation, Memory, VirtualRangeCommitPolicy)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		const size_t	   pageSize = get_system_page_size();
+		const CommitPolicy policy{.minCommitChunk = 64 * 1024, .growthPercent = 100, .decommitSlack = 256 * 1024};
+
+		// Every frame grows by 100 KB one page at a time, then drops back to one page.
+		auto oscillate = [&](auto& range) {
+			for(int frame = 0; frame < 16; ++frame)
+			{
+				for(size_t bytes = 0; bytes < 100 * 1024; bytes += pageSize)
+				{
+					ASSERT_TRUE(range.grow(pageSize).has_value());
+					range.data()[range.size() - 1] = std::byte{1};
+				}
+				ASSERT_TRUE(range.shrink(range.size() - pageSize).has_value());
+			}
+		};
+
+		VirtualRange exact = std::move(VirtualRange::reserve(16 * 1024 * 1024).value());
+		oscillate(exact);
+		ASSERT_TRUE(exact.commit_stats().commits >= 16 * (100 * 1024 / pageSize - 1));
+		ASSERT_EQ(exact.commit_stats().decommits, 16u);
+
+		VirtualRange ranged = std::move(VirtualRange::reserve(16 * 1024 * 1024).value());
+		ranged.set_commit_policy(policy);
+		oscillate(ranged);
+		ASSERT_TRUE(ranged.commit_stats().commits <= 3);
+		ASSERT_EQ(ranged.commit_stats().decommits, 0u);
+		ASSERT_TRUE(ranged.committed_size() >= 100 * 1024);
+
+		VirtualRangeGuarded guarded = std::move(VirtualRangeGuarded::reserve(16 * 1024 * 1024).value());
+		guarded.set_commit_policy(policy);
+		oscillate(guarded);
+		ASSERT_TRUE(guarded.commit_stats().commits <= 3);
+		ASSERT_EQ(guarded.commit_stats().decommits, 0u);
+
+		// Shrinking past the slack hands the rest back.
+		ASSERT_TRUE(guarded.shrink(guarded.size()).has_value());
+		ASSERT_TRUE(guarded.grow(guarded.capacity()).has_value());
+		ASSERT_TRUE(guarded.shrink(guarded.size()).has_value());
+		ASSERT_EQ(guarded.committed_size(), policy.decommitSlack);
+		ASSERT_EQ(guarded.commit_stats().decommits, 1u);
+	}
+
+	BEGIN_TEST(Foundation, Memory, VirtualRangeNumaPlacement)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		const NumaTopology& topology = numa_topology();
+		ASSERT_TRUE(topology.nodeCount >= 1);
+		ASSERT_TRUE(topology.node_of_cpu(0) < topology.nodeCount);
+		ASSERT_TRUE(current_numa_node() < topology.nodeCount);
+
+		for(NumaPolicy policy : {NumaPolicy::prefer(current_numa_node()), NumaPolicy::interleave()})
+		{
+			Result<VirtualRange> reserved = VirtualRange::reserve(1024 * 1024, MemoryPageSize::Normal, policy);
+			ASSERT_TRUE(reserved.has_value());
+			VirtualRange range = std::move(reserved.value());
+
+			ASSERT_TRUE(range.grow(range.capacity()).has_value());
+			std::memset(range.data(), 0x5A, range.size());
+		}
+
+		Result<LinearAllocator> arena = LinearAllocator::create(64 * 1024, LinearAllocator::RetainAllCommitted, NumaPolicy::interleave());
+		ASSERT_TRUE(arena.has_value());
+		ASSERT_TRUE(arena.value().try_allocate(4096, 16).has_value());
+
+		ASSERT_TRUE(set_thread_numa_policy(NumaPolicy::prefer(current_numa_node())).has_value());
+		ASSERT_TRUE(set_thread_numa_policy(NumaPolicy{}).has_value());
+	}
+
+	// Verifies that zeroed allocations are zero, also where an arena hands out reused memory.
+	BEGIN_TEST(Foundation, Memory, AllocateZeroed)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		auto is_zero = [](const void* ptr, size_t size) {
+			const std::byte* bytes = static_cast<const std::byte*>(ptr);
+			return std::all_of(bytes, bytes + size, [](std::byte b) { return b == std::byte{0}; });
+		};
+
+		HeapAllocator heap;
+		for(size_t size : {size_t(64), size_t(8) << 20})
+		{
+			Result<void*> block = heap.try_allocate_zeroed(size, 64);
+			ASSERT_TRUE(block.has_value());
+			ASSERT_TRUE(is_zero(block.value(), size));
+			std::memset(block.value(), 0xFF, size);
+			heap.deallocate(block.value(), size, 64);
+		}
+
+		LinearAllocator arena = std::move(LinearAllocator::create(1024 * 1024).value());
+		std::memset(arena.allocate(4096, 16), 0xFF, 4096);
+		arena.reset();
+
+		Result<void*> reused = arena.try_allocate_zeroed(8192, 16);
+		ASSERT_TRUE(reused.has_value());
+		ASSERT_TRUE(is_zero(reused.value(), 8192));
+
+		// Through the type-erased view and in a container whose empty control bytes are zero.
+		Allocator view = as_allocator(arena);
+		arena.reset();
+		ASSERT_TRUE(is_zero(view.try_allocate_zeroed(4096, 16).value(), 4096));
+
+		FlatHashMap<uint32_t, uint32_t> map(view, 256);
+		for(uint32_t key = 0; key < 200; ++key)
+		{
+			static_cast<void>(map.insert(key, key * 3));
+		}
+		ASSERT_EQ(*map.find(199).value(), uint32_t(597));
+		ASSERT_TRUE(map.find(200).value() == nullptr);
+
+		VectorDynamic<uint32_t> grid(view);
+		grid.resize(1024);
+		ASSERT_EQ(grid.size(), size_t(1024));
+		ASSERT_TRUE(is_zero(grid.data(), 1024 * sizeof(uint32_t)));
+	}
+
+	// Verifies soft-limit pressure callbacks and hard-limit failures of a tag budget.
+	BEGIN_TEST(Foundation, Memory, MemoryBudgetLimits)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		struct Cache
+		{
+			BudgetAllocator* allocator;
+			void*		 block;
+			size_t		 calls;
+		};
+
+		constexpr MemoryTag Tag = MemoryTag::User6;
+		set_memory_budget(Tag, 4096, 8192);
+
+		HeapAllocator	heap;
+		BudgetAllocator budget(as_allocator(heap), Tag);
+		Cache		cache{&budget, budget.try_allocate(3000, 16).value(), 0};
+
+		// The cache evicts itself when the tag goes over its soft limit.
+		Result<uint32_t> handle = register_memory_pressure_callback(
+			Tag,
+			[](void* user, MemoryTag, uint64_t) noexcept {
+				Cache* c = static_cast<Cache*>(user);
+				++c->calls;
+				c->allocator->deallocate(std::exchange(c->block, nullptr), 3000, 16);
+			},
+			&cache);
+		ASSERT_TRUE(handle.has_value());
+
+		Allocator view	= as_allocator(budget);
+		void*	  block = view.allocate(2000, 16);
+		ASSERT_EQ(cache.calls, size_t(1));
+		ASSERT_TRUE(cache.block == nullptr);
+
+		MemoryBudgetStats stats = memory_budget_stats(Tag);
+		ASSERT_EQ(stats.usedBytes, uint64_t(2000));
+		ASSERT_EQ(stats.peakBytes, uint64_t(5000));
+		ASSERT_EQ(stats.softCrossings, uint64_t(1));
+
+		// Past the hard limit the callbacks get one more chance, then the charge fails.
+		Result<void*> tooLarge = view.try_allocate(7000, 16);
+		ASSERT_TRUE(!tooLarge.has_value());
+		ASSERT_EQ(tooLarge.error().code, static_cast<uint32_t>(MemoryErrorCode::BudgetExceeded));
+		ASSERT_EQ(cache.calls, size_t(2));
+
+		stats = memory_budget_stats(Tag);
+		ASSERT_EQ(stats.hardFailures, uint64_t(1));
+		ASSERT_EQ(stats.usedBytes, uint64_t(2000));
+		ASSERT_EQ(stats.headroom(), uint64_t(6192));
+
+		void* more = view.allocate(3000, 16);
+		ASSERT_TRUE(memory_budget_stats(Tag).over_soft_limit());
+		ASSERT_EQ(cache.calls, size_t(3));
+
+		memory_budget_begin_frame();
+		ASSERT_EQ(cache.calls, size_t(4));
+		ASSERT_EQ(memory_budget_stats(Tag).lastFramePeakBytes, uint64_t(5000));
+
+		unregister_memory_pressure_callback(handle.value());
+		view.deallocate(block, 2000, 16);
+		view.deallocate(more, 3000, 16);
+		memory_budget_begin_frame();
+		ASSERT_EQ(cache.calls, size_t(4));
+		ASSERT_EQ(memory_budget_stats(Tag).usedBytes, uint64_t(0));
+
+		set_memory_budget(Tag, NoMemoryLimit, NoMemoryLimit);
+	}
+
+#ifdef __linux__
+	// Verifies that a mapped file exposes the file contents and accepts hints on partial ranges.
+	BEGIN_TEST(Foundation, Memory, MappedFileView)
+	{
+		using namespace foundation;
+		using namespace foundation::memory;
+
+		std::FILE* file = std::tmpfile();
+		ASSERT_TRUE(file != nullptr);
+
+		constexpr size_t FileSize = 3 * 4096 + 123;
+		for(size_t i = 0; i < FileSize; ++i)
+		{
+			std::fputc(static_cast<int>(i % 251), file);
+		}
+		std::fflush(file);
+
+		MappedFileOptions options;
+		options.pattern	 = MemoryAccessPattern::Sequential;
+		options.prefault = FilePrefault::Populate;
+
+		Result<MappedFile> mapped = MappedFile::map(fileno(file), options);
+		ASSERT_TRUE(mapped.has_value());
+
+		// The view outlives the handle.
+		std::fclose(file);
+
+		MappedFile view = std::move(mapped.value());
+		ASSERT_EQ(view.size(), FileSize);
+
+		std::span<const std::byte> bytes = view.bytes();
+		for(size_t i = 0; i < FileSize; i += 97)
+		{
+			ASSERT_EQ(static_cast<size_t>(bytes[i]), i % 251);
+		}
+
+		ASSERT_TRUE(view.advise(MemoryAccessPattern::Random, 5000, 100).has_value());
+		ASSERT_TRUE(view.prefetch(FileSize - 10, 1000).has_value());
+		ASSERT_TRUE(view.prefetch(FileSize + 10).has_value());
+
+		MappedFile moved = std::move(view);
+		ASSERT_TRUE(view.empty());
+		ASSERT_EQ(static_cast<size_t>(moved.bytes()[FileSize - 1]), (FileSize - 1) % 251);
+
+		// Empty files give an empty view instead of an error.
+		std::FILE* empty = std::tmpfile();
+		Result<MappedFile> emptyView = MappedFile::map(fileno(empty));
+		std::fclose(empty);
+		ASSERT_TRUE(emptyView.has_value());
+		ASSERT_TRUE(emptyView.value().bytes().empty());
+	}
+#endif
+
+} // namespace opus3d::tests
\ No newline at end of file